@@ -1,102 +1,284 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <sstream>
 #include <vector>
 #include "Token.hpp"
+#include "Value.hpp"
+#include "Operator.hpp"
 #include "MyMacros.hpp"
 
+struct FrameLayout;
+
+/*
+Kind tag carried by every AST node.
+Visitors dispatch on it with a single switch, and ast_cast checks it instead of walking RTTI.
+*/
+enum class ASTKind : unsigned char
+{
+	eToken,			// leaf holding a single token: variable, literal, type name or operator
+	eEmpty,
+	eUnary,
+	eBinary,
+	eLogical,		// short-circuit AND/OR
+	eCompound,
+	eAssign,
+	eFor,
+	eIf,
+	eWhile,
+	eRepeat,
+	eProgram,
+	eProcedure,		// declaration, or call when its block is empty
+	eBlock,
+	eDeclaration,
+	eDeclContainer,
+	eVarDecl
+};
+
+/*
+Specialized form a node is rewritten into by the tree walker the first time it runs it (quickening).
+A binary form trusts the operand types seen on that first run, and rewrites the node back to eGeneric
+the first time they differ.
+*/
+enum class QuickForm : unsigned char
+{
+	eUnquickened,		// not run yet
+	eGeneric,			// full decision on every run
+	eLiteral,			// leaf holding a literal
+	eSlot,				// variable read from or assignment to its cached slot
+	// Operations on two leaves, INTEGER operands
+	eIntAdd,
+	eIntSub,
+	eIntMul,
+	eIntEqual,
+	eIntNotEqual,
+	eIntLess,
+	eIntLessEqual,
+	eIntGreater,
+	eIntGreaterEqual,
+	// FLOAT operands
+	eFloatAdd,
+	eFloatSub,
+	eFloatMul,
+	eFloatDivide,
+	// Any other operation on two leaves, through its kernel
+	eLeafKernel
+};
 
 class AST
 {
 public:
+	static constexpr ASTKind KIND = ASTKind::eToken;
+
 	AST() {};
 	virtual ~AST() noexcept {};
-	explicit AST(SHARE_TOKEN_STRING token)
+	explicit AST(PTR_TOKEN token, ASTKind kind = ASTKind::eToken)
+		:
+		m_kind(kind)
 	{
-		(check_is_shared_ptr(token)) ? m_token = token : 
-			throw MyExceptions::MsgExecption("token passed to a AST constructor must be a shared_ptr type.");
+		(token != nullptr) ? m_token = token :
+			throw MyExceptions::MsgExecption("token passed to a AST constructor must not be null.");
+		// Literal INTEGER/FLOAT tokens are converted once here so that the interpreter never parses strings
+		m_literal = Value::FromToken(m_token);
+		m_staticType = m_literal.GetTypeTag();
 	}
-	virtual SHARE_TOKEN_STRING GetToken() const noexcept
+	ASTKind GetKind() const noexcept
+	{
+		return m_kind;
+	}
+	virtual PTR_TOKEN GetToken() const noexcept
 	{
 		return m_token;
 	}
+	const Value& GetLiteral() const noexcept
+	{
+		return m_literal;
+	}
+	// Resolved (scope level, slot index) of a variable, filled in once by SemanticAnalyzer
+	void SetSlot(unsigned int level, unsigned int slot) noexcept
+	{
+		m_slotLevel = level;
+		m_slotIndex = slot;
+	}
+	bool IsResolved() const noexcept
+	{
+		return m_slotLevel != 0;
+	}
+	unsigned int GetSlotLevel() const noexcept
+	{
+		return m_slotLevel;
+	}
+	unsigned int GetSlotIndex() const noexcept
+	{
+		return m_slotIndex;
+	}
+	// Type of the value an expression node produces, inferred once by SemanticAnalyzer (literals know theirs)
+	void SetStaticType(Value::Type type) noexcept
+	{
+		m_staticType = type;
+	}
+	Value::Type GetStaticType() const noexcept
+	{
+		return m_staticType;
+	}
+	// Specialized form chosen by the tree walker, with the slot a variable or an assignment was cached at
+	void Quicken(QuickForm form, unsigned int slot = 0) noexcept
+	{
+		m_quickForm = form;
+		m_quickSlot = slot;
+	}
+	QuickForm GetQuickForm() const noexcept
+	{
+		return m_quickForm;
+	}
+	unsigned int GetQuickSlot() const noexcept
+	{
+		return m_quickSlot;
+	}
 	virtual std::string ToString() const noexcept
 	{
 		return "AST: ( " + m_token->ToString()+ " ) ";
 	}
+protected:
+	explicit AST(ASTKind kind) : m_kind(kind) {};
+
 private:
-	SHARE_TOKEN_STRING m_token;
+	ASTKind m_kind = ASTKind::eToken;
+	PTR_TOKEN m_token = nullptr;
+	Value m_literal;
+	unsigned int m_slotLevel = 0;
+	unsigned int m_slotIndex = 0;
+	Value::Type m_staticType = Value::Type::eEmpty;
+	QuickForm m_quickForm = QuickForm::eUnquickened;
+	unsigned int m_quickSlot = 0;
 };
 
 class Empty_AST : public AST
 {
 public:
+	static constexpr ASTKind KIND = ASTKind::eEmpty;
+
 	Empty_AST() 
 		: 
-		AST(MAKE_SHARE_TOKEN(EMPTY, MAKE_SHARE_STRING("\0"),0)) 
+		AST(GetEmptyToken(), KIND)
 	{}
 	virtual std::string ToString() const noexcept override
 	{
 		return "Empty_AST : () ";
 	}
+private:
+	// Every empty node shares one immutable token, so the arena does not allocate one per node
+	static PTR_TOKEN GetEmptyToken()
+	{
+		static Token token(EMPTY, "", 0);
+		return &token;
+	}
 };
 
 class UnaryOp_AST : public AST
 {
 public:
-	explicit UnaryOp_AST(SHARE_TOKEN_STRING op, SHARE_AST expr)
+	static constexpr ASTKind KIND = ASTKind::eUnary;
+
+	explicit UnaryOp_AST(PTR_TOKEN op, PTR_AST expr)
+		:
+		AST(KIND)
 	{
-		(check_is_shared_ptr(op)) ? m_op = op :
-			throw MyExceptions::MsgExecption("op passed to a UnaryOp_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(expr)) ? m_expr = expr :
-			throw MyExceptions::MsgExecption("expr passed to a UnaryOp_AST constructor must be a shared_ptr type.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a UnaryOp_AST constructor must not be null.");
+		(expr != nullptr) ? m_expr = expr :
+			throw MyExceptions::MsgExecption("expr passed to a UnaryOp_AST constructor must not be null.");
+		m_kernel = nullptr;
 	}
 	~UnaryOp_AST() noexcept override {};
 
-	virtual SHARE_TOKEN_STRING GetToken() const noexcept override
+	virtual PTR_TOKEN GetToken() const noexcept override
 	{
 		return m_op;
 	}
-	SHARE_AST GetExpr() const noexcept
+	PTR_AST GetExpr() const noexcept
 	{
 		return m_expr;
 	}
+	// Rewrite of the operand by ASTOptimizer
+	void SetExpr(PTR_AST expr) noexcept
+	{
+		m_expr = expr;
+	}
+	/*
+	Functionality: bind the node to the kernel of its operation on the static type of its operand
+	Return: false if there is none (operand not typed yet)
+	*/
+	bool BindKernel() noexcept
+	{
+		m_kernel = GetUnaryKernel(GetEnumNumOp(m_op->GetType()), m_expr->GetStaticType());
+		return m_kernel != nullptr;
+	}
+	UnaryKernel GetKernel() const noexcept
+	{
+		return m_kernel;
+	}
 	virtual std::string ToString() const noexcept override
 	{
 		return "Unary OP: ( " + m_op->ToString() + " , " + m_expr->ToString() + " ) ";
 	}
 private:
-	SHARE_TOKEN_STRING m_op;
-	SHARE_AST m_expr;
+	PTR_TOKEN m_op;
+	PTR_AST m_expr;
+	UnaryKernel m_kernel;
 };
 
 class BinaryOp_AST : public AST
 {
 public:
-	explicit BinaryOp_AST(SHARE_AST left, SHARE_AST right, SHARE_AST op)
-	{
-		(check_is_shared_ptr(left)) ? m_left = left :
-			throw MyExceptions::MsgExecption("left passed to a BinaryOp_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(right)) ? m_right = right :
-			throw MyExceptions::MsgExecption("right passed to a BinaryOp_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(op)) ? m_op = op :
-			throw MyExceptions::MsgExecption("op passed to a BinaryOp_AST constructor must be a shared_ptr type.");
+	static constexpr ASTKind KIND = ASTKind::eBinary;
+
+	explicit BinaryOp_AST(PTR_AST left, PTR_AST right, PTR_AST op)
+		:
+		AST(KIND)
+	{
+		(left != nullptr) ? m_left = left :
+			throw MyExceptions::MsgExecption("left passed to a BinaryOp_AST constructor must not be null.");
+		(right != nullptr) ? m_right = right :
+			throw MyExceptions::MsgExecption("right passed to a BinaryOp_AST constructor must not be null.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a BinaryOp_AST constructor must not be null.");
+		m_kernel = nullptr;
 	}
 	~BinaryOp_AST() noexcept override {};
-	SHARE_AST GetLeft() const noexcept
+	PTR_AST GetLeft() const noexcept
 	{
 		return m_left;
 	}
-	SHARE_AST GetRight() const noexcept
+	PTR_AST GetRight() const noexcept
 	{
 		return m_right;
 	}
-	SHARE_AST GetOp() const noexcept
+	// Rewrite of the operands by ASTOptimizer
+	void SetOperands(PTR_AST left, PTR_AST right) noexcept
+	{
+		m_left = left;
+		m_right = right;
+	}
+	/*
+	Functionality: bind the node to the kernel of its operation on the static types of its operands
+	Return: false if there is none (operands not typed yet)
+	*/
+	bool BindKernel() noexcept
+	{
+		m_kernel = GetBinaryKernel(GetEnumNumOp(GetToken()->GetType()), m_left->GetStaticType(), m_right->GetStaticType());
+		return m_kernel != nullptr;
+	}
+	BinaryKernel GetKernel() const noexcept
+	{
+		return m_kernel;
+	}
+	PTR_AST GetOp() const noexcept
 	{
 		return m_op;
 	}
-	virtual SHARE_TOKEN_STRING GetToken() const noexcept override
+	virtual PTR_TOKEN GetToken() const noexcept override
 	{
 		return m_op->GetToken();
 	}
@@ -107,26 +289,96 @@ public:
 		return oss.str();
 	}
 private:
-	SHARE_AST m_left;
-	SHARE_AST m_right;
-	SHARE_AST m_op;
+	PTR_AST m_left;
+	PTR_AST m_right;
+	PTR_AST m_op;
+	BinaryKernel m_kernel;
+};
+
+/*
+Short-circuit AND/OR: the right operand is only evaluated when the left one does not decide the result.
+Engines branch on it instead of calling a kernel.
+*/
+class LogicalOp_AST : public AST
+{
+public:
+	static constexpr ASTKind KIND = ASTKind::eLogical;
+
+	explicit LogicalOp_AST(PTR_AST left, PTR_AST right, PTR_AST op)
+		:
+		AST(KIND)
+	{
+		(left != nullptr) ? m_left = left :
+			throw MyExceptions::MsgExecption("left passed to a LogicalOp_AST constructor must not be null.");
+		(right != nullptr) ? m_right = right :
+			throw MyExceptions::MsgExecption("right passed to a LogicalOp_AST constructor must not be null.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a LogicalOp_AST constructor must not be null.");
+	}
+	~LogicalOp_AST() noexcept override {};
+	PTR_AST GetLeft() const noexcept
+	{
+		return m_left;
+	}
+	PTR_AST GetRight() const noexcept
+	{
+		return m_right;
+	}
+	// Rewrite of the operands by ASTOptimizer
+	void SetOperands(PTR_AST left, PTR_AST right) noexcept
+	{
+		m_left = left;
+		m_right = right;
+	}
+	PTR_AST GetOp() const noexcept
+	{
+		return m_op;
+	}
+	// Whether a left operand equal to value decides the result on its own: FALSE for AND, TRUE for OR
+	bool IsDecidedBy(bool value) const noexcept
+	{
+		return value == (GetToken()->GetType() == OR);
+	}
+	virtual PTR_TOKEN GetToken() const noexcept override
+	{
+		return m_op->GetToken();
+	}
+	virtual std::string ToString() const noexcept override
+	{
+		std::ostringstream oss;
+		oss << "Logical OP: ( " << m_left->ToString() << " | " << m_right->ToString() << " | " << m_op->ToString() << " ) ";
+		return oss.str();
+	}
+private:
+	PTR_AST m_left;
+	PTR_AST m_right;
+	PTR_AST m_op;
 };
 
 class Compound_AST : public AST
 {
 public:
+	static constexpr ASTKind KIND = ASTKind::eCompound;
+
 	Compound_AST()
+		:
+		AST(KIND)
 	{
 	}
-	void AddStatements(SHARE_AST child) noexcept
+	void AddStatements(PTR_AST child) noexcept
 	{
 		m_children.push_back(child);
 	}
+	// Rewrite of a statement by ASTOptimizer
+	void SetStatement(size_t index, PTR_AST child) noexcept
+	{
+		m_children[index] = child;
+	}
 	bool IsEmpty()
 	{
 		return m_children.empty();
 	}
-	std::vector<SHARE_AST> GetAllChildren() const noexcept
+	const std::vector<PTR_AST>& GetAllChildren() const noexcept
 	{
 		return m_children;
 	}
@@ -142,41 +394,50 @@ public:
 		return oss.str();
 	}
 private:
-	std::vector<SHARE_AST> m_children;
+	std::vector<PTR_AST> m_children;
 };
 
 class Assign_AST : public AST
 {
 public:
-	explicit Assign_AST(SHARE_AST left, SHARE_AST right, SHARE_AST op)
+	static constexpr ASTKind KIND = ASTKind::eAssign;
+
+	explicit Assign_AST(PTR_AST left, PTR_AST right, PTR_AST op)
+		:
+		AST(KIND)
 	{
-		(check_is_shared_ptr(left)) ? m_left = left :
-			throw MyExceptions::MsgExecption("left passed to a Assign constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(right)) ? m_right = right :
-			throw MyExceptions::MsgExecption("right passed to a Assign constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(op)) ? m_op = op :
-			throw MyExceptions::MsgExecption("op passed to a Assign constructor must be a shared_ptr type.");
+		(left != nullptr) ? m_left = left :
+			throw MyExceptions::MsgExecption("left passed to a Assign constructor must not be null.");
+		(right != nullptr) ? m_right = right :
+			throw MyExceptions::MsgExecption("right passed to a Assign constructor must not be null.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a Assign constructor must not be null.");
 	}
 	~Assign_AST() noexcept override {};
 
 	std::string GetVarName() const noexcept
 	{
-		return *(m_left->GetToken()->GetValue());
+		return std::string(m_left->GetToken()->GetValue());
 	}
 
-	SHARE_AST GetLeft() const noexcept
+	PTR_AST GetLeft() const noexcept
 	{
 		return m_left;
 	}
-	SHARE_AST GetRight() const noexcept
+	PTR_AST GetRight() const noexcept
 	{
 		return m_right;
 	}
-	SHARE_AST GetOp() const noexcept
+	// Rewrite of the assigned expression by ASTOptimizer
+	void SetRight(PTR_AST right) noexcept
+	{
+		m_right = right;
+	}
+	PTR_AST GetOp() const noexcept
 	{
 		return m_op;
 	}
-	virtual SHARE_TOKEN_STRING GetToken() const noexcept override
+	virtual PTR_TOKEN GetToken() const noexcept override
 	{
 		return m_op->GetToken();
 	}
@@ -187,32 +448,297 @@ public:
 		return oss.str();
 	}
 private:
-	SHARE_AST m_left;
-	SHARE_AST m_right;
-	SHARE_AST m_op;
+	PTR_AST m_left;
+	PTR_AST m_right;
+	PTR_AST m_op;
+};
+
+/*
+Counted loop: FOR variable ASSIGN start (TO | DOWNTO) end DO statement
+The TO/DOWNTO token is the token of the node. Both bounds are evaluated once, before the first iteration.
+*/
+class For_AST : public AST
+{
+public:
+	static constexpr ASTKind KIND = ASTKind::eFor;
+
+	explicit For_AST(PTR_AST var, PTR_AST start, PTR_AST end, PTR_AST body, PTR_AST direction)
+		:
+		AST(KIND)
+	{
+		(var != nullptr) ? m_var = var :
+			throw MyExceptions::MsgExecption("var passed to a For_AST constructor must not be null.");
+		(start != nullptr) ? m_start = start :
+			throw MyExceptions::MsgExecption("start passed to a For_AST constructor must not be null.");
+		(end != nullptr) ? m_end = end :
+			throw MyExceptions::MsgExecption("end passed to a For_AST constructor must not be null.");
+		(body != nullptr) ? m_body = body :
+			throw MyExceptions::MsgExecption("body passed to a For_AST constructor must not be null.");
+		(direction != nullptr) ? m_direction = direction :
+			throw MyExceptions::MsgExecption("direction passed to a For_AST constructor must not be null.");
+	}
+	~For_AST() noexcept override {};
+
+	PTR_AST GetVariable() const noexcept
+	{
+		return m_var;
+	}
+	PTR_AST GetStart() const noexcept
+	{
+		return m_start;
+	}
+	PTR_AST GetEnd() const noexcept
+	{
+		return m_end;
+	}
+	PTR_AST GetBody() const noexcept
+	{
+		return m_body;
+	}
+	PTR_AST GetDirection() const noexcept
+	{
+		return m_direction;
+	}
+	// Whether the control variable counts down
+	bool IsDownTo() const noexcept
+	{
+		return m_direction->GetToken()->GetType() == DOWNTO;
+	}
+	// Rewrite of the bounds and the body by ASTOptimizer
+	void SetBounds(PTR_AST start, PTR_AST end) noexcept
+	{
+		m_start = start;
+		m_end = end;
+	}
+	void SetBody(PTR_AST body) noexcept
+	{
+		m_body = body;
+	}
+	virtual PTR_TOKEN GetToken() const noexcept override
+	{
+		return m_direction->GetToken();
+	}
+	virtual std::string ToString() const noexcept override
+	{
+		std::ostringstream oss;
+		oss << "For: ( " << m_var->ToString() << " | " << m_start->ToString() << " | " << m_direction->ToString() << " | " << \
+			m_end->ToString() << " | " << m_body->ToString() << " ) ";
+		return oss.str();
+	}
+private:
+	PTR_AST m_var;
+	PTR_AST m_start;
+	PTR_AST m_end;
+	PTR_AST m_body;
+	PTR_AST m_direction;
+};
+
+/*
+IF condition THEN statement (ELSE statement)?
+A missing ELSE branch is an empty statement. The IF token is the token of the node.
+*/
+class If_AST : public AST
+{
+public:
+	static constexpr ASTKind KIND = ASTKind::eIf;
+
+	explicit If_AST(PTR_AST condition, PTR_AST then, PTR_AST otherwise, PTR_AST op)
+		:
+		AST(KIND)
+	{
+		(condition != nullptr) ? m_condition = condition :
+			throw MyExceptions::MsgExecption("condition passed to a If_AST constructor must not be null.");
+		(then != nullptr) ? m_then = then :
+			throw MyExceptions::MsgExecption("then passed to a If_AST constructor must not be null.");
+		(otherwise != nullptr) ? m_else = otherwise :
+			throw MyExceptions::MsgExecption("otherwise passed to a If_AST constructor must not be null.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a If_AST constructor must not be null.");
+	}
+	~If_AST() noexcept override {};
+
+	PTR_AST GetCondition() const noexcept
+	{
+		return m_condition;
+	}
+	PTR_AST GetThen() const noexcept
+	{
+		return m_then;
+	}
+	PTR_AST GetElse() const noexcept
+	{
+		return m_else;
+	}
+	PTR_AST GetOp() const noexcept
+	{
+		return m_op;
+	}
+	// Rewrite of the condition and the branches by ASTOptimizer
+	void SetCondition(PTR_AST condition) noexcept
+	{
+		m_condition = condition;
+	}
+	void SetBranches(PTR_AST then, PTR_AST otherwise) noexcept
+	{
+		m_then = then;
+		m_else = otherwise;
+	}
+	virtual PTR_TOKEN GetToken() const noexcept override
+	{
+		return m_op->GetToken();
+	}
+	virtual std::string ToString() const noexcept override
+	{
+		std::ostringstream oss;
+		oss << "If: ( " << m_condition->ToString() << " | " << m_then->ToString() << " | " << m_else->ToString() << " ) ";
+		return oss.str();
+	}
+private:
+	PTR_AST m_condition;
+	PTR_AST m_then;
+	PTR_AST m_else;
+	PTR_AST m_op;
+};
+
+/*
+WHILE condition DO statement
+The WHILE token is the token of the node.
+*/
+class While_AST : public AST
+{
+public:
+	static constexpr ASTKind KIND = ASTKind::eWhile;
+
+	explicit While_AST(PTR_AST condition, PTR_AST body, PTR_AST op)
+		:
+		AST(KIND)
+	{
+		(condition != nullptr) ? m_condition = condition :
+			throw MyExceptions::MsgExecption("condition passed to a While_AST constructor must not be null.");
+		(body != nullptr) ? m_body = body :
+			throw MyExceptions::MsgExecption("body passed to a While_AST constructor must not be null.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a While_AST constructor must not be null.");
+	}
+	~While_AST() noexcept override {};
+
+	PTR_AST GetCondition() const noexcept
+	{
+		return m_condition;
+	}
+	PTR_AST GetBody() const noexcept
+	{
+		return m_body;
+	}
+	PTR_AST GetOp() const noexcept
+	{
+		return m_op;
+	}
+	// Rewrite of the condition and the body by ASTOptimizer
+	void SetCondition(PTR_AST condition) noexcept
+	{
+		m_condition = condition;
+	}
+	void SetBody(PTR_AST body) noexcept
+	{
+		m_body = body;
+	}
+	virtual PTR_TOKEN GetToken() const noexcept override
+	{
+		return m_op->GetToken();
+	}
+	virtual std::string ToString() const noexcept override
+	{
+		std::ostringstream oss;
+		oss << "While: ( " << m_condition->ToString() << " | " << m_body->ToString() << " ) ";
+		return oss.str();
+	}
+private:
+	PTR_AST m_condition;
+	PTR_AST m_body;
+	PTR_AST m_op;
+};
+
+/*
+REPEAT statement_list UNTIL condition
+The body is a compound statement and runs at least once. The UNTIL token is the token of the node.
+*/
+class Repeat_AST : public AST
+{
+public:
+	static constexpr ASTKind KIND = ASTKind::eRepeat;
+
+	explicit Repeat_AST(PTR_AST body, PTR_AST condition, PTR_AST op)
+		:
+		AST(KIND)
+	{
+		(body != nullptr) ? m_body = body :
+			throw MyExceptions::MsgExecption("body passed to a Repeat_AST constructor must not be null.");
+		(condition != nullptr) ? m_condition = condition :
+			throw MyExceptions::MsgExecption("condition passed to a Repeat_AST constructor must not be null.");
+		(op != nullptr) ? m_op = op :
+			throw MyExceptions::MsgExecption("op passed to a Repeat_AST constructor must not be null.");
+	}
+	~Repeat_AST() noexcept override {};
+
+	PTR_AST GetBody() const noexcept
+	{
+		return m_body;
+	}
+	PTR_AST GetCondition() const noexcept
+	{
+		return m_condition;
+	}
+	PTR_AST GetOp() const noexcept
+	{
+		return m_op;
+	}
+	// Rewrite of the condition by ASTOptimizer, the body compound is optimized in place
+	void SetCondition(PTR_AST condition) noexcept
+	{
+		m_condition = condition;
+	}
+	virtual PTR_TOKEN GetToken() const noexcept override
+	{
+		return m_op->GetToken();
+	}
+	virtual std::string ToString() const noexcept override
+	{
+		std::ostringstream oss;
+		oss << "Repeat: ( " << m_body->ToString() << " | " << m_condition->ToString() << " ) ";
+		return oss.str();
+	}
+private:
+	PTR_AST m_body;
+	PTR_AST m_condition;
+	PTR_AST m_op;
 };
 
 class Program_AST : public AST
 {
 public:
-	explicit Program_AST(SHARE_AST name, SHARE_AST block)
+	static constexpr ASTKind KIND = ASTKind::eProgram;
+
+	explicit Program_AST(PTR_AST name, PTR_AST block)
+		:
+		AST(KIND)
 	{
-		(check_is_shared_ptr(name)) ? m_name = name :
-			throw MyExceptions::MsgExecption("name passed to a Program_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(block)) ? m_block = block :
-			throw MyExceptions::MsgExecption("block passed to a Program_AST constructor must be a shared_ptr type.");
+		(name != nullptr) ? m_name = name :
+			throw MyExceptions::MsgExecption("name passed to a Program_AST constructor must not be null.");
+		(block != nullptr) ? m_block = block :
+			throw MyExceptions::MsgExecption("block passed to a Program_AST constructor must not be null.");
 	}
 	~Program_AST() noexcept override {};
 
 	std::string GetName() const noexcept
 	{
-		return *(m_name->GetToken()->GetValue());
+		return std::string(m_name->GetToken()->GetValue());
 	}
-	virtual SHARE_TOKEN_STRING GetToken() const noexcept override
+	virtual PTR_TOKEN GetToken() const noexcept override
 	{
 		return m_name->GetToken();
 	}
-	SHARE_AST GetBlock() const noexcept
+	PTR_AST GetBlock() const noexcept
 	{
 		return m_block;
 	}
@@ -221,86 +747,118 @@ public:
 		return "Program: ( " + m_name->ToString() + " , " + m_block->ToString() + " ) ";
 	}
 private:
-	SHARE_AST m_name;
-	SHARE_AST m_block;
+	PTR_AST m_name;
+	PTR_AST m_block;
 };
 
 class Procedure_AST : public AST
 {
 public:
-	explicit Procedure_AST(SHARE_AST name, SHARE_AST params ,SHARE_AST block)
+	static constexpr ASTKind KIND = ASTKind::eProcedure;
+
+	explicit Procedure_AST(PTR_AST name, PTR_AST params ,PTR_AST block)
+		:
+		AST(KIND)
 	{
-		(check_is_shared_ptr(name)) ? m_name = name :
-			throw MyExceptions::MsgExecption("name passed to a Procedure_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(params)) ? m_params = params :
-			throw MyExceptions::MsgExecption("params passed to a Procedure_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(block)) ? m_block = block :
-			throw MyExceptions::MsgExecption("block passed to a Procedure_AST constructor must be a shared_ptr type.");
+		(name != nullptr) ? m_name = name :
+			throw MyExceptions::MsgExecption("name passed to a Procedure_AST constructor must not be null.");
+		(params != nullptr) ? m_params = params :
+			throw MyExceptions::MsgExecption("params passed to a Procedure_AST constructor must not be null.");
+		(block != nullptr) ? m_block = block :
+			throw MyExceptions::MsgExecption("block passed to a Procedure_AST constructor must not be null.");
 	}
 	~Procedure_AST() noexcept override {};
 
 	std::string GetName() const noexcept
 	{
-		return *(m_name->GetToken()->GetValue());
+		return std::string(m_name->GetToken()->GetValue());
 	}
-	virtual SHARE_TOKEN_STRING GetToken() const noexcept override
+	virtual PTR_TOKEN GetToken() const noexcept override
 	{
 		return m_name->GetToken();
 	}
-	SHARE_AST GetParams() const noexcept
+	PTR_AST GetParams() const noexcept
 	{
 		return m_params;
 	}
-	SHARE_AST GetBlock() const noexcept
+	PTR_AST GetBlock() const noexcept
 	{
 		return m_block;
 	}
+	// Declaration a procedure call refers to, resolved once by SemanticAnalyzer
+	void SetDeclaration(PTR_PROCEDURE_AST declaration) noexcept
+	{
+		m_declaration = declaration;
+	}
+	PTR_PROCEDURE_AST GetDeclaration() const noexcept
+	{
+		return m_declaration;
+	}
 	virtual std::string ToString() const noexcept override
 	{
 		return "Procedure: ( " + m_name->ToString() + " : " + m_params->ToString() + " , " + m_block->ToString() + " ) ";
 	}
 private:
-	SHARE_AST m_name;
-	SHARE_AST m_params;
-	SHARE_AST m_block;
+	PTR_AST m_name;
+	PTR_AST m_params;
+	PTR_AST m_block;
+	PTR_PROCEDURE_AST m_declaration = nullptr;
 };
 
 class Block_AST : public AST
 {
 public:
-	explicit Block_AST(SHARE_AST declaration, SHARE_AST compound)
+	static constexpr ASTKind KIND = ASTKind::eBlock;
+
+	explicit Block_AST(PTR_AST declaration, PTR_AST compound)
+		:
+		AST(KIND)
 	{
-		(check_is_shared_ptr(declaration)) ? m_declaration = declaration :
-			throw MyExceptions::MsgExecption("op passed to a Block_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(compound)) ? m_compound = compound :
-			throw MyExceptions::MsgExecption("expr passed to a Block_AST constructor must be a shared_ptr type.");
+		(declaration != nullptr) ? m_declaration = declaration :
+			throw MyExceptions::MsgExecption("op passed to a Block_AST constructor must not be null.");
+		(compound != nullptr) ? m_compound = compound :
+			throw MyExceptions::MsgExecption("expr passed to a Block_AST constructor must not be null.");
 	}
 	~Block_AST() noexcept override {};
 
-	SHARE_AST GetDeclaration() const noexcept
+	PTR_AST GetDeclaration() const noexcept
 	{
 		return m_declaration;
 	}
-	SHARE_AST GetCompound() const noexcept
+	PTR_AST GetCompound() const noexcept
 	{
 		return m_compound;
 	}
+	// Frame layout of the scope this block opens, computed ahead of time by SemanticAnalyzer
+	void SetFrameLayout(std::shared_ptr<FrameLayout> layout) noexcept
+	{
+		m_layout = layout;
+	}
+	std::shared_ptr<FrameLayout> GetFrameLayout() const noexcept
+	{
+		return m_layout;
+	}
 	virtual std::string ToString() const noexcept override
 	{
 		return "Block: ( " + m_declaration->ToString() + " , " + m_compound->ToString() + " ) ";
 	}
 private:
-	SHARE_AST m_declaration;
-	SHARE_AST m_compound;
+	PTR_AST m_declaration;
+	PTR_AST m_compound;
+	std::shared_ptr<FrameLayout> m_layout;
 };
 
 class Declaration_AST : public AST
 {
 public:
+	static constexpr ASTKind KIND = ASTKind::eDeclaration;
+
 	Declaration_AST()
+		:
+		AST(KIND)
 	{
 	}
-	void AddVarDecal(SHARE_AST child) noexcept
+	void AddVarDecal(PTR_AST child) noexcept
 	{
 		m_children.push_back(child);
 	}
@@ -308,7 +866,7 @@ public:
 	{
 		return m_children.empty();
 	}
-	std::vector<SHARE_AST> GetAllChildren() const noexcept
+	const std::vector<PTR_AST>& GetAllChildren() const noexcept
 	{
 		return m_children;
 	}
@@ -324,20 +882,24 @@ public:
 		return oss.str();
 	}
 private:
-	std::vector<SHARE_AST> m_children;
+	std::vector<PTR_AST> m_children;
 };
 
 class DeclContainer_AST : public AST
 {
 public:
+	static constexpr ASTKind KIND = ASTKind::eDeclContainer;
+
 	DeclContainer_AST()
+		:
+		AST(KIND)
 	{
 	}
-	void AddItem(SHARE_AST child) noexcept
+	void AddItem(PTR_AST child) noexcept
 	{
 		m_children.push_back(child);
 	}
-	std::vector<SHARE_AST> GetAllChildren() const noexcept
+	const std::vector<PTR_AST>& GetAllChildren() const noexcept
 	{
 		return m_children;
 	}
@@ -353,42 +915,56 @@ public:
 		return oss.str();
 	}
 private:
-	std::vector<SHARE_AST> m_children;
+	std::vector<PTR_AST> m_children;
 };
 
 class VarDecl_AST : public AST
 {
 public:
-	explicit VarDecl_AST(SHARE_AST Var, SHARE_AST Type)
+	static constexpr ASTKind KIND = ASTKind::eVarDecl;
+
+	explicit VarDecl_AST(PTR_AST Var, PTR_AST Type)
+		:
+		AST(KIND)
 	{
-		(check_is_shared_ptr(Var)) ? m_var = Var :
-			throw MyExceptions::MsgExecption("op passed to a VarDecal_AST constructor must be a shared_ptr type.");
-		(check_is_shared_ptr(Type)) ? m_type = Type :
-			throw MyExceptions::MsgExecption("expr passed to a VarDecal_AST constructor must be a shared_ptr type.");
+		(Var != nullptr) ? m_var = Var :
+			throw MyExceptions::MsgExecption("op passed to a VarDecal_AST constructor must not be null.");
+		(Type != nullptr) ? m_type = Type :
+			throw MyExceptions::MsgExecption("expr passed to a VarDecal_AST constructor must not be null.");
 	}
 	~VarDecl_AST() noexcept override {};
 
-	SHARE_AST GetVar() const noexcept
+	PTR_AST GetVar() const noexcept
 	{
 		return m_var;
 	}
-	SHARE_AST GetType() const noexcept
+	PTR_AST GetType() const noexcept
 	{
 		return m_type;
 	}
 	std::string GetVarString() const noexcept
 	{
-		return *(GetVar()->GetToken()->GetValue());
+		return std::string(GetVar()->GetToken()->GetValue());
 	}
 	std::string GetTypeString() const noexcept
 	{
-		return *(GetType()->GetToken()->GetValue());
+		return std::string(GetType()->GetToken()->GetValue());
 	}
 	virtual std::string ToString() const noexcept override
 	{
 		return "VarDecl_AST: ( " + m_var->ToString() + " , " + m_type->ToString() + " ) ";
 	}
 private:
-	SHARE_AST m_var;
-	SHARE_AST m_type;
-};
\ No newline at end of file
+	PTR_AST m_var;
+	PTR_AST m_type;
+};
+
+/*
+Functionality: checked downcast through the kind tag, no RTTI involved
+Return: node as a T, or nullptr if the node is null or of another kind
+*/
+template <typename T>
+inline T* ast_cast(AST* node) noexcept
+{
+	return (node != nullptr && node->GetKind() == T::KIND) ? static_cast<T*>(node) : nullptr;
+}
@@ -0,0 +1,565 @@
+#include "ASTCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+static const char s_magic[4] = { 'P', 'A', 'S', 'C' };
+static const uint32_t s_none = 0xFFFFFFFF;
+// magic, version, source hash, source size, node count, root index, payload checksum
+static const size_t HEADER_SIZE = 4 + 4 + 8 + 8 + 4 + 4 + 8;
+
+/*
+Functionality: child nodes of a node in the order they are serialized.
+Program and procedure names are stored as the token of their record instead of a child.
+*/
+static void GetChildren(PTR_AST node, std::vector<PTR_AST>& children)
+{
+	children.clear();
+	switch (node->GetKind())
+	{
+	case ASTKind::eUnary:
+		children.push_back(static_cast<PTR_UNARY_AST>(node)->GetExpr());
+		break;
+	case ASTKind::eBinary:
+	{
+		auto binary = static_cast<PTR_BINARY_AST>(node);
+		children.insert(children.end(), { binary->GetLeft(), binary->GetRight(), binary->GetOp() });
+		break;
+	}
+	case ASTKind::eLogical:
+	{
+		auto logical = static_cast<PTR_LOGICAL_AST>(node);
+		children.insert(children.end(), { logical->GetLeft(), logical->GetRight(), logical->GetOp() });
+		break;
+	}
+	case ASTKind::eAssign:
+	{
+		auto assign = static_cast<PTR_ASSIGN_AST>(node);
+		children.insert(children.end(), { assign->GetLeft(), assign->GetRight(), assign->GetOp() });
+		break;
+	}
+	case ASTKind::eFor:
+	{
+		auto loop = static_cast<PTR_FOR_AST>(node);
+		children.insert(children.end(), { loop->GetVariable(), loop->GetStart(), loop->GetEnd(), loop->GetBody(), loop->GetDirection() });
+		break;
+	}
+	case ASTKind::eIf:
+	{
+		auto branch = static_cast<PTR_IF_AST>(node);
+		children.insert(children.end(), { branch->GetCondition(), branch->GetThen(), branch->GetElse(), branch->GetOp() });
+		break;
+	}
+	case ASTKind::eWhile:
+	{
+		auto loop = static_cast<PTR_WHILE_AST>(node);
+		children.insert(children.end(), { loop->GetCondition(), loop->GetBody(), loop->GetOp() });
+		break;
+	}
+	case ASTKind::eRepeat:
+	{
+		auto loop = static_cast<PTR_REPEAT_AST>(node);
+		children.insert(children.end(), { loop->GetBody(), loop->GetCondition(), loop->GetOp() });
+		break;
+	}
+	case ASTKind::eCompound:
+		children = static_cast<PTR_COMPOUND_AST>(node)->GetAllChildren();
+		break;
+	case ASTKind::eDeclaration:
+		children = static_cast<PTR_DECLARATION_AST>(node)->GetAllChildren();
+		break;
+	case ASTKind::eDeclContainer:
+		children = static_cast<PTR_DECLCONTAINER_AST>(node)->GetAllChildren();
+		break;
+	case ASTKind::eProgram:
+		children.push_back(static_cast<PTR_PROGRAM_AST>(node)->GetBlock());
+		break;
+	case ASTKind::eProcedure:
+	{
+		auto procedure = static_cast<PTR_PROCEDURE_AST>(node);
+		children.insert(children.end(), { procedure->GetParams(), procedure->GetBlock() });
+		break;
+	}
+	case ASTKind::eBlock:
+	{
+		auto block = static_cast<PTR_BLOCK_AST>(node);
+		children.insert(children.end(), { block->GetDeclaration(), block->GetCompound() });
+		break;
+	}
+	case ASTKind::eVarDecl:
+	{
+		auto varDecl = static_cast<PTR_VARDECL_AST>(node);
+		children.insert(children.end(), { varDecl->GetVar(), varDecl->GetType() });
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+// Whether the record of a node carries a token of its own
+static bool HasToken(ASTKind kind) noexcept
+{
+	return kind == ASTKind::eToken || kind == ASTKind::eUnary || kind == ASTKind::eProgram || kind == ASTKind::eProcedure;
+}
+
+// Whether the number of children is variable and thus serialized
+static bool HasChildCount(ASTKind kind) noexcept
+{
+	return kind == ASTKind::eCompound || kind == ASTKind::eDeclaration || kind == ASTKind::eDeclContainer;
+}
+
+// Number of children of the node kinds with a fixed arity
+static uint32_t GetFixedChildCount(ASTKind kind) noexcept
+{
+	switch (kind)
+	{
+	case ASTKind::eUnary:
+	case ASTKind::eProgram:
+		return 1;
+	case ASTKind::eProcedure:
+	case ASTKind::eBlock:
+	case ASTKind::eVarDecl:
+		return 2;
+	case ASTKind::eBinary:
+	case ASTKind::eLogical:
+	case ASTKind::eAssign:
+	case ASTKind::eWhile:
+	case ASTKind::eRepeat:
+		return 3;
+	case ASTKind::eIf:
+		return 4;
+	case ASTKind::eFor:
+		return 5;
+	default:
+		return 0;
+	}
+}
+
+/*
+Append-only serialization buffer
+*/
+class CacheWriter
+{
+public:
+	template <typename T>
+	void Write(T value)
+	{
+		m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// LEB128, most counts, positions and child distances fit in one or two bytes
+	void WriteVarint(uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			m_buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		m_buffer.push_back(static_cast<char>(value));
+	}
+
+	void WriteString(std::string_view text)
+	{
+		WriteVarint(static_cast<uint32_t>(text.size()));
+		m_buffer.append(text.data(), text.size());
+	}
+
+	const std::string& GetBuffer() const noexcept
+	{
+		return m_buffer;
+	}
+
+private:
+	std::string m_buffer;
+};
+
+/*
+Bounds checked reader over a mapped cache file, any overrun marks the whole entry as corrupted
+*/
+class CacheReader
+{
+public:
+	explicit CacheReader(std::string_view data)
+		:
+		m_data(data),
+		m_pos(0),
+		m_valid(true)
+	{}
+
+	template <typename T>
+	T Read() noexcept
+	{
+		T value{};
+		if (m_pos + sizeof(T) > m_data.size())
+		{
+			m_valid = false;
+			return value;
+		}
+		std::memcpy(&value, m_data.data() + m_pos, sizeof(T));
+		m_pos += sizeof(T);
+		return value;
+	}
+
+	uint32_t ReadVarint() noexcept
+	{
+		uint32_t value = 0;
+		for (unsigned int shift = 0; shift < 35; shift += 7)
+		{
+			unsigned char byte = Read<unsigned char>();
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		m_valid = false;
+		return 0;
+	}
+
+	std::string_view ReadString() noexcept
+	{
+		uint32_t size = ReadVarint();
+		if (!m_valid || size > m_data.size() - m_pos)
+		{
+			m_valid = false;
+			return std::string_view();
+		}
+		std::string_view result = m_data.substr(m_pos, size);
+		m_pos += size;
+		return result;
+	}
+
+	bool IsValid() const noexcept
+	{
+		return m_valid;
+	}
+
+	bool IsAtEnd() const noexcept
+	{
+		return m_pos == m_data.size();
+	}
+
+private:
+	std::string_view m_data;
+	size_t m_pos;
+	bool m_valid;
+};
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ull;
+static const uint64_t FNV_PRIME = 1099511628211ull;
+
+// FNV-1a continued from 'hash', so that a split buffer hashes like the whole one
+static uint64_t HashBytes(std::string_view bytes, uint64_t hash) noexcept
+{
+	for (unsigned char c : bytes)
+	{
+		hash ^= c;
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+uint64_t ASTCache::HashSource(std::string_view source) noexcept
+{
+	return HashBytes(source, FNV_OFFSET);
+}
+
+bool ASTCache::Store(const std::string& path, std::string_view source, PTR_AST root) const
+{
+	CacheWriter nodes;
+	std::unordered_map<const AST*, uint32_t> indices;
+	std::vector<std::pair<uint32_t, const FrameLayout*>> layoutLinks;
+	std::vector<std::pair<uint32_t, PTR_PROCEDURE_AST>> callLinks;
+	std::vector<PTR_AST> children;
+
+	// Post order without recursion, so that expressions as deep as the parser accepts can be stored
+	std::vector<std::pair<PTR_AST, bool>> work;
+	work.emplace_back(root, false);
+	while (!work.empty())
+	{
+		auto item = work.back();
+		work.pop_back();
+		PTR_AST node = item.first;
+		if (indices.count(node))
+			continue;
+		GetChildren(node, children);
+		if (!item.second)
+		{
+			work.emplace_back(node, true);
+			for (auto it = children.rbegin(); it != children.rend(); it++)
+				work.emplace_back(*it, false);
+			continue;
+		}
+
+		uint32_t index = static_cast<uint32_t>(indices.size());
+		ASTKind kind = node->GetKind();
+		nodes.Write<unsigned char>(static_cast<unsigned char>(kind));
+		nodes.Write<unsigned char>(static_cast<unsigned char>(node->GetStaticType()));
+		if (HasToken(kind))
+		{
+			PTR_TOKEN token = node->GetToken();
+			nodes.Write<unsigned char>(static_cast<unsigned char>(token->GetType()));
+			nodes.WriteVarint(token->GetPos());
+			nodes.WriteString(token->GetValue());
+		}
+		if (kind == ASTKind::eToken)
+		{
+			nodes.WriteVarint(node->GetSlotLevel());
+			nodes.WriteVarint(node->GetSlotIndex());
+		}
+		if (HasChildCount(kind))
+			nodes.WriteVarint(static_cast<uint32_t>(children.size()));
+		// Children are stored as their distance back from the parent
+		for (PTR_AST child : children)
+			nodes.WriteVarint(index - indices[child]);
+
+		if (PTR_BLOCK_AST block = ast_cast<Block_AST>(node))
+		{
+			if (block->GetFrameLayout())
+				layoutLinks.emplace_back(index, block->GetFrameLayout().get());
+		}
+		else if (PTR_PROCEDURE_AST procedure = ast_cast<Procedure_AST>(node))
+		{
+			if (procedure->GetDeclaration())
+				callLinks.emplace_back(index, procedure->GetDeclaration());
+		}
+		indices[node] = index;
+	}
+
+	CacheWriter tail;
+	tail.WriteVarint(static_cast<uint32_t>(layoutLinks.size()));
+	for (auto& link : layoutLinks)
+	{
+		const FrameLayout* layout = link.second;
+		tail.WriteVarint(link.first);
+		tail.WriteString(layout->name);
+		tail.WriteVarint(layout->level);
+		tail.WriteVarint(layout->GetSize());
+		for (unsigned int i = 0; i < layout->GetSize(); i++)
+		{
+			tail.WriteString(layout->names[i]);
+			tail.Write<unsigned char>(static_cast<unsigned char>(layout->types[i]));
+		}
+	}
+	tail.WriteVarint(static_cast<uint32_t>(callLinks.size()));
+	for (auto& link : callLinks)
+	{
+		// A declaration outside of the tree cannot be restored, leave the call unresolved
+		auto declaration = indices.find(link.second);
+		tail.WriteVarint(link.first);
+		tail.WriteVarint((declaration != indices.end()) ? declaration->second : s_none);
+	}
+
+	CacheWriter file;
+	for (char c : s_magic)
+		file.Write<char>(c);
+	file.Write<uint32_t>(FORMAT_VERSION);
+	file.Write<uint64_t>(HashSource(source));
+	file.Write<uint64_t>(static_cast<uint64_t>(source.size()));
+	file.Write<uint32_t>(static_cast<uint32_t>(indices.size()));
+	file.Write<uint32_t>(indices[root]);
+	file.Write<uint64_t>(HashBytes(tail.GetBuffer(), HashBytes(nodes.GetBuffer(), FNV_OFFSET)));
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out.write(file.GetBuffer().data(), file.GetBuffer().size());
+	out.write(nodes.GetBuffer().data(), nodes.GetBuffer().size());
+	out.write(tail.GetBuffer().data(), tail.GetBuffer().size());
+	return static_cast<bool>(out);
+}
+
+PTR_AST ASTCache::Load(const std::string& path, std::string_view source, Arena* arena)
+{
+	if (!m_file.Open(path))
+		return nullptr;
+
+	CacheReader reader(m_file.GetView());
+	char magic[4];
+	for (char& c : magic)
+		c = reader.Read<char>();
+	uint32_t version = reader.Read<uint32_t>();
+	uint64_t hash = reader.Read<uint64_t>();
+	uint64_t size = reader.Read<uint64_t>();
+	uint32_t count = reader.Read<uint32_t>();
+	uint32_t root = reader.Read<uint32_t>();
+	uint64_t checksum = reader.Read<uint64_t>();
+	// The checksum covers everything after the header, a truncated or damaged entry is never trusted
+	if (!reader.IsValid() || std::memcmp(magic, s_magic, sizeof(s_magic)) != 0 || version != FORMAT_VERSION || \
+		size != source.size() || hash != HashSource(source) || root >= count || \
+		checksum != HashBytes(m_file.GetView().substr(HEADER_SIZE), FNV_OFFSET))
+	{
+		// Unmap right away so that the stale entry can be overwritten
+		m_file.Close();
+		return nullptr;
+	}
+
+	// Every node takes at least one byte, which bounds the reservation of a corrupted count
+	std::vector<PTR_AST> nodes;
+	nodes.reserve(std::min<size_t>(count, m_file.GetView().size()));
+	std::vector<PTR_AST> children;
+	for (uint32_t index = 0; index < count && reader.IsValid(); index++)
+	{
+		ASTKind kind = static_cast<ASTKind>(reader.Read<unsigned char>());
+		unsigned char staticType = reader.Read<unsigned char>();
+		if (staticType > static_cast<unsigned char>(Value::Type::eBoolean))
+			break;
+		PTR_TOKEN token = nullptr;
+		if (HasToken(kind))
+		{
+			TokenKind type = static_cast<TokenKind>(reader.Read<unsigned char>());
+			uint32_t pos = reader.ReadVarint();
+			std::string_view value = reader.ReadString();
+			if (type > __EOF__)
+				break;
+			token = MAKE_ARENA_TOKEN(arena, type, value, pos);
+		}
+		uint32_t slotLevel = 0;
+		uint32_t slotIndex = 0;
+		if (kind == ASTKind::eToken)
+		{
+			slotLevel = reader.ReadVarint();
+			slotIndex = reader.ReadVarint();
+		}
+		uint32_t childCount = HasChildCount(kind) ? reader.ReadVarint() : GetFixedChildCount(kind);
+		if (!reader.IsValid() || childCount > index)
+			break;
+		children.clear();
+		for (uint32_t i = 0; i < childCount; i++)
+		{
+			// Children always precede their parent
+			uint32_t distance = reader.ReadVarint();
+			if (distance == 0 || distance > index)
+				break;
+			children.push_back(nodes[index - distance]);
+		}
+		if (!reader.IsValid() || children.size() != childCount)
+			break;
+
+		PTR_AST node = nullptr;
+		switch (kind)
+		{
+		case ASTKind::eToken:
+			node = MAKE_ARENA_AST(arena, token);
+			node->SetSlot(slotLevel, slotIndex);
+			break;
+		case ASTKind::eEmpty:
+			node = MAKE_ARENA_EMPTY_AST(arena);
+			break;
+		case ASTKind::eUnary:
+			node = MAKE_ARENA_UNARY_AST(arena, token, children[0]);
+			break;
+		case ASTKind::eBinary:
+			node = MAKE_ARENA_BINARY_AST(arena, children[0], children[1], children[2]);
+			break;
+		case ASTKind::eAssign:
+			node = MAKE_ARENA_ASSIGN_AST(arena, children[0], children[1], children[2]);
+			break;
+		case ASTKind::eLogical:
+			node = MAKE_ARENA_LOGICAL_AST(arena, children[0], children[1], children[2]);
+			break;
+		case ASTKind::eFor:
+			node = MAKE_ARENA_FOR_AST(arena, children[0], children[1], children[2], children[3], children[4]);
+			break;
+		case ASTKind::eIf:
+			node = MAKE_ARENA_IF_AST(arena, children[0], children[1], children[2], children[3]);
+			break;
+		case ASTKind::eWhile:
+			node = MAKE_ARENA_WHILE_AST(arena, children[0], children[1], children[2]);
+			break;
+		case ASTKind::eRepeat:
+			node = MAKE_ARENA_REPEAT_AST(arena, children[0], children[1], children[2]);
+			break;
+		case ASTKind::eCompound:
+		{
+			CREATE_ARENA_COMPOUND_AST(arena, compound);
+			for (PTR_AST child : children)
+				compound->AddStatements(child);
+			node = compound;
+			break;
+		}
+		case ASTKind::eDeclaration:
+		{
+			CREATE_ARENA_DECLARATION_AST(arena, declaration);
+			for (PTR_AST child : children)
+				declaration->AddVarDecal(child);
+			node = declaration;
+			break;
+		}
+		case ASTKind::eDeclContainer:
+		{
+			CREATE_ARENA_DECLCONTAINER_AST(arena, container);
+			for (PTR_AST child : children)
+				container->AddItem(child);
+			node = container;
+			break;
+		}
+		case ASTKind::eProgram:
+			node = MAKE_ARENA_PROGRAM_AST(arena, MAKE_ARENA_AST(arena, token), children[0]);
+			break;
+		case ASTKind::eProcedure:
+			node = MAKE_ARENA_PROCEDURE_AST(arena, MAKE_ARENA_AST(arena, token), children[0], children[1]);
+			break;
+		case ASTKind::eBlock:
+			node = MAKE_ARENA_BLOCK_AST(arena, children[0], children[1]);
+			break;
+		case ASTKind::eVarDecl:
+			node = MAKE_ARENA_VARDECL_AST(arena, children[0], children[1]);
+			break;
+		default:
+			break;
+		}
+		if (node == nullptr)
+			break;
+		node->SetStaticType(static_cast<Value::Type>(staticType));
+		// Kernels are not stored, operators are bound again from the static types of their children
+		if (kind == ASTKind::eUnary)
+			static_cast<PTR_UNARY_AST>(node)->BindKernel();
+		else if (kind == ASTKind::eBinary)
+			static_cast<PTR_BINARY_AST>(node)->BindKernel();
+		nodes.push_back(node);
+	}
+
+	// Semantic annotations
+	bool linked = true;
+	uint32_t layoutCount = (nodes.size() == count) ? reader.ReadVarint() : 0;
+	for (uint32_t i = 0; i < layoutCount && reader.IsValid() && linked; i++)
+	{
+		uint32_t index = reader.ReadVarint();
+		auto layout = std::make_shared<FrameLayout>();
+		layout->name = std::string(reader.ReadString());
+		layout->level = reader.ReadVarint();
+		uint32_t slots = reader.ReadVarint();
+		for (uint32_t slot = 0; slot < slots && reader.IsValid(); slot++)
+		{
+			layout->names.push_back(std::string(reader.ReadString()));
+			unsigned char type = reader.Read<unsigned char>();
+			linked = linked && type <= static_cast<unsigned char>(Value::Type::eBoolean);
+			layout->types.push_back(static_cast<Value::Type>(type));
+		}
+		PTR_BLOCK_AST block = (index < nodes.size()) ? ast_cast<Block_AST>(nodes[index]) : nullptr;
+		linked = linked && block != nullptr;
+		if (linked)
+			block->SetFrameLayout(layout);
+	}
+	uint32_t callCount = reader.ReadVarint();
+	for (uint32_t i = 0; i < callCount && reader.IsValid() && linked; i++)
+	{
+		uint32_t index = reader.ReadVarint();
+		uint32_t target = reader.ReadVarint();
+		PTR_PROCEDURE_AST call = (index < nodes.size()) ? ast_cast<Procedure_AST>(nodes[index]) : nullptr;
+		PTR_PROCEDURE_AST declaration = (target < nodes.size()) ? ast_cast<Procedure_AST>(nodes[target]) : nullptr;
+		linked = call != nullptr && (declaration != nullptr || target == s_none);
+		if (linked)
+			call->SetDeclaration(declaration);
+	}
+
+	if (!linked || !reader.IsValid() || !reader.IsAtEnd() || nodes.size() != count || ast_cast<Program_AST>(nodes[root]) == nullptr)
+	{
+		// The nodes built so far stay in the arena until it is reset, they are simply never used
+		m_file.Close();
+		return nullptr;
+	}
+	return nodes[root];
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Arena.hpp"
+#include "MappedFile.hpp"
+#include "AST.hpp"
+#include "Frame.hpp"
+
+/*
+ASTCache class
+Binary cache of a parsed, semantically checked and optimized program, stored in a '.pasc' file next to its source.
+An entry is only used when its format version, source size and source content hash all match,
+otherwise the program is parsed again and the entry is rewritten.
+
+Layout (native byte order for the header, LEB128 integers everywhere else):
+	header		: magic "PASC", version, source hash, source size, node count, root index, checksum of the rest
+	nodes		: post order with their static type, children are referenced by their distance back to the parent
+	layouts		: frame layouts computed by the semantic analyzer
+	links		: (block, layout) and (procedure call, declaration) pairs
+Token payloads are read in place: the tokens of a loaded tree are views into the mapped cache file,
+so the ASTCache must outlive the tree it returned.
+*/
+class ASTCache
+{
+public:
+	// Bump whenever the AST, the token kinds or the semantic annotations change
+	static constexpr uint32_t FORMAT_VERSION = 5;
+
+	ASTCache() {};
+	virtual ~ASTCache() {};
+
+	ASTCache(const ASTCache&) = delete;
+	ASTCache& operator=(const ASTCache&) = delete;
+
+	/*
+	Functionality: 64 bits FNV-1a hash of the source text, the cache key
+	*/
+	static uint64_t HashSource(std::string_view source) noexcept;
+
+	/*
+	Functionality: map a cache file and rebuild its tree inside the arena
+	Return: root of the program, or nullptr if the entry is missing, stale or corrupted
+	*/
+	PTR_AST Load(const std::string& path, std::string_view source, Arena* arena);
+
+	/*
+	Functionality: serialize a program checked by the semantic analyzer
+	Return: false if the file cannot be written, the cache is only an optimization
+	*/
+	bool Store(const std::string& path, std::string_view source, PTR_AST root) const;
+
+	/*
+	Functionality: release the mapping of the last loaded entry, which invalidates its tree
+	*/
+	void Close() noexcept
+	{
+		m_file.Close();
+	}
+
+private:
+	MappedFile m_file;
+};
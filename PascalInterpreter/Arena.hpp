@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+Arena class
+Bump allocator owning every AST node and token of a compilation unit.
+Objects are constructed in place inside large chunks and are never freed one by one:
+destructors (for the types that need one) run in reverse order and all chunks are released in one shot
+when the arena is reset or destroyed.
+*/
+class Arena
+{
+public:
+	explicit Arena(size_t chunkSize = 64 * 1024)
+		:
+		m_chunkSize(chunkSize),
+		m_current(nullptr),
+		m_left(0),
+		m_bytesUsed(0)
+	{}
+	virtual ~Arena()
+	{
+		Reset();
+	}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	/*
+	Functionality: run the destructors of all objects and release all chunks
+	*/
+	void Reset() noexcept
+	{
+		for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); it++)
+			it->destroy(it->object);
+		m_destructors.clear();
+		m_chunks.clear();
+		m_current = nullptr;
+		m_left = 0;
+		m_bytesUsed = 0;
+	}
+
+	/*
+	Functionality: bump allocate raw memory
+	Return: pointer to size bytes aligned to align
+	*/
+	void* Allocate(size_t size, size_t align)
+	{
+		size_t padding = (align - (reinterpret_cast<uintptr_t>(m_current) & (align - 1))) & (align - 1);
+		if (m_current == nullptr || padding + size > m_left)
+		{
+			NewChunk(size + align);
+			padding = (align - (reinterpret_cast<uintptr_t>(m_current) & (align - 1))) & (align - 1);
+		}
+		char* result = m_current + padding;
+		m_current = result + size;
+		m_left -= padding + size;
+		m_bytesUsed += padding + size;
+		return result;
+	}
+
+	/*
+	Functionality: construct an object of type T inside the arena
+	Return: raw pointer owned by the arena
+	*/
+	template <typename T, typename... Args>
+	T* Make(Args&&... args)
+	{
+		T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (!std::is_trivially_destructible<T>::value)
+			m_destructors.push_back(Destructor{ &Destroy<T>, object });
+		return object;
+	}
+
+	/*
+	Functionality: copy a string payload into the arena
+	Return: view of the copy, valid as long as the arena
+	*/
+	std::string_view CopyString(std::string_view text)
+	{
+		if (text.empty())
+			return std::string_view();
+		char* data = static_cast<char*>(Allocate(text.size(), 1));
+		std::memcpy(data, text.data(), text.size());
+		return std::string_view(data, text.size());
+	}
+
+	size_t GetBytesUsed() const noexcept
+	{
+		return m_bytesUsed;
+	}
+
+private:
+	template <typename T>
+	static void Destroy(void* object) noexcept
+	{
+		static_cast<T*>(object)->~T();
+	}
+
+	void NewChunk(size_t minSize)
+	{
+		size_t size = (minSize > m_chunkSize) ? minSize : m_chunkSize;
+		m_chunks.push_back(std::unique_ptr<char[]>(new char[size]));
+		m_current = m_chunks.back().get();
+		m_left = size;
+	}
+
+	struct Destructor
+	{
+		void (*destroy)(void*);
+		void* object;
+	};
+
+	size_t m_chunkSize;
+	char* m_current;
+	size_t m_left;
+	size_t m_bytesUsed;
+	std::vector<std::unique_ptr<char[]>> m_chunks;
+	std::vector<Destructor> m_destructors;
+};
@@ -0,0 +1,258 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Value.hpp"
+#include "Frame.hpp"
+#include "Operator.hpp"
+
+/*
+Bytecode instruction set of the stack virtual machine
+*/
+enum OpCode : unsigned char
+{
+	OP_PUSH_CONST,		// push m_constants[operand]
+	OP_LOAD,			// push slot 'operand' of the frame at scope 'level'
+	OP_STORE,			// pop into slot 'operand' of the frame at scope 'level', checking the declared 'type'
+	OP_POP,				// discard the top of stack
+	OP_ADD,				// arithmetic through BINARY_KERNELS[operand], bound to the operand types at compile time
+	OP_SUB,
+	OP_MUL,
+	OP_DIV,
+	OP_INT_DIV,
+	OP_EQ,				// comparison through BINARY_KERNELS[operand], pushes a BOOLEAN
+	OP_NE,
+	OP_LT,
+	OP_LE,
+	OP_GT,
+	OP_GE,
+	OP_NEG,				// arithmetic through UNARY_KERNELS[operand]
+	OP_POS,
+	OP_NOT,
+	OP_JUMP,			// pc = operand
+	OP_JUMP_IF_FALSE,	// pop a BOOLEAN, pc = operand if it is FALSE
+	OP_JUMP_IF_FALSE_OR_POP,	// short-circuit AND: keep the top and pc = operand if it is FALSE, pop it otherwise
+	OP_JUMP_IF_TRUE_OR_POP,		// short-circuit OR: keep the top and pc = operand if it is TRUE, pop it otherwise
+	OP_FOR_TO,			// enter a loop over [start, end] below the top of stack: skip the next instruction (the exit jump)
+	OP_FOR_DOWNTO,		// and store the start in slot 'operand' at scope 'level', unless the range is empty
+	OP_NEXT_TO,			// step the counter of the loop headed at 'operand', store it and jump to the body, or pop the bounds
+	OP_NEXT_DOWNTO,
+	OP_ENTER,			// push a new frame for scope 'operand'
+	OP_CALL,			// push the return address, pc = entry of scope 'operand'
+	OP_RETURN,			// pop the current frame and return to the caller
+	OP_HALT,
+	/*
+	Superinstructions, chosen from the op code pairs counted by 'vm-profile' over the sample programs.
+	A superinstruction replaces the op code of the first instruction of a sequence and runs the whole sequence
+	in one dispatch: the following instructions are left in place as its operands and skipped.
+	*/
+	OP_LOAD_CONST_OP_STORE,		// x := y op literal
+	OP_LOAD_LOAD_OP_STORE,		// x := y op z
+	OP_LOAD_CONST_COMPARE_JUMP,	// IF/WHILE/UNTIL y op literal
+	OP_LOAD_CONST_OP,			// y op literal
+	OP_LOAD_LOAD_OP,			// y op z
+	OP_OP_STORE,				// x := ... op ...
+	OP_COMPARE_JUMP,			// IF/WHILE/UNTIL ... op ...
+	OP_CONST_STORE,				// x := literal
+	OP_LOAD_STORE,				// x := y
+	OP_COUNT
+};
+
+/*
+Functionality: mnemonic of an op code for disassembly
+*/
+inline std::string GetOpCodeName(OpCode op)
+{
+	static const char* names[] = {
+		"PUSH_CONST", "LOAD", "STORE", "POP", "ADD", "SUB", "MUL", "DIV", "INT_DIV",
+		"EQ", "NE", "LT", "LE", "GT", "GE", "NEG", "POS", "NOT",
+		"JUMP", "JUMP_IF_FALSE", "JUMP_IF_FALSE_OR_POP", "JUMP_IF_TRUE_OR_POP", "FOR_TO", "FOR_DOWNTO", "NEXT_TO", "NEXT_DOWNTO", "ENTER", "CALL", "RETURN", "HALT",
+		"LOAD_CONST_OP_STORE", "LOAD_LOAD_OP_STORE", "LOAD_CONST_COMPARE_JUMP", "LOAD_CONST_OP", "LOAD_LOAD_OP",
+		"OP_STORE", "COMPARE_JUMP", "CONST_STORE", "LOAD_STORE"
+	};
+	return (op < OP_COUNT) ? names[op] : "UNKNOWN";
+}
+
+/*
+Functionality: map a binary operation code to its op code
+*/
+inline OpCode GetBinaryOpCode(NumOp_code op)
+{
+	switch (op)
+	{
+	case ePLUS: return OP_ADD;
+	case eMINUS: return OP_SUB;
+	case eMULTIPLY: return OP_MUL;
+	case eDIVIDE: return OP_DIV;
+	case eEQUAL: return OP_EQ;
+	case eNOT_EQUAL: return OP_NE;
+	case eLESS: return OP_LT;
+	case eLESS_EQUAL: return OP_LE;
+	case eGREATER: return OP_GT;
+	case eGREATER_EQUAL: return OP_GE;
+	default: return OP_INT_DIV;
+	}
+}
+
+/*
+Functionality: whether an op code applies a binary kernel (arithmetic or comparison)
+*/
+inline bool IsBinaryOpCode(OpCode op) noexcept
+{
+	return op >= OP_ADD && op <= OP_GE;
+}
+
+inline bool IsCompareOpCode(OpCode op) noexcept
+{
+	return op >= OP_EQ && op <= OP_GE;
+}
+
+/*
+Instruction sequence fused into a superinstruction, longest first so that the first match is the longest one
+*/
+struct Superinstruction
+{
+	enum Element : unsigned char
+	{
+		eLoad,			// OP_LOAD
+		eConst,			// OP_PUSH_CONST
+		eBinary,		// any binary kernel op code
+		eCompare,		// a comparison op code
+		eStore,			// OP_STORE
+		eJumpIfFalse	// OP_JUMP_IF_FALSE
+	};
+
+	OpCode op;
+	unsigned int length;
+	Element sequence[4];
+
+	bool Matches(unsigned int index, OpCode code) const noexcept
+	{
+		switch (sequence[index])
+		{
+		case eLoad: return code == OP_LOAD;
+		case eConst: return code == OP_PUSH_CONST;
+		case eBinary: return IsBinaryOpCode(code);
+		case eCompare: return IsCompareOpCode(code);
+		case eStore: return code == OP_STORE;
+		default: return code == OP_JUMP_IF_FALSE;
+		}
+	}
+};
+
+constexpr Superinstruction SUPERINSTRUCTIONS[] = {
+	{ OP_LOAD_CONST_OP_STORE, 4, { Superinstruction::eLoad, Superinstruction::eConst, Superinstruction::eBinary, Superinstruction::eStore } },
+	{ OP_LOAD_LOAD_OP_STORE, 4, { Superinstruction::eLoad, Superinstruction::eLoad, Superinstruction::eBinary, Superinstruction::eStore } },
+	{ OP_LOAD_CONST_COMPARE_JUMP, 4, { Superinstruction::eLoad, Superinstruction::eConst, Superinstruction::eCompare, Superinstruction::eJumpIfFalse } },
+	{ OP_LOAD_CONST_OP, 3, { Superinstruction::eLoad, Superinstruction::eConst, Superinstruction::eBinary } },
+	{ OP_LOAD_LOAD_OP, 3, { Superinstruction::eLoad, Superinstruction::eLoad, Superinstruction::eBinary } },
+	{ OP_OP_STORE, 2, { Superinstruction::eBinary, Superinstruction::eStore } },
+	{ OP_COMPARE_JUMP, 2, { Superinstruction::eCompare, Superinstruction::eJumpIfFalse } },
+	{ OP_CONST_STORE, 2, { Superinstruction::eConst, Superinstruction::eStore } },
+	{ OP_LOAD_STORE, 2, { Superinstruction::eLoad, Superinstruction::eStore } }
+};
+
+struct Instruction
+{
+	OpCode op;
+	unsigned int level;
+	Value::Type type;
+	unsigned int operand;
+	unsigned int pos;
+
+	std::string ToString() const noexcept
+	{
+		return GetOpCodeName(op) + " " + MyTemplates::Str(level) + " " + MyTemplates::Str(operand);
+	}
+};
+
+/*
+Compile time description of a scope (the program or a procedure): its frame layout and entry point
+*/
+struct ScopeInfo
+{
+	std::shared_ptr<FrameLayout> layout;
+	unsigned int entry;
+};
+
+/*
+A compiled program: linear code, constant pool and scope descriptions
+*/
+class BytecodeProgram
+{
+public:
+	BytecodeProgram() {};
+	virtual ~BytecodeProgram() {};
+
+	void Reset() noexcept
+	{
+		m_code.clear();
+		m_constants.clear();
+		m_scopes.clear();
+	}
+
+	unsigned int Emit(OpCode op, unsigned int operand = 0, unsigned int pos = 0, unsigned int level = 0, Value::Type type = Value::Type::eEmpty)
+	{
+		m_code.push_back(Instruction{ op, level, type, operand, pos });
+		return static_cast<unsigned int>(m_code.size() - 1);
+	}
+
+	void Patch(unsigned int index, unsigned int operand) noexcept
+	{
+		m_code[index].operand = operand;
+	}
+
+	void SetOpCode(unsigned int index, OpCode op) noexcept
+	{
+		m_code[index].op = op;
+	}
+
+	unsigned int AddConstant(const Value& value)
+	{
+		m_constants.push_back(value);
+		return static_cast<unsigned int>(m_constants.size() - 1);
+	}
+
+	unsigned int AddScope(const ScopeInfo& scope)
+	{
+		m_scopes.push_back(scope);
+		return static_cast<unsigned int>(m_scopes.size() - 1);
+	}
+
+	unsigned int GetCodeSize() const noexcept
+	{
+		return static_cast<unsigned int>(m_code.size());
+	}
+
+	const std::vector<Instruction>& GetCode() const noexcept
+	{
+		return m_code;
+	}
+
+	const std::vector<Value>& GetConstants() const noexcept
+	{
+		return m_constants;
+	}
+
+	std::vector<ScopeInfo>& GetScopes() noexcept
+	{
+		return m_scopes;
+	}
+
+	const std::vector<ScopeInfo>& GetScopes() const noexcept
+	{
+		return m_scopes;
+	}
+
+	std::string ToString() const noexcept
+	{
+		std::string result;
+		for (unsigned int i = 0; i < m_code.size(); i++)
+			result += MyTemplates::Str(i) + ": " + m_code[i].ToString() + "\n";
+		return result;
+	}
+
+private:
+	std::vector<Instruction> m_code;
+	std::vector<Value> m_constants;
+	std::vector<ScopeInfo> m_scopes;
+};
@@ -0,0 +1,847 @@
+#include "CBackend.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+// Runtime shared by every generated program
+static const char* s_prelude =
+	"#include <inttypes.h>\n"
+	"#include <math.h>\n"
+	"#include <setjmp.h>\n"
+	"#include <stdint.h>\n"
+	"#include <stdio.h>\n"
+	"#include <string.h>\n"
+	"\n"
+	"#if defined(__GNUC__)\n"
+	"#define PASCAL_NORETURN __attribute__((noreturn))\n"
+	"#elif defined(_MSC_VER)\n"
+	"#define PASCAL_NORETURN __declspec(noreturn)\n"
+	"#else\n"
+	"#define PASCAL_NORETURN\n"
+	"#endif\n"
+	"\n"
+	"#if defined(_WIN32) && defined(PASCAL_SHARED)\n"
+	"#define PASCAL_EXPORT __declspec(dllexport)\n"
+	"#else\n"
+	"#define PASCAL_EXPORT\n"
+	"#endif\n"
+	"\n"
+	"static jmp_buf pascal_error_jump;\n"
+	"\n"
+	"/* Runtime error: report it to the host with its source position (-1 for none) and leave the program */\n"
+	"static PASCAL_NORETURN void pascal_error(long pos, const char* msg)\n"
+	"{\n"
+	"\tfprintf(stderr, \"error:%ld:%s\\n\", pos, msg);\n"
+	"\tlongjmp(pascal_error_jump, 1);\n"
+	"}\n"
+	"\n"
+	"/* INTEGER arithmetic wraps around */\n"
+	"static int64_t pascal_add(int64_t a, int64_t b)\n"
+	"{\n"
+	"\treturn (int64_t)((uint64_t)a + (uint64_t)b);\n"
+	"}\n"
+	"\n"
+	"static int64_t pascal_sub(int64_t a, int64_t b)\n"
+	"{\n"
+	"\treturn (int64_t)((uint64_t)a - (uint64_t)b);\n"
+	"}\n"
+	"\n"
+	"static int64_t pascal_mul(int64_t a, int64_t b)\n"
+	"{\n"
+	"\treturn (int64_t)((uint64_t)a * (uint64_t)b);\n"
+	"}\n"
+	"\n"
+	"static int64_t pascal_neg(int64_t a)\n"
+	"{\n"
+	"\treturn (int64_t)(0 - (uint64_t)a);\n"
+	"}\n"
+	"\n"
+	"static int64_t pascal_div(int64_t a, int64_t b)\n"
+	"{\n"
+	"\tif (b == 0)\n"
+	"\t\tpascal_error(-1, \"SyntaxError: Decimal number division by zero.\");\n"
+	"\t/* The smallest INTEGER divided by -1 wraps around as well */\n"
+	"\tif (b == -1)\n"
+	"\t\treturn pascal_neg(a);\n"
+	"\treturn a / b;\n"
+	"}\n"
+	"\n"
+	"static double pascal_fdiv(double a, double b)\n"
+	"{\n"
+	"\tif (b == 0)\n"
+	"\t\tpascal_error(-1, \"SyntaxError: Decimal number division by zero.\");\n"
+	"\treturn a / b;\n"
+	"}\n";
+
+/*
+Functionality: read a whole file, a missing file reads as empty
+*/
+static std::string ReadFile(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::ostringstream content;
+	content << in.rdbuf();
+	return content.str();
+}
+
+std::string CBackend::GenerateProgram(PTR_AST root)
+{
+	m_scopeStack.clear();
+	m_contexts.clear();
+	m_frameIds.clear();
+	m_procedures.clear();
+	m_types.clear();
+	m_prototypes.clear();
+	m_functions.clear();
+	m_globals.Reset();
+	m_globalLayout = nullptr;
+	m_assigned.clear();
+	m_temp = 0;
+	m_indent = 0;
+	m_out = nullptr;
+
+	if (!root || root->GetKind() != ASTKind::eProgram)
+		Error("SyntaxError(CBackend): program entry not defined");
+	GenerateProgramEntryHelper(root);
+	m_globals.Push(m_globalLayout.get());
+
+	std::string source = "/* Generated from PROGRAM " + static_cast<PTR_PROGRAM_AST>(root)->GetName() + " */\n\n";
+	source += s_prelude;
+	source += m_types;
+	source += "\n" + m_prototypes;
+	source += m_functions;
+	source += "\n#ifndef PASCAL_SHARED\nint main(void)\n{\n\treturn pascal_run(stdout);\n}\n#endif\n";
+	return source;
+}
+
+void CBackend::Save(const std::string& sourcePath, const std::string& source)
+{
+	std::ofstream out(sourcePath, std::ios::binary | std::ios::trunc);
+	out.write(source.data(), source.size());
+	if (!out)
+		Error("IOError(CBackend): can not write " + sourcePath + ".");
+}
+
+void CBackend::Build(const std::string& sourcePath, const std::string& outputPath, bool sharedObject)
+{
+	CheckShellPath(sourcePath);
+	CheckShellPath(outputPath);
+	if (!std::system(nullptr))
+		Error("BuildError(CBackend): no command processor is available to run " + m_compiler + ".");
+
+	std::string logPath = outputPath + ".log";
+	std::string objectPath = outputPath + ".obj";
+	std::string command;
+	if (IsMSVC())
+	{
+		// cl names its outputs with options of its own and prints its diagnostics on the standard output
+		command = m_compiler + " /nologo /O2";
+		if (sharedObject)
+			command += " /LD /DPASCAL_SHARED";
+		command += " /Fo\"" + objectPath + "\" /Fe\"" + outputPath + "\" \"" + sourcePath + "\"";
+	}
+	else
+	{
+		command = m_compiler + " -O2";
+		if (sharedObject)
+			command += " -shared -fPIC -DPASCAL_SHARED";
+		command += " -o \"" + outputPath + "\" \"" + sourcePath + "\"";
+	}
+	command += " > \"" + logPath + "\" 2>&1";
+	int status = std::system(command.c_str());
+	std::string log = ReadFile(logPath);
+	std::remove(logPath.c_str());
+	std::remove(objectPath.c_str());
+	if (status == 0)
+		return;
+
+	// The command processor reports a command it can not find with a status of its own
+#ifdef _WIN32
+	bool missing = status == 9009;
+#else
+	bool missing = status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 127;
+#endif
+	if (missing)
+		Error("BuildError(CBackend): C compiler '" + m_compiler + "' not found, install it or add it to the PATH.");
+	Error("BuildError(CBackend): " + m_compiler + " failed to build " + sourcePath + ".\n" + log);
+}
+
+void CBackend::Run(const std::string& executablePath)
+{
+	CheckShellPath(executablePath);
+	std::string dumpPath = executablePath + ".dump";
+	std::string errorPath = executablePath + ".err";
+	int status = std::system(("\"" + executablePath + "\" > \"" + dumpPath + "\" 2> \"" + errorPath + "\"").c_str());
+	m_dump = ReadFile(dumpPath);
+	std::string error = ReadFile(errorPath);
+	std::remove(dumpPath.c_str());
+	std::remove(errorPath.c_str());
+	if (status == 0)
+		return;
+
+	// Nothing is printed after an error
+	m_dump.clear();
+	// Reported by pascal_error as "error:<pos>:<msg>"
+	size_t separator = error.find(':', 6);
+	if (error.compare(0, 6, "error:") != 0 || separator == std::string::npos)
+		Error("RuntimeError(CBackend): " + executablePath + " exited with status " + MyTemplates::Str(status) + ".");
+	long pos = std::strtol(error.c_str() + 6, nullptr, 10);
+	std::string msg = error.substr(separator + 1);
+	while (!msg.empty() && (msg.back() == '\n' || msg.back() == '\r'))
+		msg.pop_back();
+	if (pos < 0)
+		Error(msg);
+	ErrorSFD(msg, static_cast<unsigned int>(pos));
+}
+
+void CBackend::ScopeDefine(PTR_AST block)
+{
+	auto layout = static_cast<Block_AST*>(block)->GetFrameLayout();
+	if (!layout)
+		Error("ASTError(CBackend): block has no frame layout, run the semantic analyzer first.");
+
+	auto it = m_frameIds.find(block);
+	if (it == m_frameIds.end())
+	{
+		unsigned int id = static_cast<unsigned int>(m_frameIds.size());
+		it = m_frameIds.insert(std::make_pair(block, id)).first;
+
+		std::string id_str = MyTemplates::Str(id);
+		m_types += "\n/* Frame of " + layout->name + " (scope level " + MyTemplates::Str(layout->level) + ") */\n";
+		m_types += "struct frame_" + id_str + "\n{\n";
+		if (!m_scopeStack.empty())
+			m_types += "\tstruct frame_" + MyTemplates::Str(m_scopeStack.back().id) + "* link;\n";
+		// Whether each slot has been assigned
+		m_types += "\tunsigned char set[" + MyTemplates::Str(std::max(1u, layout->GetSize())) + "];\n";
+		for (unsigned int i = 0; i < layout->GetSize(); i++)
+		{
+			if (layout->types[i] == Value::Type::eEmpty)
+				Error("ASTError(CBackend): variable " + layout->names[i] + " has no type.");
+			m_types += "\t" + TypeName(layout->types[i]) + " v" + MyTemplates::Str(i) + ";\t/* " + layout->names[i] + " */\n";
+		}
+		m_types += "};\n";
+	}
+	m_scopeStack.push_back(CompileScope{ layout, it->second });
+}
+
+std::string CBackend::FrameAt(unsigned int level) const
+{
+	const Context& context = m_contexts.back();
+	std::string frame = context.frame;
+	for (unsigned int i = level; i < context.level; i++)
+		frame += "->link";
+	return frame;
+}
+
+const CBackend::CompileScope& CBackend::SlotLookUp(PTR_AST var)
+{
+	if (!var->IsResolved() || var->GetSlotLevel() > m_scopeStack.size() || var->GetSlotLevel() > m_contexts.back().level || \
+		var->GetSlotIndex() >= m_scopeStack[var->GetSlotLevel() - 1].layout->GetSize())
+		ErrorSFD("ASTError(CBackend): variable " + std::string(var->GetToken()->GetValue()) + " has not been resolved by the semantic analyzer.", var->GetToken()->GetPos());
+	return m_scopeStack[var->GetSlotLevel() - 1];
+}
+
+void CBackend::Emit(const std::string& line)
+{
+	m_out->append(m_indent, '\t');
+	*m_out += line;
+	*m_out += '\n';
+}
+
+std::string CBackend::NewTemp()
+{
+	return "t" + MyTemplates::Str(m_temp++);
+}
+
+CBackend::CValue CBackend::Spill(const CValue& value)
+{
+	std::string temp = NewTemp();
+	Emit(TypeName(value.type) + " " + temp + " = " + value.text + ";");
+	return CValue{ temp, value.type, 0 };
+}
+
+bool CBackend::IsMSVC() const
+{
+	std::string name = m_compiler.substr(m_compiler.find_last_of("/\\") + 1);
+	for (auto& c : name)
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	return name == "cl" || name == "cl.exe";
+}
+
+void CBackend::CheckShellPath(const std::string& path)
+{
+	// sh expands $ and ` inside double quotes, cmd expands % and !, a double quote or a line break ends the argument
+	if (path.find_first_of("\"$`%!\n\r") != std::string::npos)
+		Error("IOError(CBackend): " + path + " contains characters the command processor would interpret.");
+}
+
+std::string CBackend::TypeName(Value::Type type)
+{
+	switch (type)
+	{
+	case Value::Type::eInteger: return "int64_t";
+	case Value::Type::eFloat: return "double";
+	default: return "int";
+	}
+}
+
+std::string CBackend::Literal(const Value& value)
+{
+	switch (value.GetTypeTag())
+	{
+	case Value::Type::eInteger:
+		// The magnitude of the smallest INTEGER has no literal of its own
+		if (value.GetInteger() == INT64_MIN)
+			return "(-INT64_C(9223372036854775807) - 1)";
+		return "INT64_C(" + MyTemplates::Str(value.GetInteger()) + ")";
+	case Value::Type::eFloat:
+	{
+		double f = value.GetFloat();
+		if (std::isnan(f))
+			return "NAN";
+		if (std::isinf(f))
+			return (f < 0) ? "(-HUGE_VAL)" : "HUGE_VAL";
+		// Hexadecimal floating literals are exact
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%a", f);
+		return std::signbit(f) ? "(" + std::string(buffer) + ")" : std::string(buffer);
+	}
+	case Value::Type::eBoolean:
+		return value.GetBoolean() ? "1" : "0";
+	default:
+		return "0";
+	}
+}
+
+std::string CBackend::Quote(const std::string& msg)
+{
+	std::string result = "\"";
+	for (unsigned char c : msg)
+	{
+		if (c == '"' || c == '\\' || c == '?')
+		{
+			result += '\\';
+			result += c;
+		}
+		else if (c == '\n')
+		{
+			result += "\\n";
+		}
+		else if (c < 0x20 || c >= 0x7F)
+		{
+			char buffer[8];
+			std::snprintf(buffer, sizeof(buffer), "\\%03o", c);
+			result += buffer;
+		}
+		else
+		{
+			result += c;
+		}
+	}
+	return result + "\"";
+}
+
+/*
+Functionality: generate the entry (PROGRAM, block)
+*/
+
+void CBackend::GenerateProgramEntryHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(CBackend): root of GenerateProgramEntryHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a program start
+	case ASTKind::eProgram:
+		VisitProgram(static_cast<PTR_PROGRAM_AST>(root));
+		break;
+	// Condition: is a block right after the program start
+	case ASTKind::eBlock:
+		VisitBlock(static_cast<PTR_BLOCK_AST>(root));
+		break;
+	default:
+		Error("SyntaxError(CBackend): program entry not defined");
+	}
+}
+
+/*
+Functionality: generate a statement
+*/
+
+void CBackend::GenerateStatementHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(CBackend): root of GenerateStatementHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+		VisitCompound(static_cast<PTR_COMPOUND_AST>(root));
+		break;
+	// Condition: is a empty statement
+	case ASTKind::eEmpty:
+		break;
+	// Condition: is a assign statement
+	case ASTKind::eAssign:
+		VisitAssign(static_cast<PTR_ASSIGN_AST>(root));
+		break;
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+		VisitFor(static_cast<PTR_FOR_AST>(root));
+		break;
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+		VisitIf(static_cast<PTR_IF_AST>(root));
+		break;
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+		VisitWhile(static_cast<PTR_WHILE_AST>(root));
+		break;
+	// Condition: is a post-tested loop
+	case ASTKind::eRepeat:
+		VisitRepeat(static_cast<PTR_REPEAT_AST>(root));
+		break;
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		break;
+	// Condition: is a bare expression, evaluated for its errors only
+	default:
+	{
+		CValue value = GenerateExpression(root);
+		if (value.type != Value::Type::eEmpty)
+			Emit("(void)" + value.text + ";");
+	}
+	}
+}
+
+CBackend::CValue CBackend::GenerateExpression(PTR_AST root)
+{
+	std::vector<CValue> values;
+	// Slots known to be assigned before the right operand of each pending AND/OR, which may not run
+	std::vector<std::set<std::string>> assigned;
+	WalkExpression(root,
+		[&](PTR_AST leaf) { values.push_back(GenerateLeaf(leaf)); },
+		[&](PTR_BINARY_AST node)
+		{
+			CValue right = values.back();
+			values.pop_back();
+			values.back() = GenerateBinary(node, values.back(), right);
+		},
+		[&](PTR_UNARY_AST node) { values.back() = GenerateUnary(node, values.back()); },
+		[&](PTR_LOGICAL_AST node)
+		{
+			if (values.back().type != Value::Type::eBoolean)
+				ErrorSFD("ASTError(CBackend): " + node->GetToken()->ToString() + " has not been typed by the semantic analyzer.", node->GetToken()->GetPos());
+			// The left operand that decides an AND/OR is its result, the right one is only evaluated otherwise
+			values.back() = Spill(values.back());
+			Emit("if (" + values.back().text + " != " + (node->IsDecidedBy(true) ? "1" : "0") + ")");
+			Emit("{");
+			m_indent++;
+			assigned.push_back(m_assigned);
+			return true;
+		},
+		[&](PTR_LOGICAL_AST node)
+		{
+			CValue right = values.back();
+			values.pop_back();
+			if (right.type != Value::Type::eBoolean)
+				ErrorSFD("ASTError(CBackend): " + node->GetToken()->ToString() + " has not been typed by the semantic analyzer.", node->GetToken()->GetPos());
+			Emit(values.back().text + " = " + right.text + ";");
+			m_indent--;
+			Emit("}");
+			m_assigned = assigned.back();
+			assigned.pop_back();
+		});
+	return values.back();
+}
+
+CBackend::CValue CBackend::GenerateLeaf(PTR_AST root)
+{
+	switch (root->GetKind())
+	{
+	// Condition: is a procedure call or a statement used as a value, which is always empty
+	case ASTKind::eProcedure:
+	case ASTKind::eEmpty:
+	case ASTKind::eCompound:
+	case ASTKind::eAssign:
+	case ASTKind::eFor:
+	case ASTKind::eIf:
+	case ASTKind::eWhile:
+	case ASTKind::eRepeat:
+		GenerateStatementHelper(root);
+		return CValue{ "", Value::Type::eEmpty, 0 };
+	default:
+		break;
+	}
+
+	// is variable, resolved by the semantic analyzer
+	if (root->IsResolved())
+	{
+		auto& scope = SlotLookUp(root);
+		std::string frame = FrameAt(root->GetSlotLevel());
+		std::string slot = MyTemplates::Str(root->GetSlotIndex());
+		std::string set = frame + "->set[" + slot + "]";
+		if (m_assigned.insert(set).second)
+		{
+			Emit("if (!" + set + ")");
+			Emit("\tpascal_error(" + MyTemplates::Str(root->GetToken()->GetPos()) + ", " + \
+				Quote("SymbolError(Native): variable " + std::string(root->GetToken()->GetValue()) + " used before reference.") + ");");
+		}
+		// Expressions have no side effects, the slot is read where it is used
+		return CValue{ frame + "->v" + slot, scope.layout->types[root->GetSlotIndex()], 0 };
+	}
+	// is a unresolved variable
+	if (root->GetLiteral().IsEmpty() && root->GetToken()->GetType() == ID)
+		SlotLookUp(root);
+	// is static, or a type declaration
+	return CValue{ Literal(root->GetLiteral()), root->GetLiteral().GetTypeTag(), 0 };
+}
+
+CBackend::CValue CBackend::GenerateBinary(PTR_BINARY_AST root, const CValue& left, const CValue& right)
+{
+	auto op = root->GetToken();
+	auto code = GetEnumNumOp(op->GetType());
+	if (code == eUNKNOWN)
+		ErrorSFD("SyntaxError(CBackend): " + op->ToString() + " is an UNKNOWN integer operation.", op->GetPos());
+	if (!GetBinaryKernel(code, left.type, right.type))
+		ErrorSFD("ASTError(CBackend): " + op->ToString() + " has not been typed by the semantic analyzer.", op->GetPos());
+
+	// Same arithmetic as Kernels::Binary: INTEGER operands are promoted when the other one is FLOAT
+	bool isInt = left.type == Value::Type::eInteger && right.type == Value::Type::eInteger;
+	bool isFloat = left.type != Value::Type::eBoolean && !isInt;
+	std::string a = (isFloat && left.type == Value::Type::eInteger) ? "(double)" + left.text : left.text;
+	std::string b = (isFloat && right.type == Value::Type::eInteger) ? "(double)" + right.text : right.text;
+	CValue result{ "", isInt ? Value::Type::eInteger : Value::Type::eFloat, std::max(left.height, right.height) + 1 };
+
+	switch (code)
+	{
+	case eEQUAL: result.text = "(" + a + " == " + b + ")"; break;
+	case eNOT_EQUAL: result.text = "(" + a + " != " + b + ")"; break;
+	case eLESS: result.text = "(" + a + " < " + b + ")"; break;
+	case eLESS_EQUAL: result.text = "(" + a + " <= " + b + ")"; break;
+	case eGREATER: result.text = "(" + a + " > " + b + ")"; break;
+	case eGREATER_EQUAL: result.text = "(" + a + " >= " + b + ")"; break;
+	case eAND: result.text = "(" + a + " && " + b + ")"; break;
+	case eOR: result.text = "(" + a + " || " + b + ")"; break;
+	case ePLUS: result.text = isInt ? "pascal_add(" + a + ", " + b + ")" : "(" + a + " + " + b + ")"; break;
+	case eMINUS: result.text = isInt ? "pascal_sub(" + a + ", " + b + ")" : "(" + a + " - " + b + ")"; break;
+	case eMULTIPLY: result.text = isInt ? "pascal_mul(" + a + ", " + b + ")" : "(" + a + " * " + b + ")"; break;
+	default:
+		// A division can fail, it runs before the operations that follow it
+		if (code == eINT_DIV && !isInt)
+		{
+			Emit("(void)pascal_fdiv(" + a + ", " + b + ");");
+			Emit("pascal_error(-1, " + Quote("SyntaxError: integer devision applied to non-integer type.") + ");");
+			return CValue{ "0.0", Value::Type::eFloat, 0 };
+		}
+		result.text = (isInt ? "pascal_div(" : "pascal_fdiv(") + a + ", " + b + ")";
+		return Spill(result);
+	}
+	if (IsRelationalOp(code) || IsLogicalOp(code))
+		result.type = Value::Type::eBoolean;
+	return (result.height > MAX_C_EXPRESSION_NESTING) ? Spill(result) : result;
+}
+
+CBackend::CValue CBackend::GenerateUnary(PTR_UNARY_AST root, const CValue& expr)
+{
+	auto code = GetEnumNumOp(root->GetToken()->GetType());
+	if (!GetUnaryKernel(code, expr.type))
+		ErrorSFD("ASTError(CBackend): " + root->ToString() + " has not been typed by the semantic analyzer.", root->GetToken()->GetPos());
+	if (code == ePLUS)
+		return expr;
+
+	CValue result{ "", expr.type, expr.height + 1 };
+	if (code == eNOT)
+		result.text = "(!" + expr.text + ")";
+	else if (expr.type == Value::Type::eInteger)
+		result.text = "pascal_neg(" + expr.text + ")";
+	else
+		result.text = "(-" + expr.text + ")";
+	return (result.height > MAX_C_EXPRESSION_NESTING) ? Spill(result) : result;
+}
+
+void CBackend::GenerateStore(PTR_AST var, const std::string& value)
+{
+	SlotLookUp(var);
+	std::string frame = FrameAt(var->GetSlotLevel());
+	std::string slot = MyTemplates::Str(var->GetSlotIndex());
+	Emit(frame + "->v" + slot + " = " + value + ";");
+	Emit(frame + "->set[" + slot + "] = 1;");
+	m_assigned.insert(frame + "->set[" + slot + "]");
+}
+
+void CBackend::GenerateDump()
+{
+	auto& layout = *m_globalLayout;
+	Emit("fputs(" + Quote("Scoped memory table\nScope Name    : " + layout.name + "\nScope Level   : " + MyTemplates::Str(layout.level) + "\n{\n") + ", out);");
+	// Sorted by name like ScopedMemoryTable::PrintTable, unassigned slots are not printed
+	std::map<std::string, unsigned int> slots;
+	for (unsigned int i = 0; i < layout.GetSize(); i++)
+		slots.insert(std::make_pair(layout.names[i], i));
+	for (auto& slot : slots)
+	{
+		std::string name = slot.first;
+		std::string::size_type percent = 0;
+		while ((percent = name.find('%', percent)) != std::string::npos)
+		{
+			name.insert(percent, "%");
+			percent += 2;
+		}
+		Value::Type type = layout.types[slot.second];
+		std::string prefix = name + " => Token( " + Value::TypeToString(type) + ", ";
+		std::string var = "f->v" + MyTemplates::Str(slot.second);
+		Emit("if (f->set[" + MyTemplates::Str(slot.second) + "])");
+		if (type == Value::Type::eInteger)
+			Emit("\tfprintf(out, " + Quote(prefix + "%") + " PRId64 " + Quote(" )\n") + ", " + var + ");");
+		else if (type == Value::Type::eFloat)
+			Emit("\tfprintf(out, " + Quote(prefix + "%g )\n") + ", " + var + ");");
+		else
+			Emit("\tfprintf(out, " + var + " ? " + Quote(prefix + "TRUE )\n") + " : " + Quote(prefix + "FALSE )\n") + ");");
+	}
+	Emit("fputs(\"}\\n\", out);");
+}
+
+void CBackend::VisitProgram(PTR_PROGRAM_AST root)
+{
+	ScopeDefine(root->GetBlock());
+	m_globalLayout = m_scopeStack.back().layout;
+	std::string frame = "frame_" + MyTemplates::Str(m_scopeStack.back().id);
+
+	std::string body;
+	m_out = &body;
+	m_indent = 1;
+	m_contexts.push_back(Context{ 1, "f" });
+	Emit("struct " + frame + " globals;");
+	Emit("struct " + frame + "* f = &globals;");
+	Emit("memset(&globals, 0, sizeof(globals));");
+	Emit("if (setjmp(pascal_error_jump))");
+	Emit("\treturn 1;");
+	GenerateProgramEntryHelper(root->GetBlock());
+	// The global frame is printed once the program has run
+	GenerateDump();
+	Emit("return 0;");
+	m_contexts.pop_back();
+	m_scopeStack.pop_back();
+	m_out = nullptr;
+
+	m_prototypes += "PASCAL_EXPORT int pascal_run(FILE* out);\n";
+	m_functions += "\n/* PROGRAM " + root->GetName() + ", prints its memory table to out */\n";
+	m_functions += "PASCAL_EXPORT int pascal_run(FILE* out)\n{\n" + body + "}\n";
+}
+
+void CBackend::VisitProcedure(PTR_PROCEDURE_AST root)
+{
+	ScopeDefine(root->GetBlock());
+	unsigned int id = m_scopeStack.back().id;
+	m_procedures[root] = id;
+	std::string id_str = MyTemplates::Str(id);
+	std::string signature = "static void proc_" + id_str + "(struct frame_" + id_str + "* f)";
+	m_prototypes += signature + ";\n";
+
+	// Procedures become functions of their own, their frame is built by the caller
+	std::string body;
+	std::string* out = m_out;
+	unsigned int indent = m_indent;
+	std::set<std::string> assigned;
+	std::swap(assigned, m_assigned);
+	m_out = &body;
+	m_indent = 1;
+	m_contexts.push_back(Context{ m_scopeStack.back().layout->level, "f" });
+	GenerateProgramEntryHelper(root->GetBlock());
+	m_contexts.pop_back();
+	m_out = out;
+	m_indent = indent;
+	std::swap(assigned, m_assigned);
+	m_scopeStack.pop_back();
+
+	m_functions += "\n/* PROCEDURE " + root->GetName() + " */\n";
+	m_functions += signature + "\n{\n" + body + "}\n";
+}
+
+void CBackend::VisitProcedureCall(PTR_PROCEDURE_AST root)
+{
+	// Like the tree walker, a procedure is only visible to the block that declares it
+	auto procedure = root->GetDeclaration();
+	auto it = m_procedures.find(procedure);
+	if (it == m_procedures.end() || static_cast<Block_AST*>(procedure->GetBlock())->GetFrameLayout()->level != m_scopeStack.size() + 1)
+	{
+		ErrorSFD("SymbolError(CBackend): procedure " + root->GetName() + " used before reference.", root->GetToken()->GetPos());
+		return;
+	}
+	PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams());
+	std::string id_str = MyTemplates::Str(it->second);
+	std::string frame = "c" + MyTemplates::Str(m_temp++);
+
+	Emit("{");
+	m_indent++;
+	Emit("struct frame_" + id_str + " " + frame + ";");
+	Emit("memset(&" + frame + ", 0, sizeof(" + frame + "));");
+	Emit(frame + ".link = " + FrameAt(m_contexts.back().level) + ";");
+	if (ast_cast<Declaration_AST>(procedure->GetParams()))
+	{
+		if (params == nullptr)
+		{
+			Error("ASTError(CBackend): procedure arguments have not been checked by the semantic analyzer.");
+		}
+		// Arguments are assigned inside the callee frame
+		ScopeDefine(procedure->GetBlock());
+		m_contexts.push_back(Context{ m_contexts.back().level + 1, "(&" + frame + ")" });
+		for (auto& child : params->GetAllChildren())
+		{
+			if (PTR_ASSIGN_AST params_assign = ast_cast<Assign_AST>(child))
+			{
+				VisitAssign(params_assign);
+			}
+			else
+			{
+				Error("SyntaxError(CBackend): unknown parameter assignment.");
+			}
+		}
+		m_contexts.pop_back();
+		m_scopeStack.pop_back();
+	}
+	else if (params != nullptr)
+	{
+		Error("ASTError(CBackend): procedure arguments have not been checked by the semantic analyzer.");
+	}
+	Emit("proc_" + id_str + "(&" + frame + ");");
+	m_indent--;
+	Emit("}");
+}
+
+void CBackend::VisitBlock(PTR_BLOCK_AST root)
+{
+	// Process declarations, procedure bodies are generated once as functions called by their calls
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(root->GetDeclaration()))
+	{
+		for (PTR_AST decal : declaration->GetAllChildren())
+		{
+			if (PTR_PROCEDURE_AST _procedure = ast_cast<Procedure_AST>(decal))
+			{
+				VisitProcedure(_procedure);
+			}
+			else if (!ast_cast<DeclContainer_AST>(decal))
+			{
+				Error("ASTError(CBackend): unknown declaration");
+			}
+		}
+	}
+	// Process the rest of the program.
+	GenerateStatementHelper(root->GetCompound());
+}
+
+void CBackend::VisitCompound(PTR_COMPOUND_AST root)
+{
+	for (auto& child : root->GetAllChildren())
+		GenerateStatementHelper(child);
+}
+
+void CBackend::VisitAssign(PTR_ASSIGN_AST root)
+{
+	CValue rhs = GenerateExpression(root->GetRight());
+	// The semantic analyzer has checked that the types match
+	if (rhs.type == Value::Type::eEmpty)
+		ErrorSFD("ASTError(CBackend): " + root->GetVarName() + " is assigned a value that has not been typed by the semantic analyzer.", root->GetLeft()->GetToken()->GetPos());
+	GenerateStore(root->GetLeft(), rhs.text);
+}
+
+void CBackend::VisitFor(PTR_FOR_AST root)
+{
+	// Bounds are evaluated once and have been checked to be INTEGER by the semantic analyzer
+	CValue start = GenerateExpression(root->GetStart());
+	std::string first = NewTemp();
+	Emit("int64_t " + first + " = " + start.text + ";");
+	CValue end = GenerateExpression(root->GetEnd());
+	std::string last = NewTemp();
+	Emit("int64_t " + last + " = " + end.text + ";");
+
+	bool downTo = root->IsDownTo();
+	std::string i = NewTemp();
+	// The body may not run, what it assigns is not known to be assigned after the loop
+	auto assigned = m_assigned;
+	Emit("if (" + first + (downTo ? " >= " : " <= ") + last + ")");
+	Emit("{");
+	m_indent++;
+	Emit("for (int64_t " + i + " = " + first + "; ; " + i + (downTo ? "--" : "++") + ")");
+	Emit("{");
+	m_indent++;
+	GenerateStore(root->GetVariable(), i);
+	GenerateStatementHelper(root->GetBody());
+	// Stop on the end bound itself, stepping past it could overflow
+	Emit("if (" + i + " == " + last + ")");
+	Emit("\tbreak;");
+	m_indent--;
+	Emit("}");
+	m_indent--;
+	Emit("}");
+	m_assigned = assigned;
+}
+
+void CBackend::VisitIf(PTR_IF_AST root)
+{
+	// Conditions were checked to be BOOLEAN by the semantic analyzer
+	CValue condition = GenerateExpression(root->GetCondition());
+	auto assigned = m_assigned;
+	Emit("if (" + condition.text + ")");
+	Emit("{");
+	m_indent++;
+	GenerateStatementHelper(root->GetThen());
+	m_indent--;
+	Emit("}");
+	m_assigned = assigned;
+	if (root->GetElse()->GetKind() == ASTKind::eEmpty)
+		return;
+	Emit("else");
+	Emit("{");
+	m_indent++;
+	GenerateStatementHelper(root->GetElse());
+	m_indent--;
+	Emit("}");
+	m_assigned = assigned;
+}
+
+void CBackend::VisitWhile(PTR_WHILE_AST root)
+{
+	auto assigned = m_assigned;
+	Emit("for (;;)");
+	Emit("{");
+	m_indent++;
+	CValue condition = GenerateExpression(root->GetCondition());
+	Emit("if (!" + condition.text + ")");
+	Emit("\tbreak;");
+	GenerateStatementHelper(root->GetBody());
+	m_indent--;
+	Emit("}");
+	m_assigned = assigned;
+}
+
+void CBackend::VisitRepeat(PTR_REPEAT_AST root)
+{
+	auto assigned = m_assigned;
+	Emit("for (;;)");
+	Emit("{");
+	m_indent++;
+	GenerateStatementHelper(root->GetBody());
+	CValue condition = GenerateExpression(root->GetCondition());
+	Emit("if (" + condition.text + ")");
+	Emit("\tbreak;");
+	m_indent--;
+	Emit("}");
+	m_assigned = assigned;
+}
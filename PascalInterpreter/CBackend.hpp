@@ -0,0 +1,230 @@
+/*
+Ahead-of-time backend: checked AST to portable C, built by the system C compiler
+*/
+
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Interpreter.hpp"
+
+
+class CBackend : public NodeVisitor
+{
+public:
+	CBackend() : m_compiler(C_BACKEND_COMPILER), m_temp(0), m_indent(0), m_out(nullptr) {};
+	virtual ~CBackend() {};
+
+	virtual void Reset() noexcept override
+	{
+		m_compiler = C_BACKEND_COMPILER;
+		m_scopeStack.clear();
+		m_contexts.clear();
+		m_frameIds.clear();
+		m_procedures.clear();
+		m_types.clear();
+		m_prototypes.clear();
+		m_functions.clear();
+		m_globals.Reset();
+		m_globalLayout = nullptr;
+		m_dump.clear();
+		m_assigned.clear();
+		m_temp = 0;
+		m_indent = 0;
+		m_out = nullptr;
+		NodeVisitor::Reset();
+	}
+
+	// C compiler invoked by Build, C_BACKEND_COMPILER by default. cl is given MSVC options, any other compiler cc options
+	void SetCompiler(const std::string& compiler)
+	{
+		m_compiler = compiler;
+	}
+
+	void PrintAllSymbolTable() noexcept
+	{
+		m_globals.PrintAllSymbolTable();
+	}
+
+	// Memory table printed by the last native run
+	void PrintAllMemoryTable() noexcept
+	{
+		std::cout << m_dump;
+	}
+
+public:
+	/*
+	Functionality: translate the checked AST (PROGRAM, PROCEDURE, block, statements) into a C translation unit.
+	It defines 'int pascal_run(FILE* out)', which runs the program and prints its memory table to out,
+	and a main function calling it unless PASCAL_SHARED is defined.
+	Return: the C source
+	*/
+	std::string GenerateProgram(PTR_AST root);
+
+	// Write a generated C source to a file
+	void Save(const std::string& sourcePath, const std::string& source);
+
+	/*
+	Functionality: build a C source into a native executable, or into a shared object exporting pascal_run.
+	Paths are passed to the compiler through the command processor and must not contain its metacharacters
+	Return: none, the compiler diagnostics are the message of the exception thrown when it fails
+	*/
+	void Build(const std::string& sourcePath, const std::string& outputPath, bool sharedObject = false);
+
+	/*
+	Functionality: run a built executable and keep the memory table it prints
+	Return: none, a runtime error of the program is thrown at its source position
+	*/
+	void Run(const std::string& executablePath);
+
+protected:
+	/*
+	Compile time view of a scope: the C struct of its frame.
+	Every frame links to the frame of the scope enclosing it (static link), a variable of an enclosing scope
+	is reached by following as many links as there are levels between both scopes.
+	*/
+	struct CompileScope
+	{
+		std::shared_ptr<FrameLayout> layout;
+		unsigned int id;
+	};
+
+	/*
+	Frame the generated code is running in: its scope level and the C expression of a pointer to it
+	*/
+	struct Context
+	{
+		unsigned int level;
+		std::string frame;
+	};
+
+	/*
+	Value of an expression: a C expression without side effects nor runtime errors, the operations that can fail
+	(reading a variable, dividing) are checked by statements generated before it
+	*/
+	struct CValue
+	{
+		std::string text;
+		Value::Type type;
+		// Operator levels nested in text
+		unsigned int height;
+	};
+
+	// Declare the C struct of the frame of the scope a block opens and enter it
+	void ScopeDefine(PTR_AST block);
+
+	// C expression of a pointer to the frame at scope level 'level', seen from the current context
+	std::string FrameAt(unsigned int level) const;
+
+	// Check that a variable node has been resolved by the semantic analyzer, return its scope
+	const CompileScope& SlotLookUp(PTR_AST var);
+
+	// Append a line of C to the function being generated
+	void Emit(const std::string& line);
+
+	std::string NewTemp();
+
+	// Store a value into a new temporary
+	CValue Spill(const CValue& value);
+
+	// Whether m_compiler takes MSVC options
+	bool IsMSVC() const;
+
+	// Reject a path the command processor would expand or split, paths are double-quoted on the command line
+	void CheckShellPath(const std::string& path);
+
+	static std::string TypeName(Value::Type type);
+
+	static std::string Literal(const Value& value);
+
+	// C string literal of a message
+	static std::string Quote(const std::string& msg);
+
+protected:
+	/*
+	Functionality: generate the entry (PROGRAM, block)
+	*/
+	virtual void GenerateProgramEntryHelper(PTR_AST root);
+
+	/*
+	Functionality: generate a statement
+	*/
+	virtual void GenerateStatementHelper(PTR_AST root);
+
+	/*
+	Functionality: lower an expression into C. The checks of the operations that can fail are generated
+	in the order the tree walker evaluates them (see NodeVisitor::WalkExpression), so that runtime errors
+	are raised in the same order
+	Return: C expression of its value
+	*/
+	CValue GenerateExpression(PTR_AST root);
+
+	CValue GenerateLeaf(PTR_AST root);
+
+	CValue GenerateBinary(PTR_BINARY_AST root, const CValue& left, const CValue& right);
+
+	CValue GenerateUnary(PTR_UNARY_AST root, const CValue& expr);
+
+	// Store into a variable of the current context
+	void GenerateStore(PTR_AST var, const std::string& value);
+
+	// Print the memory table of the global frame
+	void GenerateDump();
+
+protected:
+	virtual void VisitProgram(PTR_PROGRAM_AST root);
+
+	virtual void VisitProcedure(PTR_PROCEDURE_AST root);
+
+	virtual void VisitProcedureCall(PTR_PROCEDURE_AST root);
+
+	virtual void VisitBlock(PTR_BLOCK_AST root);
+
+	virtual void VisitCompound(PTR_COMPOUND_AST root);
+
+	virtual void VisitAssign(PTR_ASSIGN_AST root);
+
+	virtual void VisitFor(PTR_FOR_AST root);
+
+	virtual void VisitIf(PTR_IF_AST root);
+
+	virtual void VisitWhile(PTR_WHILE_AST root);
+
+	virtual void VisitRepeat(PTR_REPEAT_AST root);
+
+protected:
+	std::string m_compiler;
+
+	// The ith scope is enclosed by the (i-1)th scope, its frame lives at level i+1 at run time
+	std::vector<CompileScope> m_scopeStack;
+	std::vector<Context> m_contexts;
+	// C struct of the frame of each block
+	std::map<PTR_AST, unsigned int> m_frameIds;
+	// C function of each procedure declaration
+	std::map<PTR_PROCEDURE_AST, unsigned int> m_procedures;
+
+	// Sections of the translation unit
+	std::string m_types;
+	std::string m_prototypes;
+	std::string m_functions;
+
+	// Frame of the program, only used to print its symbol table
+	FrameStack m_globals;
+	std::shared_ptr<FrameLayout> m_globalLayout;
+	// Memory table printed by the last run
+	std::string m_dump;
+
+	// Slots known to be assigned where the code is being generated, their reads are not checked again.
+	// A slot is never unassigned once its frame exists, so a check holds for all the code it dominates.
+	std::set<std::string> m_assigned;
+
+	unsigned int m_temp;
+	unsigned int m_indent;
+	// Body of the C function being generated
+	std::string* m_out;
+};
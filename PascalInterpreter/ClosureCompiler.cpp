@@ -0,0 +1,619 @@
+#include "ClosureCompiler.hpp"
+
+/*
+Operands read by the closure of an operator, without a call of their own
+*/
+namespace ClosureOperands
+{
+	struct Literal
+	{
+		Value value;
+
+		inline Value operator()(ClosureMachine&) const noexcept
+		{
+			return value;
+		}
+	};
+
+	struct Slot
+	{
+		unsigned int slot;
+		unsigned int pos;
+		PTR_AST var;
+
+		inline Value operator()(ClosureMachine& machine) const
+		{
+			Value value = machine.Slot(slot);
+			if (value.IsEmpty())
+				machine.Unassigned(var);
+			// Report errors at the position the variable is read
+			value.SetPos(pos);
+			return value;
+		}
+	};
+
+	struct Closure
+	{
+		ExpressionClosure closure;
+
+		inline Value operator()(ClosureMachine& machine) const
+		{
+			return closure(machine);
+		}
+	};
+
+	template <typename Left, typename Right>
+	ExpressionClosure Bind(Left left, Right right, BinaryKernel kernel)
+	{
+		return [left, right, kernel](ClosureMachine& machine)
+		{
+			// The left operand is read first
+			Value value = left(machine);
+			return kernel(value, right(machine));
+		};
+	}
+}
+
+void ClosureCompiler::CompileProgram(PTR_AST root, ClosureProgram& program)
+{
+	program.Reset();
+	m_scopeStack.clear();
+	m_procedures.clear();
+	program.SetEntry(CompileProgramEntryHelper(root));
+}
+
+void ClosureCompiler::ScopeDefine(PTR_AST block)
+{
+	auto layout = static_cast<Block_AST*>(block)->GetFrameLayout();
+	if (!layout)
+		Error("ASTError(Compiler): block has no frame layout, run the semantic analyzer first.");
+	unsigned int base = m_scopeStack.empty() ? 0 : m_scopeStack.back().base + m_scopeStack.back().layout->GetSize();
+	m_scopeStack.push_back(CompileScope{ layout, base });
+}
+
+unsigned int ClosureCompiler::SlotLookUp(PTR_AST var)
+{
+	if (!var->IsResolved() || var->GetSlotLevel() > m_scopeStack.size() || \
+		var->GetSlotIndex() >= m_scopeStack[var->GetSlotLevel() - 1].layout->GetSize())
+		ErrorSFD("ASTError(Compiler): variable " + std::string(var->GetToken()->GetValue()) + " has not been resolved by the semantic analyzer.", var->GetToken()->GetPos());
+	return m_scopeStack[var->GetSlotLevel() - 1].base + var->GetSlotIndex();
+}
+
+/*
+Functionality: compile the entry (PROGRAM, block)
+*/
+
+StatementClosure ClosureCompiler::CompileProgramEntryHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileProgramEntryHelper is null.");
+		return nullptr;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a program start
+	case ASTKind::eProgram:
+		return VisitProgram(static_cast<PTR_PROGRAM_AST>(root));
+	// Condition: is a block right after the program start
+	case ASTKind::eBlock:
+		return VisitBlock(static_cast<PTR_BLOCK_AST>(root));
+	default:
+		Error("SyntaxError(Compiler): program entry not defined");
+		return nullptr;
+	}
+}
+
+/*
+Functionality: compile a statement
+*/
+
+StatementClosure ClosureCompiler::CompileStatementHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileStatementHelper is null.");
+		return nullptr;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+		return VisitCompound(static_cast<PTR_COMPOUND_AST>(root));
+	// Condition: is a empty statement
+	case ASTKind::eEmpty:
+		return [](ClosureMachine&) {};
+	// Condition: is a assign statement
+	case ASTKind::eAssign:
+		return VisitAssign(static_cast<PTR_ASSIGN_AST>(root));
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+		return VisitFor(static_cast<PTR_FOR_AST>(root));
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+		return VisitIf(static_cast<PTR_IF_AST>(root));
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+		return VisitWhile(static_cast<PTR_WHILE_AST>(root));
+	// Condition: is a post-tested loop
+	case ASTKind::eRepeat:
+		return VisitRepeat(static_cast<PTR_REPEAT_AST>(root));
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		return VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+	// Condition: is a bare expression, evaluated for its errors only
+	default:
+	{
+		auto expr = CompileExpressionHelper(root);
+		return [expr](ClosureMachine& machine) { expr(machine); };
+	}
+	}
+}
+
+/*
+Functionality: compile an expression
+*/
+
+ExpressionClosure ClosureCompiler::CompileExpressionHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileExpressionHelper is null.");
+		return nullptr;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a binary/unary operation or a short-circuit AND/OR
+	case ASTKind::eBinary:
+	case ASTKind::eUnary:
+	case ASTKind::eLogical:
+		return CompileOperators(root);
+	// Condition: is a variable/static, or a statement used as a value
+	default:
+		return ToClosure(CompileLeaf(root));
+	}
+}
+
+ClosureCompiler::Operand ClosureCompiler::CompileLeaf(PTR_AST root)
+{
+	switch (root->GetKind())
+	{
+	// Condition: is a procedure call used as a value, which is always empty
+	case ASTKind::eProcedure:
+	{
+		auto call = VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		return Operand{ Operand::eClosure, [call](ClosureMachine& machine) { call(machine); return MAKE_EMPTY_MEMORY; } };
+	}
+	// Condition: is a statement used as a value, which is always empty
+	case ASTKind::eEmpty:
+	case ASTKind::eCompound:
+	case ASTKind::eAssign:
+	case ASTKind::eFor:
+	case ASTKind::eIf:
+	case ASTKind::eWhile:
+	case ASTKind::eRepeat:
+	{
+		auto statement = CompileStatementHelper(root);
+		return Operand{ Operand::eClosure, [statement](ClosureMachine& machine) { statement(machine); return MAKE_EMPTY_MEMORY; } };
+	}
+	default:
+		break;
+	}
+
+	// is variable, resolved by the semantic analyzer
+	if (root->IsResolved())
+	{
+		Operand operand{ Operand::eSlot };
+		operand.slot = SlotLookUp(root);
+		operand.var = root;
+		return operand;
+	}
+	// is a unresolved variable
+	if (root->GetLiteral().IsEmpty() && root->GetToken()->GetType() == ID)
+		SlotLookUp(root);
+	// is static, or a type declaration
+	Operand operand{ Operand::eLiteral };
+	operand.literal = root->GetLiteral();
+	return operand;
+}
+
+ExpressionClosure ClosureCompiler::ToClosure(const Operand& operand)
+{
+	switch (operand.kind)
+	{
+	case Operand::eLiteral:
+	{
+		Value value = operand.literal;
+		return [value](ClosureMachine&) { return value; };
+	}
+	case Operand::eSlot:
+		return ClosureOperands::Slot{ operand.slot, operand.var->GetToken()->GetPos(), operand.var };
+	default:
+		return operand.closure;
+	}
+}
+
+template <typename Left>
+ExpressionClosure ClosureCompiler::BindRight(Left left, const Operand& right, BinaryKernel kernel)
+{
+	switch (right.kind)
+	{
+	case Operand::eLiteral:
+		return ClosureOperands::Bind(left, ClosureOperands::Literal{ right.literal }, kernel);
+	case Operand::eSlot:
+		return ClosureOperands::Bind(left, ClosureOperands::Slot{ right.slot, right.var->GetToken()->GetPos(), right.var }, kernel);
+	default:
+		return ClosureOperands::Bind(left, ClosureOperands::Closure{ right.closure }, kernel);
+	}
+}
+
+ExpressionClosure ClosureCompiler::BindBinary(const Operand& left, const Operand& right, BinaryKernel kernel)
+{
+	switch (left.kind)
+	{
+	case Operand::eLiteral:
+		return BindRight(ClosureOperands::Literal{ left.literal }, right, kernel);
+	case Operand::eSlot:
+		return BindRight(ClosureOperands::Slot{ left.slot, left.var->GetToken()->GetPos(), left.var }, right, kernel);
+	default:
+		return BindRight(ClosureOperands::Closure{ left.closure }, right, kernel);
+	}
+}
+
+BinaryKernel ClosureCompiler::BinaryKernelLookUp(PTR_BINARY_AST root)
+{
+	auto op = root->GetToken();
+	auto code = GetEnumNumOp(op->GetType());
+	if (code == eUNKNOWN)
+		ErrorSFD("SyntaxError(Compiler): " + op->ToString() + " is an UNKNOWN integer operation.", op->GetPos());
+	auto kernel = GetBinaryKernel(code, root->GetLeft()->GetStaticType(), root->GetRight()->GetStaticType());
+	if (!kernel)
+		ErrorSFD("ASTError(Compiler): " + op->ToString() + " has not been typed by the semantic analyzer.", op->GetPos());
+	return kernel;
+}
+
+UnaryKernel ClosureCompiler::UnaryKernelLookUp(PTR_UNARY_AST root)
+{
+	auto kernel = GetUnaryKernel(GetEnumNumOp(root->GetToken()->GetType()), root->GetExpr()->GetStaticType());
+	if (!kernel)
+		ErrorSFD("ASTError(Compiler): " + root->ToString() + " has not been typed by the semantic analyzer.", root->GetToken()->GetPos());
+	return kernel;
+}
+
+unsigned int ClosureCompiler::OperatorHeight(PTR_AST root)
+{
+	std::vector<unsigned int> heights;
+	auto combine = [&heights](unsigned int operands)
+	{
+		unsigned int height = 0;
+		for (unsigned int i = 0; i < operands; i++)
+		{
+			height = std::max(height, heights.back());
+			heights.pop_back();
+		}
+		heights.push_back(height + 1);
+	};
+	WalkExpression(root,
+		[&](PTR_AST) { heights.push_back(0); },
+		[&](PTR_BINARY_AST) { combine(2); },
+		[&](PTR_UNARY_AST) { combine(1); },
+		[&](PTR_LOGICAL_AST) { return true; },
+		[&](PTR_LOGICAL_AST) { combine(2); });
+	return heights.back();
+}
+
+ExpressionClosure ClosureCompiler::CompileOperators(PTR_AST root)
+{
+	if (OperatorHeight(root) > MAX_CLOSURE_NESTING)
+		return CompileFlatOperators(root);
+
+	std::vector<Operand> operands;
+	WalkExpression(root,
+		[&](PTR_AST leaf) { operands.push_back(CompileLeaf(leaf)); },
+		[&](PTR_BINARY_AST node)
+		{
+			auto kernel = BinaryKernelLookUp(node);
+			Operand right = operands.back();
+			operands.pop_back();
+			operands.back() = Operand{ Operand::eClosure, BindBinary(operands.back(), right, kernel) };
+		},
+		[&](PTR_UNARY_AST node)
+		{
+			auto kernel = UnaryKernelLookUp(node);
+			auto expr = ToClosure(operands.back());
+			operands.back() = Operand{ Operand::eClosure, [expr, kernel](ClosureMachine& machine) { return kernel(expr(machine)); } };
+		},
+		[&](PTR_LOGICAL_AST) { return true; },
+		[&](PTR_LOGICAL_AST node)
+		{
+			auto right = ToClosure(operands.back());
+			operands.pop_back();
+			auto left = ToClosure(operands.back());
+			// The left operand that decides an AND/OR is its result
+			bool decider = node->IsDecidedBy(true);
+			operands.back() = Operand{ Operand::eClosure, [left, right, decider](ClosureMachine& machine)
+				{
+					Value value = left(machine);
+					if (value.GetBoolean() == decider)
+						return value;
+					return right(machine);
+				} };
+		});
+	return ToClosure(operands.back());
+}
+
+ExpressionClosure ClosureCompiler::CompileFlatOperators(PTR_AST root)
+{
+	// A step runs one operator on the operand stack and returns the index of the next step
+	using Step = std::function<size_t(ClosureMachine& machine, size_t index)>;
+	auto steps = std::make_shared<std::vector<Step>>();
+	// Steps taken when the left operand of an AND/OR decides it, completed once its right operand is compiled
+	std::vector<std::pair<size_t, bool>> shortCircuits;
+	WalkExpression(root,
+		[&](PTR_AST leaf)
+		{
+			auto expr = ToClosure(CompileLeaf(leaf));
+			steps->push_back([expr](ClosureMachine& machine, size_t index)
+				{
+					Value value = expr(machine);
+					machine.GetValues().push_back(value);
+					return index + 1;
+				});
+		},
+		[&](PTR_BINARY_AST node)
+		{
+			auto kernel = BinaryKernelLookUp(node);
+			steps->push_back([kernel](ClosureMachine& machine, size_t index)
+				{
+					auto& values = machine.GetValues();
+					Value right = values.back();
+					values.pop_back();
+					values.back() = kernel(values.back(), right);
+					return index + 1;
+				});
+		},
+		[&](PTR_UNARY_AST node)
+		{
+			auto kernel = UnaryKernelLookUp(node);
+			steps->push_back([kernel](ClosureMachine& machine, size_t index)
+				{
+					machine.GetValues().back() = kernel(machine.GetValues().back());
+					return index + 1;
+				});
+		},
+		[&](PTR_LOGICAL_AST node)
+		{
+			shortCircuits.push_back(std::make_pair(steps->size(), node->IsDecidedBy(true)));
+			steps->push_back(nullptr);
+			return true;
+		},
+		[&](PTR_LOGICAL_AST)
+		{
+			size_t end = steps->size();
+			bool decider = shortCircuits.back().second;
+			(*steps)[shortCircuits.back().first] = [end, decider](ClosureMachine& machine, size_t index)
+			{
+				auto& values = machine.GetValues();
+				if (values.back().GetBoolean() == decider)
+					return end;
+				values.pop_back();
+				return index + 1;
+			};
+			shortCircuits.pop_back();
+		});
+
+	return [steps](ClosureMachine& machine)
+	{
+		// Operands are stacked above the ones of the expressions this one is nested in (through a procedure call)
+		size_t base = machine.GetValues().size();
+		for (size_t index = 0; index < steps->size(); )
+			index = (*steps)[index](machine, index);
+		Value result = machine.GetValues().back();
+		machine.GetValues().resize(base);
+		return result;
+	};
+}
+
+StatementClosure ClosureCompiler::VisitProgram(PTR_PROGRAM_AST root)
+{
+	ScopeDefine(root->GetBlock());
+	auto layout = m_scopeStack.back().layout;
+	auto block = CompileProgramEntryHelper(root->GetBlock());
+	m_scopeStack.pop_back();
+	// The global frame is never popped so that it can be printed afterwards
+	return [layout, block](ClosureMachine& machine)
+	{
+		machine.PushFrame(layout.get());
+		block(machine);
+	};
+}
+
+void ClosureCompiler::VisitProcedure(PTR_PROCEDURE_AST root)
+{
+	ScopeDefine(root->GetBlock());
+	auto layout = m_scopeStack.back().layout;
+	auto body = std::make_shared<StatementClosure>(CompileProgramEntryHelper(root->GetBlock()));
+	m_scopeStack.pop_back();
+	m_procedures[root] = std::make_pair(layout, body);
+}
+
+StatementClosure ClosureCompiler::VisitProcedureCall(PTR_PROCEDURE_AST root)
+{
+	// Like the tree walker, a procedure is only visible to the block that declares it
+	auto it = m_procedures.find(root->GetDeclaration());
+	if (it == m_procedures.end() || it->second.first->level != m_scopeStack.size() + 1)
+	{
+		ErrorSFD("SymbolError(Compiler): procedure " + root->GetName() + " used before reference.", root->GetToken()->GetPos());
+		return nullptr;
+	}
+	auto procedure = root->GetDeclaration();
+	auto layout = it->second.first;
+	auto body = it->second.second;
+	PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams());
+
+	std::vector<StatementClosure> arguments;
+	if (ast_cast<Declaration_AST>(procedure->GetParams()))
+	{
+		if (params == nullptr)
+		{
+			Error("ASTError(Compiler): procedure arguments have not been checked by the semantic analyzer.");
+		}
+		// Arguments are assigned inside the callee frame
+		ScopeDefine(procedure->GetBlock());
+		for (auto& child : params->GetAllChildren())
+		{
+			if (PTR_ASSIGN_AST params_assign = ast_cast<Assign_AST>(child))
+			{
+				arguments.push_back(VisitAssign(params_assign));
+			}
+			else
+			{
+				Error("SyntaxError(Compiler): unknown parameter assignment.");
+			}
+		}
+		m_scopeStack.pop_back();
+	}
+	else if (params != nullptr)
+	{
+		Error("ASTError(Compiler): procedure arguments have not been checked by the semantic analyzer.");
+	}
+
+	return [layout, arguments, body](ClosureMachine& machine)
+	{
+		machine.PushFrame(layout.get());
+		for (auto& argument : arguments)
+			argument(machine);
+		(*body)(machine);
+		machine.PopFrame();
+	};
+}
+
+StatementClosure ClosureCompiler::VisitBlock(PTR_BLOCK_AST root)
+{
+	// Process declarations, procedure bodies are compiled once and shared by their calls
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(root->GetDeclaration()))
+	{
+		for (PTR_AST decal : declaration->GetAllChildren())
+		{
+			if (PTR_PROCEDURE_AST _procedure = ast_cast<Procedure_AST>(decal))
+			{
+				VisitProcedure(_procedure);
+			}
+			else if (!ast_cast<DeclContainer_AST>(decal))
+			{
+				Error("ASTError(Compiler): unknown declaration");
+			}
+		}
+	}
+	// Process the rest of the program.
+	return CompileStatementHelper(root->GetCompound());
+}
+
+StatementClosure ClosureCompiler::VisitCompound(PTR_COMPOUND_AST root)
+{
+	std::vector<StatementClosure> statements;
+	for (auto& child : root->GetAllChildren())
+	{
+		// Empty statements end every statement list, they do nothing
+		if (child->GetKind() != ASTKind::eEmpty)
+			statements.push_back(CompileStatementHelper(child));
+	}
+	if (statements.size() == 1)
+		return statements.front();
+	return [statements](ClosureMachine& machine)
+	{
+		for (auto& statement : statements)
+			statement(machine);
+	};
+}
+
+StatementClosure ClosureCompiler::VisitAssign(PTR_ASSIGN_AST root)
+{
+	auto rhs = CompileExpressionHelper(root->GetRight());
+	// The semantic analyzer has checked that the types match
+	auto slot = SlotLookUp(root->GetLeft());
+	return [rhs, slot](ClosureMachine& machine)
+	{
+		Value value = rhs(machine);
+		machine.Slot(slot) = value;
+	};
+}
+
+StatementClosure ClosureCompiler::VisitFor(PTR_FOR_AST root)
+{
+	// Bounds are evaluated once and have been checked to be INTEGER by the semantic analyzer
+	auto start = CompileExpressionHelper(root->GetStart());
+	auto end = CompileExpressionHelper(root->GetEnd());
+	auto var = root->GetVariable();
+	auto slot = SlotLookUp(var);
+	unsigned int pos = var->GetToken()->GetPos();
+	bool downTo = root->IsDownTo();
+	auto body = CompileStatementHelper(root->GetBody());
+	return [start, end, slot, pos, downTo, body](ClosureMachine& machine)
+	{
+		int64_t first = start(machine).GetInteger();
+		int64_t last = end(machine).GetInteger();
+		if (downTo ? first < last : first > last)
+			return;
+		// The induction variable is counted natively, its slot is only written for the body to read
+		int64_t step = downTo ? -1 : 1;
+		for (int64_t i = first; ; i += step)
+		{
+			machine.Slot(slot) = Value::Integer(i, pos);
+			body(machine);
+			// Stop on the end bound itself, stepping past it could overflow
+			if (i == last)
+				break;
+		}
+	};
+}
+
+StatementClosure ClosureCompiler::VisitIf(PTR_IF_AST root)
+{
+	// Conditions were checked to be BOOLEAN by the semantic analyzer
+	auto condition = CompileExpressionHelper(root->GetCondition());
+	auto then = CompileStatementHelper(root->GetThen());
+	if (root->GetElse()->GetKind() == ASTKind::eEmpty)
+	{
+		return [condition, then](ClosureMachine& machine)
+		{
+			if (condition(machine).GetBoolean())
+				then(machine);
+		};
+	}
+	auto otherwise = CompileStatementHelper(root->GetElse());
+	return [condition, then, otherwise](ClosureMachine& machine)
+	{
+		if (condition(machine).GetBoolean())
+			then(machine);
+		else
+			otherwise(machine);
+	};
+}
+
+StatementClosure ClosureCompiler::VisitWhile(PTR_WHILE_AST root)
+{
+	auto condition = CompileExpressionHelper(root->GetCondition());
+	auto body = CompileStatementHelper(root->GetBody());
+	return [condition, body](ClosureMachine& machine)
+	{
+		while (condition(machine).GetBoolean())
+			body(machine);
+	};
+}
+
+StatementClosure ClosureCompiler::VisitRepeat(PTR_REPEAT_AST root)
+{
+	auto body = CompileStatementHelper(root->GetBody());
+	auto condition = CompileExpressionHelper(root->GetCondition());
+	return [body, condition](ClosureMachine& machine)
+	{
+		do
+		{
+			body(machine);
+		} while (!condition(machine).GetBoolean());
+	};
+}
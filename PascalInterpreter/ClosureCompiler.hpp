@@ -0,0 +1,145 @@
+/*
+AST to closure compiler
+*/
+
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Interpreter.hpp"
+#include "ClosureMachine.hpp"
+
+
+class ClosureCompiler : public NodeVisitor
+{
+public:
+	ClosureCompiler() {};
+	virtual ~ClosureCompiler() {};
+
+	virtual void Reset() noexcept override
+	{
+		m_scopeStack.clear();
+		m_procedures.clear();
+		NodeVisitor::Reset();
+	}
+
+public:
+	/*
+	Functionality: compile the AST (PROGRAM, PROCEDURE, block, statements) into closures, each node once
+	Return: none, the entry closure is set in program
+	*/
+	void CompileProgram(PTR_AST root, ClosureProgram& program);
+
+protected:
+	/*
+	Compile time view of a scope: its frame layout and where its frame starts in the slots shared by every frame.
+	A procedure is only visible to the block that declares it, so its frame is always pushed right above the frames
+	of the same enclosing scopes and every variable has a fixed slot index.
+	*/
+	struct CompileScope
+	{
+		std::shared_ptr<FrameLayout> layout;
+		unsigned int base;
+	};
+
+	/*
+	Value of an expression being compiled: literals and variables are kept apart so that the operator
+	using them reads them directly instead of calling a closure
+	*/
+	struct Operand
+	{
+		enum Kind : unsigned char
+		{
+			eClosure,
+			eLiteral,
+			eSlot
+		};
+
+		Kind kind = eClosure;
+		ExpressionClosure closure = nullptr;
+		Value literal = MAKE_EMPTY_MEMORY;
+		unsigned int slot = 0;
+		PTR_AST var = nullptr;
+	};
+
+	// Enter the scope a block opens, its frame is pushed above the frame of the current scope
+	void ScopeDefine(PTR_AST block);
+
+	// Slot index of a variable node resolved by the semantic analyzer
+	unsigned int SlotLookUp(PTR_AST var);
+
+protected:
+	/*
+	Functionality: compile the entry (PROGRAM, block)
+	*/
+	virtual StatementClosure CompileProgramEntryHelper(PTR_AST root);
+
+	/*
+	Functionality: compile a statement
+	*/
+	virtual StatementClosure CompileStatementHelper(PTR_AST root);
+
+	/*
+	Functionality: compile an expression
+	*/
+	virtual ExpressionClosure CompileExpressionHelper(PTR_AST root);
+
+	// Leaf of an expression: literal, variable, procedure call or statement used as a value
+	Operand CompileLeaf(PTR_AST root);
+
+	static ExpressionClosure ToClosure(const Operand& operand);
+
+	/*
+	Functionality: compile an operator tree without native recursion (see NodeVisitor::WalkExpression).
+	Trees up to MAX_CLOSURE_NESTING operators deep become nested closures, deeper ones a flat sequence
+	of operators run over the operand stack of the machine, so that running them does not recurse either.
+	*/
+	ExpressionClosure CompileOperators(PTR_AST root);
+
+	ExpressionClosure CompileFlatOperators(PTR_AST root);
+
+	// Number of nested operators of an operator tree
+	unsigned int OperatorHeight(PTR_AST root);
+
+	// Kernels bound to the static types of the operands of a binary/unary node
+	BinaryKernel BinaryKernelLookUp(PTR_BINARY_AST root);
+
+	UnaryKernel UnaryKernelLookUp(PTR_UNARY_AST root);
+
+	// Closure applying a kernel to two operands, specialized on how each operand is read
+	static ExpressionClosure BindBinary(const Operand& left, const Operand& right, BinaryKernel kernel);
+
+	template <typename Left>
+	static ExpressionClosure BindRight(Left left, const Operand& right, BinaryKernel kernel);
+
+protected:
+	virtual StatementClosure VisitProgram(PTR_PROGRAM_AST root);
+
+	virtual void VisitProcedure(PTR_PROCEDURE_AST root);
+
+	virtual StatementClosure VisitProcedureCall(PTR_PROCEDURE_AST root);
+
+	virtual StatementClosure VisitBlock(PTR_BLOCK_AST root);
+
+	virtual StatementClosure VisitCompound(PTR_COMPOUND_AST root);
+
+	virtual StatementClosure VisitAssign(PTR_ASSIGN_AST root);
+
+	virtual StatementClosure VisitFor(PTR_FOR_AST root);
+
+	virtual StatementClosure VisitIf(PTR_IF_AST root);
+
+	virtual StatementClosure VisitWhile(PTR_WHILE_AST root);
+
+	virtual StatementClosure VisitRepeat(PTR_REPEAT_AST root);
+
+protected:
+	// The ith scope is enclosed by the (i-1)th scope, its frame lives at level i+1 at run time
+	std::vector<CompileScope> m_scopeStack;
+	// Compiled procedures: frame layout and body, shared by the closures of their calls
+	std::map<PTR_PROCEDURE_AST, std::pair<std::shared_ptr<FrameLayout>, std::shared_ptr<StatementClosure>>> m_procedures;
+};
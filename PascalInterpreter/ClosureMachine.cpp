@@ -0,0 +1,15 @@
+#include "ClosureMachine.hpp"
+
+void ClosureMachine::Run(const ClosureProgram& program)
+{
+	m_frames.Reset();
+	m_values.clear();
+	if (!program.GetEntry())
+		throw MyExceptions::MsgExecption("ASTError(ClosureMachine): the program has not been compiled.");
+	program.GetEntry()(*this);
+}
+
+void ClosureMachine::Unassigned(PTR_AST var)
+{
+	ErrorSFD("SymbolError(ClosureMachine): variable " + std::string(var->GetToken()->GetValue()) + " used before reference.", var->GetToken()->GetPos());
+}
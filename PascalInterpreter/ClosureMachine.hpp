@@ -0,0 +1,128 @@
+/*
+Runtime of the closure-compiled programs
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Frame.hpp"
+#include "AST.hpp"
+
+
+class ClosureMachine;
+
+/*
+A node compiled once into a callable: its operators, slots and kernels are bound when it is built,
+running it is a chain of calls into the closures of its children
+*/
+using ExpressionClosure = std::function<Value(ClosureMachine& machine)>;
+using StatementClosure = std::function<void(ClosureMachine& machine)>;
+
+/*
+A compiled program: the closure of its entry, which pushes the global frame and runs the main block
+*/
+class ClosureProgram
+{
+public:
+	ClosureProgram() {};
+	virtual ~ClosureProgram() {};
+
+	void Reset() noexcept
+	{
+		m_entry = nullptr;
+	}
+
+	void SetEntry(StatementClosure entry) noexcept
+	{
+		m_entry = std::move(entry);
+	}
+
+	const StatementClosure& GetEntry() const noexcept
+	{
+		return m_entry;
+	}
+
+private:
+	StatementClosure m_entry;
+};
+
+class ClosureMachine
+{
+public:
+	ClosureMachine() : m_sfd(nullptr) {};
+	virtual ~ClosureMachine() {};
+
+	void Reset() noexcept
+	{
+		m_frames.Reset();
+		m_values.clear();
+		m_sfd = nullptr;
+	}
+
+	void SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
+	{
+		m_sfd = sfd;
+	}
+
+	void PrintAllSymbolTable() noexcept
+	{
+		m_frames.PrintAllSymbolTable();
+	}
+
+	void PrintAllMemoryTable() noexcept
+	{
+		m_frames.PrintAllMemoryTable();
+	}
+
+public:
+	/*
+	Functionality: run a compiled program, the global frame is kept for printing
+	Return: none
+	*/
+	void Run(const ClosureProgram& program);
+
+	// Slot of a variable, by its index in the slots shared by every frame (bound at compile time)
+	inline Value& Slot(unsigned int index) noexcept
+	{
+		return m_frames.SlotAt(index);
+	}
+
+	void PushFrame(const FrameLayout* layout)
+	{
+		m_frames.Push(layout);
+	}
+
+	void PopFrame() noexcept
+	{
+		m_frames.Pop();
+	}
+
+	// Operand stack of the expressions run from a flat sequence of operators
+	std::vector<Value>& GetValues() noexcept
+	{
+		return m_values;
+	}
+
+	// Report a variable read before being assigned
+	void Unassigned(PTR_AST var);
+
+protected:
+	/*
+	Funtionality: helper function to throw exception with a specific message and source file location
+	*/
+	inline void ErrorSFD(const std::string& msg, unsigned int pos)
+	{
+		throw MyExceptions::MsgExecption(msg, m_sfd, pos);
+	}
+
+private:
+	FrameStack m_frames;
+	std::vector<Value> m_values;
+
+	MyDebug::SrouceFileDebugger* m_sfd;
+};
@@ -0,0 +1,468 @@
+#include "Compiler.hpp"
+
+void BytecodeCompiler::CompileProgram(PTR_AST root, BytecodeProgram& program)
+{
+	m_program = &program;
+	m_program->Reset();
+	m_scopeStack.clear();
+	CompileProgramEntryHelper(root);
+	if (m_superinstructions)
+		FuseSuperinstructions();
+	DEBUG_MSG("Compiled bytecode--->\n" + m_program->ToString());
+}
+
+void BytecodeCompiler::FuseSuperinstructions()
+{
+	auto& code = m_program->GetCode();
+	std::vector<bool> targets(code.size() + 1, false);
+	for (auto& scope : m_program->GetScopes())
+		targets[scope.entry] = true;
+	for (unsigned int i = 0; i < code.size(); i++)
+	{
+		switch (code[i].op)
+		{
+		case OP_JUMP:
+		case OP_JUMP_IF_FALSE:
+		case OP_JUMP_IF_FALSE_OR_POP:
+		case OP_JUMP_IF_TRUE_OR_POP:
+			targets[code[i].operand] = true;
+			break;
+		// The body of a loop starts right after its head and exit jump
+		case OP_FOR_TO:
+		case OP_FOR_DOWNTO:
+			targets[i + 2] = true;
+			break;
+		case OP_NEXT_TO:
+		case OP_NEXT_DOWNTO:
+			targets[code[i].operand + 2] = true;
+			break;
+		case OP_CALL:
+			targets[i + 1] = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	unsigned int i = 0;
+	while (i < code.size())
+	{
+		unsigned int length = 1;
+		for (auto& super : SUPERINSTRUCTIONS)
+		{
+			if (i + super.length > code.size())
+				continue;
+			bool matches = true;
+			for (unsigned int k = 0; k < super.length && matches; k++)
+				matches = super.Matches(k, code[i + k].op) && (k == 0 || !targets[i + k]);
+			if (matches)
+			{
+				m_program->SetOpCode(i, super.op);
+				length = super.length;
+				break;
+			}
+		}
+		i += length;
+	}
+}
+
+unsigned int BytecodeCompiler::ScopeDefine(PTR_AST block, unsigned int entry)
+{
+	auto layout = static_cast<Block_AST*>(block)->GetFrameLayout();
+	if (!layout)
+		Error("ASTError(Compiler): block has no frame layout, run the semantic analyzer first.");
+	return m_program->AddScope(ScopeInfo{ layout, entry });
+}
+
+Value::Type BytecodeCompiler::SlotLookUp(PTR_AST var)
+{
+	if (!var->IsResolved() || var->GetSlotLevel() > m_scopeStack.size())
+		ErrorSFD("ASTError(Compiler): variable " + std::string(var->GetToken()->GetValue()) + " has not been resolved by the semantic analyzer.", var->GetToken()->GetPos());
+	return m_program->GetScopes()[m_scopeStack[var->GetSlotLevel() - 1].scope].layout->types[var->GetSlotIndex()];
+}
+
+/*
+Functionality: compile the entry (PROGRAM, block)
+*/
+
+void BytecodeCompiler::CompileProgramEntryHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileProgramEntryHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a program start
+	case ASTKind::eProgram:
+		VisitProgram(static_cast<PTR_PROGRAM_AST>(root));
+		break;
+	// Condition: is a block right after the program start
+	case ASTKind::eBlock:
+		VisitBlock(static_cast<PTR_BLOCK_AST>(root));
+		break;
+	default:
+		Error("SyntaxError(Compiler): program entry not defined");
+	}
+}
+
+/*
+Functionality: compile a statement, leaving nothing on the stack
+*/
+
+void BytecodeCompiler::CompileStatementHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileStatementHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+		VisitCompound(static_cast<PTR_COMPOUND_AST>(root));
+		break;
+	// Condition: is a empty statement
+	case ASTKind::eEmpty:
+		break;
+	// Condition: is a assign statement
+	case ASTKind::eAssign:
+		VisitAssign(static_cast<PTR_ASSIGN_AST>(root));
+		break;
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+		VisitFor(static_cast<PTR_FOR_AST>(root));
+		break;
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+		VisitIf(static_cast<PTR_IF_AST>(root));
+		break;
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+		VisitWhile(static_cast<PTR_WHILE_AST>(root));
+		break;
+	// Condition: is a post-tested loop
+	case ASTKind::eRepeat:
+		VisitRepeat(static_cast<PTR_REPEAT_AST>(root));
+		break;
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		break;
+	// Condition: is a bare expression, evaluated for its errors only
+	default:
+		CompileExpressionHelper(root);
+		m_program->Emit(OP_POP);
+	}
+}
+
+/*
+Functionality: compile an expression, leaving exactly one value on the stack
+*/
+
+void BytecodeCompiler::CompileExpressionHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileExpressionHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a binary operation
+	case ASTKind::eBinary:
+		VisitBinary(static_cast<PTR_BINARY_AST>(root));
+		break;
+	// Condition: is a unary operation
+	case ASTKind::eUnary:
+		VisitUnary(static_cast<PTR_UNARY_AST>(root));
+		break;
+	// Condition: is a short-circuit AND/OR
+	case ASTKind::eLogical:
+		CompileOperators(root);
+		break;
+	// Condition: is a procedure call used as a value, which is always empty
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		m_program->Emit(OP_PUSH_CONST, m_program->AddConstant(MAKE_EMPTY_MEMORY));
+		break;
+	// Condition: is a statement used as a value, which is always empty
+	case ASTKind::eEmpty:
+	case ASTKind::eCompound:
+	case ASTKind::eAssign:
+	case ASTKind::eFor:
+	case ASTKind::eIf:
+	case ASTKind::eWhile:
+	case ASTKind::eRepeat:
+		CompileStatementHelper(root);
+		m_program->Emit(OP_PUSH_CONST, m_program->AddConstant(MAKE_EMPTY_MEMORY));
+		break;
+	// Condition: is a variable/static
+	default:
+		VisitVairbale(root);
+	}
+}
+
+void BytecodeCompiler::VisitProgram(PTR_PROGRAM_AST root)
+{
+	auto scope = ScopeDefine(root->GetBlock(), 0);
+	m_scopeStack.push_back(CompileScope{ scope, {} });
+	m_program->Emit(OP_ENTER, scope);
+	CompileProgramEntryHelper(root->GetBlock());
+	m_program->Emit(OP_HALT);
+	m_scopeStack.pop_back();
+}
+
+void BytecodeCompiler::VisitProcedure(PTR_PROCEDURE_AST root)
+{
+	auto scope = ScopeDefine(root->GetBlock(), m_program->GetCodeSize());
+	m_scopeStack.back().procedures.insert(std::make_pair(root->GetName(), std::make_pair(root, scope)));
+	m_scopeStack.push_back(CompileScope{ scope, {} });
+
+	CompileProgramEntryHelper(root->GetBlock());
+	m_program->Emit(OP_RETURN);
+	m_scopeStack.pop_back();
+}
+
+void BytecodeCompiler::VisitProcedureCall(PTR_PROCEDURE_AST root)
+{
+	// Like the tree walker, a procedure is only visible to the block that declares it
+	auto& procedures = m_scopeStack.back().procedures;
+	auto it = procedures.find(root->GetName());
+	if (it == procedures.end())
+	{
+		ErrorSFD("SymbolError(Compiler): procedure " + root->GetName() + " used before reference.", root->GetToken()->GetPos());
+		return;
+	}
+	auto procedure = it->second.first;
+	auto scope = it->second.second;
+	PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams());
+
+	m_program->Emit(OP_ENTER, scope);
+	if (ast_cast<Declaration_AST>(procedure->GetParams()))
+	{
+		if (params == nullptr)
+		{
+			Error("ASTError(Compiler): procedure arguments have not been checked by the semantic analyzer.");
+		}
+		// Arguments are assigned inside the callee frame
+		m_scopeStack.push_back(CompileScope{ scope, {} });
+		for (auto& child : params->GetAllChildren())
+		{
+			if (PTR_ASSIGN_AST params_assign = ast_cast<Assign_AST>(child))
+			{
+				VisitAssign(params_assign);
+			}
+			else
+			{
+				Error("SyntaxError(Compiler): unknown parameter assignment.");
+			}
+		}
+		m_scopeStack.pop_back();
+	}
+	else if (params != nullptr)
+	{
+		Error("ASTError(Compiler): procedure arguments have not been checked by the semantic analyzer.");
+	}
+	m_program->Emit(OP_CALL, scope, root->GetToken()->GetPos());
+}
+
+void BytecodeCompiler::VisitBlock(PTR_BLOCK_AST root)
+{
+	// Process declarations.
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(root->GetDeclaration()))
+	{
+		// Procedure bodies are emitted inline and jumped over
+		unsigned int jump = 0;
+		bool hasProcedure = false;
+		for (PTR_AST decal : declaration->GetAllChildren())
+		{
+			if (PTR_PROCEDURE_AST _procedure = ast_cast<Procedure_AST>(decal))
+			{
+				if (!hasProcedure)
+				{
+					jump = m_program->Emit(OP_JUMP);
+					hasProcedure = true;
+				}
+				VisitProcedure(_procedure);
+			}
+			else if (!ast_cast<DeclContainer_AST>(decal))
+			{
+				Error("ASTError(Compiler): unknown declaration");
+			}
+		}
+		if (hasProcedure)
+			m_program->Patch(jump, m_program->GetCodeSize());
+	}
+	// Process the rest of the program.
+	CompileStatementHelper(root->GetCompound());
+}
+
+void BytecodeCompiler::VisitCompound(PTR_COMPOUND_AST root)
+{
+	for (auto& child : root->GetAllChildren())
+	{
+		CompileStatementHelper(child);
+	}
+}
+
+void BytecodeCompiler::VisitBinary(PTR_BINARY_AST root)
+{
+	CompileOperators(root);
+}
+
+void BytecodeCompiler::VisitUnary(PTR_UNARY_AST root)
+{
+	CompileOperators(root);
+}
+
+void BytecodeCompiler::CompileOperators(PTR_AST root)
+{
+	// Jumps taken when the left operand of an AND/OR decides it, patched once its right operand is compiled
+	std::vector<unsigned int> shortCircuits;
+	WalkExpression(root,
+		[&](PTR_AST leaf) { CompileExpressionHelper(leaf); },
+		[&](PTR_BINARY_AST node) { EmitBinary(node); },
+		[&](PTR_UNARY_AST node) { EmitUnary(node); },
+		[&](PTR_LOGICAL_AST node)
+		{
+			auto op = (node->GetToken()->GetType() == OR) ? OP_JUMP_IF_TRUE_OR_POP : OP_JUMP_IF_FALSE_OR_POP;
+			shortCircuits.push_back(m_program->Emit(op, 0, node->GetToken()->GetPos()));
+			return true;
+		},
+		[&](PTR_LOGICAL_AST)
+		{
+			m_program->Patch(shortCircuits.back(), m_program->GetCodeSize());
+			shortCircuits.pop_back();
+		});
+}
+
+void BytecodeCompiler::EmitBinary(PTR_BINARY_AST root)
+{
+	auto op = root->GetToken();
+	auto code = GetEnumNumOp(op->GetType());
+	if (code == eUNKNOWN)
+		ErrorSFD("SyntaxError(Compiler): " + op->ToString() + " is an UNKNOWN integer operation.", op->GetPos());
+	auto kernel = GetBinaryKernelIndex(code, root->GetLeft()->GetStaticType(), root->GetRight()->GetStaticType());
+	if (kernel >= BINARY_KERNELS.size())
+		ErrorSFD("ASTError(Compiler): " + op->ToString() + " has not been typed by the semantic analyzer.", op->GetPos());
+	m_program->Emit(GetBinaryOpCode(code), kernel, op->GetPos());
+}
+
+void BytecodeCompiler::EmitUnary(PTR_UNARY_AST root)
+{
+	auto op = root->GetToken();
+	auto kernel = GetUnaryKernelIndex(GetEnumNumOp(op->GetType()), root->GetExpr()->GetStaticType());
+	if (kernel >= UNARY_KERNELS.size())
+		ErrorSFD("ASTError(Compiler): " + root->ToString() + " has not been typed by the semantic analyzer.", op->GetPos());
+	auto code = (op->GetType() == MINUS) ? OP_NEG : ((op->GetType() == NOT) ? OP_NOT : OP_POS);
+	m_program->Emit(code, kernel, op->GetPos());
+}
+
+void BytecodeCompiler::VisitAssign(PTR_ASSIGN_AST root)
+{
+	CompileExpressionHelper(root->GetRight());
+	auto var = root->GetLeft();
+	auto type = SlotLookUp(var);
+	m_program->Emit(OP_STORE, var->GetSlotIndex(), root->GetToken()->GetPos(), var->GetSlotLevel(), type);
+}
+
+void BytecodeCompiler::VisitFor(PTR_FOR_AST root)
+{
+	/*
+		start, end
+		head:	FOR_TO		level slot		skips the exit jump unless the range is empty
+				JUMP		exit
+		body:	...
+				NEXT_TO		head			back to body while the counter has not reached end
+		exit:
+	The counter and the end bound stay on the stack for the whole loop, the body is stack neutral.
+	*/
+	CompileExpressionHelper(root->GetStart());
+	CompileExpressionHelper(root->GetEnd());
+	auto var = root->GetVariable();
+	SlotLookUp(var);
+	auto head = m_program->Emit(root->IsDownTo() ? OP_FOR_DOWNTO : OP_FOR_TO, var->GetSlotIndex(), var->GetToken()->GetPos(), \
+		var->GetSlotLevel());
+	auto exit = m_program->Emit(OP_JUMP);
+	CompileStatementHelper(root->GetBody());
+	m_program->Emit(root->IsDownTo() ? OP_NEXT_DOWNTO : OP_NEXT_TO, head, root->GetToken()->GetPos());
+	m_program->Patch(exit, m_program->GetCodeSize());
+}
+
+void BytecodeCompiler::VisitIf(PTR_IF_AST root)
+{
+	/*
+			condition
+			JUMP_IF_FALSE	else
+			then
+			JUMP			end			only with an ELSE branch
+		else:
+			otherwise
+		end:
+	*/
+	CompileExpressionHelper(root->GetCondition());
+	auto skipThen = m_program->Emit(OP_JUMP_IF_FALSE, 0, root->GetToken()->GetPos());
+	CompileStatementHelper(root->GetThen());
+	if (root->GetElse()->GetKind() == ASTKind::eEmpty)
+	{
+		m_program->Patch(skipThen, m_program->GetCodeSize());
+		return;
+	}
+	auto skipElse = m_program->Emit(OP_JUMP);
+	m_program->Patch(skipThen, m_program->GetCodeSize());
+	CompileStatementHelper(root->GetElse());
+	m_program->Patch(skipElse, m_program->GetCodeSize());
+}
+
+void BytecodeCompiler::VisitWhile(PTR_WHILE_AST root)
+{
+	/*
+		top:	condition
+				JUMP_IF_FALSE	exit
+				body
+				JUMP			top
+		exit:
+	*/
+	auto top = m_program->GetCodeSize();
+	CompileExpressionHelper(root->GetCondition());
+	auto exit = m_program->Emit(OP_JUMP_IF_FALSE, 0, root->GetToken()->GetPos());
+	CompileStatementHelper(root->GetBody());
+	m_program->Emit(OP_JUMP, top);
+	m_program->Patch(exit, m_program->GetCodeSize());
+}
+
+void BytecodeCompiler::VisitRepeat(PTR_REPEAT_AST root)
+{
+	/*
+		top:	body
+				condition
+				JUMP_IF_FALSE	top
+	*/
+	auto top = m_program->GetCodeSize();
+	CompileStatementHelper(root->GetBody());
+	CompileExpressionHelper(root->GetCondition());
+	m_program->Emit(OP_JUMP_IF_FALSE, top, root->GetToken()->GetPos());
+}
+
+void BytecodeCompiler::VisitVairbale(PTR_AST root)
+{
+	auto token = root->GetToken();
+
+	// is variable
+	if (root->IsResolved() || token->GetType() == ID)
+	{
+		SlotLookUp(root);
+		m_program->Emit(OP_LOAD, root->GetSlotIndex(), token->GetPos(), root->GetSlotLevel());
+	}
+	// is static
+	else
+	{
+		m_program->Emit(OP_PUSH_CONST, m_program->AddConstant(root->GetLiteral()), token->GetPos());
+	}
+}
@@ -0,0 +1,123 @@
+/*
+AST to bytecode compiler
+*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Interpreter.hpp"
+#include "Bytecode.hpp"
+
+
+class BytecodeCompiler : public NodeVisitor
+{
+public:
+	BytecodeCompiler() : m_program(nullptr), m_superinstructions(true) {};
+	virtual ~BytecodeCompiler() {};
+
+	virtual void Reset() noexcept override
+	{
+		m_scopeStack.clear();
+		m_program = nullptr;
+		m_superinstructions = true;
+		NodeVisitor::Reset();
+	}
+
+	// Whether the compiled code is fused into superinstructions, off to profile the plain op codes
+	void SetSuperinstructions(bool superinstructions) noexcept
+	{
+		m_superinstructions = superinstructions;
+	}
+
+public:
+	/*
+	Functionality: lower the AST (PROGRAM, PROCEDURE, block, statements) into linear bytecode
+	Return: none, the code is emitted into program
+	*/
+	void CompileProgram(PTR_AST root, BytecodeProgram& program);
+
+protected:
+	/*
+	Compile time view of a scope: its ScopeInfo and the procedures it declares
+	*/
+	struct CompileScope
+	{
+		unsigned int scope;
+		std::map<std::string, std::pair<PTR_PROCEDURE_AST, unsigned int>> procedures;
+	};
+
+	// Add the scope a block opens to the program
+	unsigned int ScopeDefine(PTR_AST block, unsigned int entry);
+
+	// Return the declared type of a variable node resolved by the semantic analyzer
+	Value::Type SlotLookUp(PTR_AST var);
+
+protected:
+	/*
+	Functionality: compile the entry (PROGRAM, block)
+	*/
+	virtual void CompileProgramEntryHelper(PTR_AST root);
+
+	/*
+	Functionality: compile a statement, leaving nothing on the stack
+	*/
+	virtual void CompileStatementHelper(PTR_AST root);
+
+	/*
+	Functionality: compile an expression, leaving exactly one value on the stack
+	*/
+	virtual void CompileExpressionHelper(PTR_AST root);
+
+protected:
+	virtual void VisitProgram(PTR_PROGRAM_AST root);
+
+	virtual void VisitProcedure(PTR_PROCEDURE_AST root);
+
+	virtual void VisitProcedureCall(PTR_PROCEDURE_AST root);
+
+	virtual void VisitBlock(PTR_BLOCK_AST root);
+
+	virtual void VisitCompound(PTR_COMPOUND_AST root);
+
+	virtual void VisitBinary(PTR_BINARY_AST root);
+
+	virtual void VisitUnary(PTR_UNARY_AST root);
+
+	virtual void VisitAssign(PTR_ASSIGN_AST root);
+
+	virtual void VisitFor(PTR_FOR_AST root);
+
+	virtual void VisitIf(PTR_IF_AST root);
+
+	virtual void VisitWhile(PTR_WHILE_AST root);
+
+	virtual void VisitRepeat(PTR_REPEAT_AST root);
+
+	virtual void VisitVairbale(PTR_AST root);
+
+	/*
+	Functionality: compile an operator tree in post order without native recursion (see NodeVisitor::WalkExpression)
+	*/
+	void CompileOperators(PTR_AST root);
+
+	// Emit the op code of a binary/unary node whose operands are already on the stack
+	void EmitBinary(PTR_BINARY_AST root);
+
+	void EmitUnary(PTR_UNARY_AST root);
+
+	/*
+	Functionality: replace the sequences of SUPERINSTRUCTIONS by their superinstruction, a sequence is only fused
+	when no jump, call return or loop lands inside it
+	*/
+	void FuseSuperinstructions();
+
+protected:
+	BytecodeProgram* m_program;
+	// The ith scope is enclosed by the (i-1)th scope, its frame lives at level i+1 at run time
+	std::vector<CompileScope> m_scopeStack;
+	bool m_superinstructions;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Value.hpp"
+#include "Symbol.hpp"
+
+/*
+Frame layout of a scope (the program or a procedure), computed ahead of time by the semantic analyzer:
+one slot per parameter/variable, in declaration order.
+*/
+struct FrameLayout
+{
+	std::string name;
+	unsigned int level = 0;
+	std::vector<std::string> names;
+	std::vector<Value::Type> types;
+
+	unsigned int GetSize() const noexcept
+	{
+		return static_cast<unsigned int>(names.size());
+	}
+};
+
+/*
+Contiguous activation-record stack.
+All frames share one slot vector: a call bumps the top of stack by the frame size, a return moves it back.
+Frames are addressed by index, so growing the slot vector never invalidates a frame.
+*/
+class FrameStack
+{
+public:
+	FrameStack() : m_top(0) {};
+	virtual ~FrameStack() {};
+
+	void Reset() noexcept
+	{
+		m_slots.clear();
+		m_frames.clear();
+		m_top = 0;
+	}
+
+	/*
+	Functionality: push a frame with every slot unassigned
+	*/
+	void Push(const FrameLayout* layout)
+	{
+		unsigned int base = m_top;
+		m_top += layout->GetSize();
+		if (m_top > m_slots.size())
+			m_slots.resize(std::max<size_t>(m_top, m_slots.size() * 2));
+		std::fill(m_slots.begin() + base, m_slots.begin() + m_top, MAKE_EMPTY_MEMORY);
+		m_frames.push_back(Frame{ base, layout });
+	}
+
+	void Pop() noexcept
+	{
+		m_top = m_frames.back().base;
+		m_frames.pop_back();
+	}
+
+	/*
+	Functionality: slot of a variable in the frame at scope level 'level'
+	Frames are only pushed for procedures declared by the current scope, so frame i always belongs to scope level i+1
+	*/
+	inline Value& Slot(unsigned int level, unsigned int slot) noexcept
+	{
+		return m_slots[m_frames[level - 1].base + slot];
+	}
+
+	// Index of the same slot in the slot vector, valid for as long as the frames below it stay the same
+	inline unsigned int GetSlotIndex(unsigned int level, unsigned int slot) const noexcept
+	{
+		return m_frames[level - 1].base + slot;
+	}
+
+	inline Value& SlotAt(unsigned int index) noexcept
+	{
+		return m_slots[index];
+	}
+
+	inline const FrameLayout& GetLayout(unsigned int level) const noexcept
+	{
+		return *(m_frames[level - 1].layout);
+	}
+
+	unsigned int GetDepth() const noexcept
+	{
+		return static_cast<unsigned int>(m_frames.size());
+	}
+
+	void PrintAllSymbolTable() noexcept
+	{
+		for (auto& frame : m_frames)
+		{
+			ScopedSymbolTable table(frame.layout->name, frame.layout->level);
+			for (unsigned int i = 0; i < frame.layout->GetSize(); i++)
+				table.define(frame.layout->names[i], VarSymbol(frame.layout->names[i], TypeSymbol(Value::TypeToString(frame.layout->types[i]))));
+			table.PrintTable();
+		}
+	}
+
+	void PrintAllMemoryTable() noexcept
+	{
+		for (auto& frame : m_frames)
+		{
+			ScopedMemoryTable table(frame.layout->name, frame.layout->level);
+			for (unsigned int i = 0; i < frame.layout->GetSize(); i++)
+				table.lookup(table.define(frame.layout->names[i], frame.layout->types[i])) = m_slots[frame.base + i];
+			table.PrintTable();
+		}
+	}
+
+private:
+	struct Frame
+	{
+		unsigned int base;
+		const FrameLayout* layout;
+	};
+
+	std::vector<Value> m_slots;
+	std::vector<Frame> m_frames;
+	unsigned int m_top;
+};
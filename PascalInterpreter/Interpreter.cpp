@@ -5,7 +5,7 @@ Functionality: interpreting the entry (PROGRAM, block, PROCEDURE, Declaration)
 Return: InterpretProgram
 */
 
-SHARE_TOKEN_STRING Interpreter::InterpretProgramEntryHelper(SHARE_AST root)
+Value Interpreter::InterpretProgramEntryHelper(PTR_AST root)
 {
 	if (!root)
 	{
@@ -13,18 +13,15 @@ SHARE_TOKEN_STRING Interpreter::InterpretProgramEntryHelper(SHARE_AST root)
 		return MAKE_EMPTY_MEMORY;
 	}
 
-	// Condition: is a program start
-	if (SHARE_PROGRAM_AST root_0 = dynamic_pointer_cast<Program_AST>(root))
+	switch (root->GetKind())
 	{
-		return VisitProgram(root_0);
-	}
+	// Condition: is a program start
+	case ASTKind::eProgram:
+		return VisitProgram(static_cast<PTR_PROGRAM_AST>(root));
 	// Condition: is a block right after the program start
-	else if (SHARE_BLOCk_AST root_1 = dynamic_pointer_cast<Block_AST>(root))
-	{
-		return VisitBlock(root_1);
-	}
-	else
-	{
+	case ASTKind::eBlock:
+		return VisitBlock(static_cast<PTR_BLOCK_AST>(root));
+	default:
 		Error("SyntaxError(Interpreter): program entry not defined");
 		return MAKE_EMPTY_MEMORY;
 	}
@@ -36,7 +33,7 @@ Functionality: interpreting the program (statments, assignment, operators, varia
 Return: InterpretProgram
 */
 
-SHARE_TOKEN_STRING Interpreter::InterpretProgramHelper(SHARE_AST root)
+Value Interpreter::InterpretProgramHelper(PTR_AST root)
 {
 	if (!root)
 	{
@@ -44,55 +41,64 @@ SHARE_TOKEN_STRING Interpreter::InterpretProgramHelper(SHARE_AST root)
 		return MAKE_EMPTY_MEMORY;
 	}
 
-	// Condition: is a compound statment
-	if (SHARE_COMPOUND_AST root_0 = dynamic_pointer_cast<Compound_AST>(root))
+	switch (root->GetKind())
 	{
-		return VisitCompound(root_0);
-	}
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+		return VisitCompound(static_cast<PTR_COMPOUND_AST>(root));
 	// Condition: is a binary operation
-	else if (SHARE_BINARY_AST root_1 = dynamic_pointer_cast<BinaryOp_AST>(root))
-	{
-		return VisitBinary(root_1);
-	}
+	case ASTKind::eBinary:
+		return VisitBinary(static_cast<PTR_BINARY_AST>(root));
 	// Condition: is a unary operation
-	else if (SHARE_UNARY_AST root_2 = dynamic_pointer_cast<UnaryOp_AST>(root))
-	{
-		return VisitUnary(root_2);
-	}
+	case ASTKind::eUnary:
+		return VisitUnary(static_cast<PTR_UNARY_AST>(root));
+	// Condition: is a short-circuit AND/OR
+	case ASTKind::eLogical:
+		return VisitLogical(static_cast<PTR_LOGICAL_AST>(root));
 	// Condition: is a empty statement
-	else if (SHARE_EMPTY_AST root_3 = dynamic_pointer_cast<Empty_AST>(root))
-	{
-		return VisitEmpty(root_3);
-	}
+	case ASTKind::eEmpty:
+		return VisitEmpty(static_cast<PTR_EMPTY_AST>(root));
 	// Condition: is a assign statement
-	else if (SHARE_ASSIGN_AST root_4 = dynamic_pointer_cast<Assign_AST>(root))
-	{
-		return VisitAssign(root_4);
-	}
-	// Condition: is a assign statement
-	else if (SHARE_PROCEDURE_AST root_5 = dynamic_pointer_cast<Procedure_AST>(root))
-	{
-		return VisitProcedureCall(root_5);
-	}
+	case ASTKind::eAssign:
+		return VisitAssign(static_cast<PTR_ASSIGN_AST>(root));
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+		return VisitFor(static_cast<PTR_FOR_AST>(root));
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+		return VisitIf(static_cast<PTR_IF_AST>(root));
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+		return VisitWhile(static_cast<PTR_WHILE_AST>(root));
+	// Condition: is a post-tested loop
+	case ASTKind::eRepeat:
+		return VisitRepeat(static_cast<PTR_REPEAT_AST>(root));
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		return VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
 	// Condition: is a variable/static
-	else
-	{
+	default:
 		return VisitVairbale(root);
 	}
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitProgram(SHARE_PROGRAM_AST root)
+Value Interpreter::VisitProgram(PTR_PROGRAM_AST root)
 {
 	DEBUG_MSG("Running program---> " + root->GetName());
-	AddTable(root->GetName(), 1);
+	// The global frame is never popped so that it can be printed afterwards
+	PushFrame(static_cast<Block_AST*>(root->GetBlock()));
 	return InterpretProgramEntryHelper(root->GetBlock());
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitProcedureCall(SHARE_PROCEDURE_AST root)
+Value Interpreter::VisitProcedureCall(PTR_PROCEDURE_AST root)
 {
-	auto procedure = ProcedureTableLookUp(root->GetName(), root->GetToken());
+	auto procedure = root->GetDeclaration();
+	if (!procedure)
+	{
+		ErrorSFD("ASTError(Interpreter): procedure " + root->GetName() + " has not been resolved by the semantic analyzer.", root->GetToken()->GetPos());
+	}
 
-	if (SHARE_COMPOUND_AST params = dynamic_pointer_cast<Compound_AST>(root->GetParams()))
+	if (PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams()))
 	{
 		return VisitProcedure(procedure, params);
 	}
@@ -102,47 +108,22 @@ SHARE_TOKEN_STRING Interpreter::VisitProcedureCall(SHARE_PROCEDURE_AST root)
 	}
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitProcedure(SHARE_PROCEDURE_AST root, SHARE_COMPOUND_AST params)
+Value Interpreter::VisitProcedure(PTR_PROCEDURE_AST root, PTR_COMPOUND_AST params)
 {
 	DEBUG_MSG("Running procedure---> " + root->GetName());
-	AddTable(root->GetName());
+	PushFrame(static_cast<Block_AST*>(root->GetBlock()));
 
 	// Process parameters
-	if (SHARE_DECLARATION_AST declaration = dynamic_pointer_cast<Declaration_AST>(root->GetParams()))
+	if (ast_cast<Declaration_AST>(root->GetParams()))
 	{
-
 		if (params == nullptr)
 		{
-			Error("SyntaxError(Interpreter): Procedure parameters are declared without reference.");
-		}
-		// Define parameter
-		for (SHARE_AST& decal : declaration->GetAllChildren())
-		{
-			// Condition: is a variable declaration
-			if (SHARE_DECLCONTAINER_AST _declConatiner = dynamic_pointer_cast<DeclContainer_AST>(decal))
-			{
-				for (SHARE_AST& varDecal : _declConatiner->GetAllChildren())
-				{
-					if (SHARE_VARDECL_AST _varDecal = dynamic_pointer_cast<VarDecl_AST>(varDecal))
-					{
-						SymbolTableDefine(_varDecal);
-					}
-					else
-					{
-						Error("SyntaxError(Interpreter): unknown parameter declaration");
-					}
-				}
-				DEBUG_RUN(PrintCurrentSymbolTable());
-			}
-			else
-			{
-				Error("SyntaxError(Interpreter): unknown declaration");
-			}
+			Error("ASTError(Interpreter): procedure arguments have not been checked by the semantic analyzer.");
 		}
-		// Assign parameter
+		// Assign parameter, the parameters are the first slots of the frame
 		for (auto& child : params->GetAllChildren())
 		{
-			if (SHARE_ASSIGN_AST params_assign = dynamic_pointer_cast<Assign_AST>(child))
+			if (PTR_ASSIGN_AST params_assign = ast_cast<Assign_AST>(child))
 			{
 				VisitAssign(params_assign);
 			}
@@ -154,64 +135,27 @@ SHARE_TOKEN_STRING Interpreter::VisitProcedure(SHARE_PROCEDURE_AST root, SHARE_C
 	}
 	else if (params != nullptr)
 	{
-		Error("SyntaxError(Interpreter): Too many arguments for procedure.");
+		Error("ASTError(Interpreter): procedure arguments have not been checked by the semantic analyzer.");
 	}
 	else
 	{
 		DEBUG_MSG("Procedure has no parameter");
 	}
 
-	return InterpretProgramEntryHelper(root->GetBlock());
+	auto result = InterpretProgramEntryHelper(root->GetBlock());
+	m_frames.Pop();
+	return result;
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitBlock(SHARE_BLOCk_AST root)
+Value Interpreter::VisitBlock(PTR_BLOCK_AST root)
 {
-	// Process declarations.
-	if (SHARE_DECLARATION_AST declaration = dynamic_pointer_cast<Declaration_AST>(root->GetDeclaration()))
-	{
-		for (SHARE_AST& decal : declaration->GetAllChildren())
-		{
-			// Condition: is a variable declaration
-			if (SHARE_DECLCONTAINER_AST _declConatiner = dynamic_pointer_cast<DeclContainer_AST>(decal))
-			{
-				for (SHARE_AST& varDecal : _declConatiner->GetAllChildren())
-				{
-					if (SHARE_VARDECL_AST _varDecal = dynamic_pointer_cast<VarDecl_AST>(varDecal))
-					{
-						SymbolTableDefine(_varDecal);
-					}
-					else
-					{
-						Error("SyntaxError(Interpreter): unknown variable declaration");
-					}
-				}
-				DEBUG_RUN(PrintCurrentSymbolTable());
-			}
-			// Condition: is a procedure start
-			else if (SHARE_PROCEDURE_AST _procedure = dynamic_pointer_cast<Procedure_AST>(decal))
-			{
-				ProcedureTableDefine(_procedure);
-				DEBUG_RUN(PrintCurrentProcedureTable());
-			}
-			else
-			{
-				Error("ASTError(Interpreter): unknown declaration");
-			}
-		}
-	}
-	else
-	{
-		DEBUG_MSG("Has no declaration.");
-	}
-	// Process the rest of the program.
-	auto result = InterpretProgramHelper(root->GetCompound());
-	PopBackTable();
-	return result;
+	// Declarations have been laid out in the frame by the semantic analyzer, process the rest of the program.
+	return InterpretProgramHelper(root->GetCompound());
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitCompound(SHARE_COMPOUND_AST root)
+Value Interpreter::VisitCompound(PTR_COMPOUND_AST root)
 {
-	SHARE_TOKEN_STRING result;
+	Value result;
 	for (auto& child : root->GetAllChildren())
 	{
 		DEBUG_MSG("Running statements list---> " + child->ToString());
@@ -220,94 +164,313 @@ SHARE_TOKEN_STRING Interpreter::VisitCompound(SHARE_COMPOUND_AST root)
 	return result;
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitBinary(SHARE_BINARY_AST root)
+Value Interpreter::VisitBinary(PTR_BINARY_AST root)
+{
+	Value result;
+	if (EvaluateQuickened(root, result))
+		return result;
+	return EvaluateExpression(root);
+}
+
+Value Interpreter::VisitUnary(PTR_UNARY_AST root)
 {
-	SHARE_TOKEN_STRING left = InterpretProgramHelper(root->GetLeft());
-	SHARE_TOKEN_STRING right = InterpretProgramHelper(root->GetRight());
-	SHARE_TOKEN_STRING op = InterpretProgramHelper(root->GetOp());
-	DEBUG_MSG("Running binary operation---> Left: " + left->ToString() + " Right: " + right->ToString() + " OP: " + op->ToString());
-	return m_opeartor.exprBinaryDeciamlNumOp(left, right, op);
+	return EvaluateExpression(root);
+}
+
+Value Interpreter::VisitLogical(PTR_LOGICAL_AST root)
+{
+	return EvaluateExpression(root);
+}
+
+Value Interpreter::EvaluateExpression(PTR_AST root)
+{
+	// Operands are stacked above the ones of the evaluations this one is nested in (through a procedure call)
+	size_t base = m_values.size();
+	WalkExpression(root,
+		[&](PTR_AST leaf)
+		{
+			m_values.push_back(InterpretProgramHelper(leaf));
+		},
+		[&](PTR_BINARY_AST node)
+		{
+			Value right = m_values.back();
+			m_values.pop_back();
+			m_values.back() = ApplyBinary(node, m_values.back(), right);
+		},
+		[&](PTR_UNARY_AST node)
+		{
+			m_values.back() = ApplyUnary(node, m_values.back());
+		},
+		[&](PTR_LOGICAL_AST node)
+		{
+			return NeedsRightOperand(node, m_values.back());
+		},
+		[&](PTR_LOGICAL_AST node)
+		{
+			Value right = m_values.back();
+			m_values.pop_back();
+			m_values.back() = ApplyLogical(node, m_values.back(), right);
+		},
+		[&](PTR_BINARY_AST node)
+		{
+			Value result;
+			if (!EvaluateQuickened(node, result))
+				return false;
+			m_values.push_back(result);
+			return true;
+		});
+	Value result = m_values.back();
+	m_values.resize(base);
+	return result;
+}
+
+Value Interpreter::ApplyBinary(PTR_BINARY_AST root, const Value& left, const Value& right)
+{
+	auto op = root->GetToken();
+	DEBUG_MSG("Running binary operation---> Left: " + left.ToString() + " Right: " + right.ToString() + " OP: " + op->ToString());
+	// The node was bound to the kernel of its operand types by the semantic analyzer
+	if (BinaryKernel kernel = root->GetKernel())
+		return kernel(left, right);
+	ErrorSFD("ASTError(Interpreter): " + op->ToString() + " has not been typed by the semantic analyzer.", op->GetPos());
+	return MAKE_EMPTY_MEMORY;
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitUnary(SHARE_UNARY_AST root)
+Value Interpreter::ApplyUnary(PTR_UNARY_AST root, const Value& operand)
 {
-	SHARE_TOKEN_STRING result = InterpretProgramHelper(root->GetExpr());
-	if (result->GetType() == INTEGER)
+	DEBUG_MSG("Running unary operation---> " + operand.ToString());
+	if (UnaryKernel kernel = root->GetKernel())
+		return kernel(operand);
+	ErrorSFD("ASTError(Interpreter): " + root->ToString() + " has not been typed by the semantic analyzer.", root->GetToken()->GetPos());
+	return MAKE_EMPTY_MEMORY;
+}
+
+void Interpreter::QuickenLeaf(PTR_AST leaf)
+{
+	if (leaf->GetKind() != ASTKind::eToken)
+		return;
+	if (leaf->IsResolved())
+		leaf->Quicken(QuickForm::eSlot, CacheSlot(leaf));
+	else if (!leaf->GetLiteral().IsEmpty())
+		leaf->Quicken(QuickForm::eLiteral);
+	else
+		leaf->Quicken(QuickForm::eGeneric);
+}
+
+void Interpreter::QuickenBinary(PTR_BINARY_AST root)
+{
+	auto left = root->GetLeft();
+	auto right = root->GetRight();
+	if (left->GetQuickForm() == QuickForm::eUnquickened)
+		QuickenLeaf(left);
+	if (right->GetQuickForm() == QuickForm::eUnquickened)
+		QuickenLeaf(right);
+	// Operators nested in the operands are walked, only two leaves are read directly
+	bool leaves = (left->GetQuickForm() == QuickForm::eLiteral || left->GetQuickForm() == QuickForm::eSlot) && \
+		(right->GetQuickForm() == QuickForm::eLiteral || right->GetQuickForm() == QuickForm::eSlot);
+	if (!leaves || !root->GetKernel())
 	{
-		// e.g when "---+++1" as a input, the interpreter receives it as reversed by how the parser works.
-		// so '1' is the first input, and all '+' signs are ignored by purpose
-		// we then iterativly resolve all '-' sign to get the correct expression, which is '-1'
-		DEBUG_MSG("Before Unary handle---> " + result->ToString());
-		if (root->GetToken()->GetType() == MINUS)
+		root->Quicken(QuickForm::eGeneric);
+		return;
+	}
+
+	QuickForm form = QuickForm::eLeafKernel;
+	if (left->GetStaticType() == Value::Type::eInteger && right->GetStaticType() == Value::Type::eInteger)
+	{
+		switch (GetEnumNumOp(root->GetToken()->GetType()))
 		{
-			if (result->GetValue()->front() == '-')
-			{
-				std::string s(1, result->GetValue()->back());
-				result = MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(s), result->GetPos());
-			}
-			else
-			{
-				std::string s(*(result->GetValue()));
-				s.insert(0, "-");
-				result = MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(s), result->GetPos());
-			}
+		case ePLUS: form = QuickForm::eIntAdd; break;
+		case eMINUS: form = QuickForm::eIntSub; break;
+		case eMULTIPLY: form = QuickForm::eIntMul; break;
+		case eEQUAL: form = QuickForm::eIntEqual; break;
+		case eNOT_EQUAL: form = QuickForm::eIntNotEqual; break;
+		case eLESS: form = QuickForm::eIntLess; break;
+		case eLESS_EQUAL: form = QuickForm::eIntLessEqual; break;
+		case eGREATER: form = QuickForm::eIntGreater; break;
+		case eGREATER_EQUAL: form = QuickForm::eIntGreaterEqual; break;
+		default: break;
 		}
-		DEBUG_MSG("After Unary handle---> " + result->ToString());
 	}
-	else
+	else if (left->GetStaticType() == Value::Type::eFloat && right->GetStaticType() == Value::Type::eFloat)
 	{
-		ErrorSFD("ASTError(Interpreter): " + root->ToString() + " on " + result->ToString() + " is not valid.", root->GetToken()->GetPos());
+		switch (GetEnumNumOp(root->GetToken()->GetType()))
+		{
+		case ePLUS: form = QuickForm::eFloatAdd; break;
+		case eMINUS: form = QuickForm::eFloatSub; break;
+		case eMULTIPLY: form = QuickForm::eFloatMul; break;
+		case eDIVIDE: form = QuickForm::eFloatDivide; break;
+		default: break;
+		}
 	}
-	return result;
+	root->Quicken(form);
+}
+
+/*
+A specialized form calls the kernel of its operation directly, so that it is inlined instead of called through the
+pointer bound to the node
+*/
+#define QUICK_CASE(form, guard, op, type) \
+	case QuickForm::form: \
+		if (guard) \
+		{ \
+			result = Kernels::Binary<op, type, type>(left, right); \
+			return true; \
+		} \
+		break
+
+bool Interpreter::EvaluateQuickened(PTR_BINARY_AST root, Value& result)
+{
+	if (root->GetQuickForm() == QuickForm::eUnquickened)
+		QuickenBinary(root);
+	if (root->GetQuickForm() == QuickForm::eGeneric)
+		return false;
+
+	Value left = ReadQuickened(root->GetLeft());
+	Value right = ReadQuickened(root->GetRight());
+	bool integers = left.IsInteger() && right.IsInteger();
+	bool floats = left.IsFloat() && right.IsFloat();
+	switch (root->GetQuickForm())
+	{
+	QUICK_CASE(eIntAdd, integers, ePLUS, Value::Type::eInteger);
+	QUICK_CASE(eIntSub, integers, eMINUS, Value::Type::eInteger);
+	QUICK_CASE(eIntMul, integers, eMULTIPLY, Value::Type::eInteger);
+	QUICK_CASE(eIntEqual, integers, eEQUAL, Value::Type::eInteger);
+	QUICK_CASE(eIntNotEqual, integers, eNOT_EQUAL, Value::Type::eInteger);
+	QUICK_CASE(eIntLess, integers, eLESS, Value::Type::eInteger);
+	QUICK_CASE(eIntLessEqual, integers, eLESS_EQUAL, Value::Type::eInteger);
+	QUICK_CASE(eIntGreater, integers, eGREATER, Value::Type::eInteger);
+	QUICK_CASE(eIntGreaterEqual, integers, eGREATER_EQUAL, Value::Type::eInteger);
+	QUICK_CASE(eFloatAdd, floats, ePLUS, Value::Type::eFloat);
+	QUICK_CASE(eFloatSub, floats, eMINUS, Value::Type::eFloat);
+	QUICK_CASE(eFloatMul, floats, eMULTIPLY, Value::Type::eFloat);
+	QUICK_CASE(eFloatDivide, floats, eDIVIDE, Value::Type::eFloat);
+	case QuickForm::eLeafKernel:
+		if (left.GetTypeTag() == root->GetLeft()->GetStaticType() && right.GetTypeTag() == root->GetRight()->GetStaticType())
+		{
+			result = root->GetKernel()(left, right);
+			return true;
+		}
+		break;
+	default:
+		break;
+	}
+	// The operands do not have the types the node was specialized on, it runs generically from now on
+	DEBUG_MSG("Generic binary operation---> " + root->ToString());
+	root->Quicken(QuickForm::eGeneric);
+	result = ApplyBinary(root, left, right);
+	return true;
+}
+
+#undef QUICK_CASE
+
+bool Interpreter::NeedsRightOperand(PTR_LOGICAL_AST root, const Value& left)
+{
+	return !root->IsDecidedBy(left.GetBoolean());
+}
+
+Value Interpreter::ApplyLogical(PTR_LOGICAL_AST /*root*/, const Value& /*left*/, const Value& right)
+{
+	// The left operand did not decide, so the right one is the result
+	return right;
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitAssign(SHARE_ASSIGN_AST root)
+Value Interpreter::VisitAssign(PTR_ASSIGN_AST root)
 {
-	std::string name = root->GetVarName();
 	auto rhs = InterpretProgramHelper(root->GetRight());
-	auto scope = SymbolTableLookUp(name, rhs);
-	auto scope_ = SymbolTableCheck(name, rhs);
+	// The semantic analyzer has checked that the types match
+	if (root->GetQuickForm() != QuickForm::eSlot)
+		root->Quicken(QuickForm::eSlot, CacheSlot(root->GetLeft()));
+	m_frames.SlotAt(root->GetQuickSlot()) = rhs;
+	return MAKE_EMPTY_MEMORY;
+}
 
-	if (scope != scope_)
-	{
-		ErrorSFD("SymbolError(Interpreter): variable " + name + " has been found in multiple scoped symbol table.", rhs->GetPos());
+Value Interpreter::VisitFor(PTR_FOR_AST root)
+{
+	// Bounds are evaluated once and have been checked to be INTEGER by the semantic analyzer
+	int64_t start = InterpretProgramHelper(root->GetStart()).GetInteger();
+	int64_t end = InterpretProgramHelper(root->GetEnd()).GetInteger();
+	if (root->IsDownTo() ? start < end : start > end)
+		return MAKE_EMPTY_MEMORY;
+
+	// The induction variable is counted natively, its slot is only written for the body to read
+	auto var = root->GetVariable();
+	MemoryTableSlot(var);
+	unsigned int level = var->GetSlotLevel();
+	unsigned int slot = var->GetSlotIndex();
+	unsigned int pos = var->GetToken()->GetPos();
+	int64_t step = root->IsDownTo() ? -1 : 1;
+	auto body = root->GetBody();
+	for (int64_t i = start; ; i += step)
+	{
+		m_frames.Slot(level, slot) = Value::Integer(i, pos);
+		InterpretProgramHelper(body);
+		// Stop on the end bound itself, stepping past it could overflow
+		if (i == end)
+			break;
 	}
-	else
+	return MAKE_EMPTY_MEMORY;
+}
+
+Value Interpreter::VisitIf(PTR_IF_AST root)
+{
+	return InterpretProgramHelper(EvaluateCondition(root->GetCondition()) ? root->GetThen() : root->GetElse());
+}
+
+Value Interpreter::VisitWhile(PTR_WHILE_AST root)
+{
+	auto condition = root->GetCondition();
+	auto body = root->GetBody();
+	while (EvaluateCondition(condition))
+		InterpretProgramHelper(body);
+	return MAKE_EMPTY_MEMORY;
+}
+
+Value Interpreter::VisitRepeat(PTR_REPEAT_AST root)
+{
+	auto condition = root->GetCondition();
+	auto body = root->GetBody();
+	do
 	{
-		MemoryTableDefine(name, rhs, scope);
-	}
+		InterpretProgramHelper(body);
+	} while (!EvaluateCondition(condition));
 	return MAKE_EMPTY_MEMORY;
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitVairbale(SHARE_AST root)
+Value Interpreter::VisitVairbale(PTR_AST root)
 {
-	auto token = root->GetToken();
-	std::string type = token->GetType();
+	if (root->GetQuickForm() == QuickForm::eUnquickened)
+		QuickenLeaf(root);
+	if (root->GetQuickForm() == QuickForm::eSlot || root->GetQuickForm() == QuickForm::eLiteral)
+		return ReadQuickened(root);
 
-	// is variable
-	if (type == ID)
+	// is variable, resolved by the semantic analyzer
+	if (root->IsResolved())
 	{
-		DEBUG_RUN(PrintCurrentMemoryTable());
-		std::string name = *(token->GetValue());
-		auto scope = SymbolTableLookUp(name, token);
-		return MemoryTableLookUp(name, token, scope);
+		Value memory = MemoryTableSlot(root);
+		if (memory.IsEmpty())
+		{
+			ErrorSFD("SymbolError(Interpreter): variable " + std::string(root->GetToken()->GetValue()) + " used before reference.", root->GetToken()->GetPos());
+		}
+		// Report errors at the position the variable is read
+		memory.SetPos(root->GetToken()->GetPos());
+		return memory;
 	}
-	// is a type declaration
-	else if (type == TYPE)
+	// is static
+	else if (!root->GetLiteral().IsEmpty())
 	{
-		// TODO: change code below
-		return root->GetToken();
+		return root->GetLiteral();
 	}
-	// is static
-	else
+	// is a unresolved variable
+	else if (root->GetToken()->GetType() == ID)
 	{
-		return root->GetToken();
+		MemoryTableSlot(root);
 	}
+	// is a type declaration
+	return MAKE_EMPTY_MEMORY;
 }
 
-SHARE_TOKEN_STRING Interpreter::VisitEmpty(SHARE_EMPTY_AST root)
+Value Interpreter::VisitEmpty(PTR_EMPTY_AST /*root*/)
 {
-	return MAKE_SHARE_TOKEN(EMPTY, MAKE_SHARE_STRING("\0"), 0);
+	return MAKE_EMPTY_MEMORY;
 }
 
 /*
@@ -315,51 +478,65 @@ Functionality: interpreting the program (statments, assignment, operators, varia
 Return: InterpretProgram
 */
 
-SHARE_TOKEN_STRING SemanticAnalyzer::InterpretProgramHelper(SHARE_AST root)
+Value SemanticAnalyzer::InterpretProgramHelper(PTR_AST root)
 {
 	if (!root)
 		Error("ASTError(Interpreter): root of InterpretProgramHelper is null.");
 
-	// Condition: is a compound statment
-	if (SHARE_COMPOUND_AST root_0 = dynamic_pointer_cast<Compound_AST>(root))
+	switch (root->GetKind())
 	{
-		return VisitCompound(root_0);
-	}
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+		return VisitCompound(static_cast<PTR_COMPOUND_AST>(root));
 	// Condition: is a binary operation
-	else if (SHARE_BINARY_AST root_1 = dynamic_pointer_cast<BinaryOp_AST>(root))
-	{
-		return VisitBinary(root_1);
-	}
+	case ASTKind::eBinary:
+		return VisitBinary(static_cast<PTR_BINARY_AST>(root));
+	// Condition: is a unary operation
+	case ASTKind::eUnary:
+		return VisitUnary(static_cast<PTR_UNARY_AST>(root));
+	// Condition: is a short-circuit AND/OR
+	case ASTKind::eLogical:
+		return VisitLogical(static_cast<PTR_LOGICAL_AST>(root));
 	// Condition: is a empty statement
-	else if (SHARE_EMPTY_AST root_3 = dynamic_pointer_cast<Empty_AST>(root))
-	{
-		return VisitEmpty(root_3);
-	}
+	case ASTKind::eEmpty:
+		return VisitEmpty(static_cast<PTR_EMPTY_AST>(root));
 	// Condition: is a assign statement
-	else if (SHARE_ASSIGN_AST root_4 = dynamic_pointer_cast<Assign_AST>(root))
-	{
-		return VisitAssign(root_4);
-	}
+	case ASTKind::eAssign:
+		return VisitAssign(static_cast<PTR_ASSIGN_AST>(root));
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+		return VisitFor(static_cast<PTR_FOR_AST>(root));
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+		return VisitIf(static_cast<PTR_IF_AST>(root));
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+		return VisitWhile(static_cast<PTR_WHILE_AST>(root));
+	// Condition: is a post-tested loop
+	case ASTKind::eRepeat:
+		return VisitRepeat(static_cast<PTR_REPEAT_AST>(root));
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		return VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
 	// Condition: is a variable/static
-	else
-	{
+	default:
 		return VisitVairbale(root);
 	}
 }
 
-SHARE_TOKEN_STRING SemanticAnalyzer::VisitBlock(SHARE_BLOCk_AST root)
+Value SemanticAnalyzer::VisitBlock(PTR_BLOCK_AST root)
 {
 	// Process declarations.
-	if (SHARE_DECLARATION_AST declaration = dynamic_pointer_cast<Declaration_AST>(root->GetDeclaration()))
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(root->GetDeclaration()))
 	{
-		for (SHARE_AST& decal : declaration->GetAllChildren())
+		for (PTR_AST decal : declaration->GetAllChildren())
 		{
 			// Condition: is a variable declaration
-			if (SHARE_DECLCONTAINER_AST _declConatiner = dynamic_pointer_cast<DeclContainer_AST>(decal))
+			if (PTR_DECLCONTAINER_AST _declConatiner = ast_cast<DeclContainer_AST>(decal))
 			{
-				for (SHARE_AST& varDecal : _declConatiner->GetAllChildren())
+				for (PTR_AST varDecal : _declConatiner->GetAllChildren())
 				{
-					if (SHARE_VARDECL_AST _varDecal = dynamic_pointer_cast<VarDecl_AST>(varDecal))
+					if (PTR_VARDECL_AST _varDecal = ast_cast<VarDecl_AST>(varDecal))
 					{
 						SymbolTableDefine(_varDecal);
 					}
@@ -371,7 +548,7 @@ SHARE_TOKEN_STRING SemanticAnalyzer::VisitBlock(SHARE_BLOCk_AST root)
 				DEBUG_RUN(PrintCurrentSymbolTable());
 			}
 			// Condition: is a procedure start
-			else if (SHARE_PROCEDURE_AST _procedure = dynamic_pointer_cast<Procedure_AST>(decal))
+			else if (PTR_PROCEDURE_AST _procedure = ast_cast<Procedure_AST>(decal))
 			{
 				ProcedureTableDefine(_procedure);
 				DEBUG_RUN(PrintCurrentProcedureTable());
@@ -389,27 +566,39 @@ SHARE_TOKEN_STRING SemanticAnalyzer::VisitBlock(SHARE_BLOCk_AST root)
 	}
 	// Process the rest of the program.
 	auto result = InterpretProgramHelper(root->GetCompound());
+
+	// Record the frame layout of this scope so that execution never builds tables
+	auto layout = std::make_shared<FrameLayout>();
+	layout->name = m_pSymbolTable->GetName();
+	layout->level = m_pSymbolTable->GetLevel();
+	for (auto& symbol : m_pSymbolTable->GetSymbolsBySlot())
+	{
+		layout->names.push_back(symbol.GetName());
+		layout->types.push_back(Value::TypeFromString(symbol.GetType()));
+	}
+	root->SetFrameLayout(layout);
+
 	PopBackTable();
 	return result;
 }
 
-SHARE_TOKEN_STRING SemanticAnalyzer::VisitProcedure(SHARE_PROCEDURE_AST root, SHARE_COMPOUND_AST params)
+Value SemanticAnalyzer::VisitProcedure(PTR_PROCEDURE_AST root, PTR_COMPOUND_AST /*params*/)
 {
 	DEBUG_MSG("Running procedure---> " + root->GetName());
 	AddTable(root->GetName());
 
 	// Process parameters
-	if (SHARE_DECLARATION_AST declaration = dynamic_pointer_cast<Declaration_AST>(root->GetParams()))
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(root->GetParams()))
 	{
 		// Define parameter
-		for (SHARE_AST& decal : declaration->GetAllChildren())
+		for (PTR_AST decal : declaration->GetAllChildren())
 		{
 			// Condition: is a variable declaration
-			if (SHARE_DECLCONTAINER_AST _declConatiner = dynamic_pointer_cast<DeclContainer_AST>(decal))
+			if (PTR_DECLCONTAINER_AST _declConatiner = ast_cast<DeclContainer_AST>(decal))
 			{
-				for (SHARE_AST& varDecal : _declConatiner->GetAllChildren())
+				for (PTR_AST varDecal : _declConatiner->GetAllChildren())
 				{
-					if (SHARE_VARDECL_AST _varDecal = dynamic_pointer_cast<VarDecl_AST>(varDecal))
+					if (PTR_VARDECL_AST _varDecal = ast_cast<VarDecl_AST>(varDecal))
 					{
 						SymbolTableDefine(_varDecal);
 					}
@@ -434,37 +623,220 @@ SHARE_TOKEN_STRING SemanticAnalyzer::VisitProcedure(SHARE_PROCEDURE_AST root, SH
 	return InterpretProgramEntryHelper(root->GetBlock());
 }
 
-SHARE_TOKEN_STRING SemanticAnalyzer::VisitBinary(SHARE_BINARY_AST root)
+Value SemanticAnalyzer::VisitProgram(PTR_PROGRAM_AST root)
 {
-	SHARE_TOKEN_STRING left = InterpretProgramHelper(root->GetLeft());
-	SHARE_TOKEN_STRING right = InterpretProgramHelper(root->GetRight());
-	return MAKE_SHARE_TOKEN(EMPTY, MAKE_SHARE_STRING("\0"), 0);
+	AddTable(root->GetName(), 1);
+	return InterpretProgramEntryHelper(root->GetBlock());
 }
 
-SHARE_TOKEN_STRING SemanticAnalyzer::VisitAssign(SHARE_ASSIGN_AST root)
+Value SemanticAnalyzer::VisitProcedureCall(PTR_PROCEDURE_AST root)
+{
+	auto procedure = ProcedureTableLookUp(root->GetName(), root->GetToken()->GetPos());
+	root->SetDeclaration(procedure);
+
+	// Every call is checked against its declaration, so that all engines reject a wrong call before running,
+	// even one that would never run
+	bool declared = ast_cast<Declaration_AST>(procedure->GetParams()) != nullptr;
+	bool passed = ast_cast<Compound_AST>(root->GetParams()) != nullptr;
+	if (declared && !passed)
+	{
+		ErrorSFD("SyntaxError(Interpreter): Procedure parameters are declared without reference.", root->GetToken()->GetPos());
+	}
+	else if (!declared && passed)
+	{
+		ErrorSFD("SyntaxError(Interpreter): Too many arguments for procedure.", root->GetToken()->GetPos());
+	}
+
+	// Arguments are assigned inside the callee scope, where only the parameters are declared yet
+	AddTable(root->GetName());
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(procedure->GetParams()))
+	{
+		for (PTR_AST decal : declaration->GetAllChildren())
+		{
+			if (PTR_DECLCONTAINER_AST _declConatiner = ast_cast<DeclContainer_AST>(decal))
+			{
+				for (PTR_AST varDecal : _declConatiner->GetAllChildren())
+				{
+					if (PTR_VARDECL_AST _varDecal = ast_cast<VarDecl_AST>(varDecal))
+					{
+						SymbolTableDefine(_varDecal);
+					}
+				}
+			}
+		}
+	}
+	if (PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams()))
+	{
+		for (auto& child : params->GetAllChildren())
+		{
+			InterpretProgramHelper(child);
+		}
+	}
+	PopBackTable();
+
+	// A call used as a value is empty, errors about it point at the call
+	return Value::OfType(Value::Type::eEmpty, root->GetToken()->GetPos());
+}
+
+Value SemanticAnalyzer::ApplyBinary(PTR_BINARY_AST root, const Value& left, const Value& right)
+{
+	// Operands are placeholders of their static type, see Value::OfType
+	auto op = root->GetToken();
+	auto code = GetEnumNumOp(op->GetType());
+	if (!Kernels::IsBinarySupported(code, left.GetTypeTag(), right.GetTypeTag()))
+	{
+		ErrorSFD("SyntaxError(Interpreter): " + op->ToString() + " on " + left.GetType() + " and " + right.GetType() + " is not valid.", op->GetPos());
+	}
+	bool isInt = left.IsInteger() && right.IsInteger();
+	if (op->GetType() == INT_DIV && !isInt)
+	{
+		ErrorSFD("SyntaxError(Interpreter): integer division applied to non-integer type.", op->GetPos());
+	}
+	if (IsRelationalOp(code))
+		root->SetStaticType(Value::Type::eBoolean);
+	else
+		root->SetStaticType(isInt ? Value::Type::eInteger : Value::Type::eFloat);
+	root->BindKernel();
+	return Value::OfType(root->GetStaticType(), left.GetPos());
+}
+
+Value SemanticAnalyzer::ApplyUnary(PTR_UNARY_AST root, const Value& operand)
+{
+	if (!Kernels::IsUnarySupported(GetEnumNumOp(root->GetToken()->GetType()), operand.GetTypeTag()))
+	{
+		ErrorSFD("ASTError(Interpreter): " + root->ToString() + " on " + operand.ToString() + " is not valid.", root->GetToken()->GetPos());
+	}
+	root->SetStaticType(operand.GetTypeTag());
+	root->BindKernel();
+	return operand;
+}
+
+bool SemanticAnalyzer::NeedsRightOperand(PTR_LOGICAL_AST /*root*/, const Value& /*left*/)
+{
+	// Both operands are checked whatever the left one would evaluate to
+	return true;
+}
+
+Value SemanticAnalyzer::ApplyLogical(PTR_LOGICAL_AST root, const Value& left, const Value& right)
+{
+	auto op = root->GetToken();
+	if (!left.IsBoolean() || !right.IsBoolean())
+	{
+		ErrorSFD("SyntaxError(Interpreter): " + op->ToString() + " on " + left.GetType() + " and " + right.GetType() + " is not valid.", op->GetPos());
+	}
+	root->SetStaticType(Value::Type::eBoolean);
+	return Value::OfType(Value::Type::eBoolean, left.GetPos());
+}
+
+Value SemanticAnalyzer::VisitAssign(PTR_ASSIGN_AST root)
 {
-	std::string name = root->GetVarName();
 	auto rhs = InterpretProgramHelper(root->GetRight());
-	return MAKE_SHARE_TOKEN(EMPTY, MAKE_SHARE_STRING("\0"), 0);
+	auto var = VisitVairbale(root->GetLeft());
+
+	if (IsLoopVariable(root->GetLeft()))
+	{
+		ErrorSFD("SymbolError(Interpreter): FOR control variable " + root->GetVarName() + " can not be assigned inside its loop.", \
+			root->GetLeft()->GetToken()->GetPos());
+	}
+	// Reject the assignment before execution, at the position the engines would report the value
+	if (rhs.GetTypeTag() != var.GetTypeTag())
+	{
+		ErrorSFD("SymbolError(Interpreter): variable " + root->GetVarName() + " with type " + var.GetType() + " does not match " + \
+			DescribeExpression(root->GetRight()) + " with type " + rhs.GetType() + " .", rhs.GetPos());
+	}
+	return MAKE_EMPTY_MEMORY;
 }
 
-SHARE_TOKEN_STRING SemanticAnalyzer::VisitVairbale(SHARE_AST root)
+Value SemanticAnalyzer::VisitFor(PTR_FOR_AST root)
+{
+	auto var = root->GetVariable();
+	std::string name = std::string(var->GetToken()->GetValue());
+	auto type = VisitVairbale(var);
+	if (!type.IsInteger())
+	{
+		ErrorSFD("SymbolError(Interpreter): FOR control variable " + name + " with type " + type.GetType() + " is not INTEGER.", var->GetToken()->GetPos());
+	}
+	if (IsLoopVariable(var))
+	{
+		ErrorSFD("SymbolError(Interpreter): FOR control variable " + name + " can not be assigned inside its loop.", var->GetToken()->GetPos());
+	}
+	for (PTR_AST bound : { root->GetStart(), root->GetEnd() })
+	{
+		auto value = InterpretProgramHelper(bound);
+		if (!value.IsInteger())
+		{
+			ErrorSFD("SymbolError(Interpreter): FOR bound " + DescribeExpression(bound) + " with type " + value.GetType() + " is not INTEGER.", \
+				value.IsEmpty() ? root->GetToken()->GetPos() : value.GetPos());
+		}
+	}
+
+	m_loopVariables.push_back(std::make_pair(var->GetSlotLevel(), var->GetSlotIndex()));
+	InterpretProgramHelper(root->GetBody());
+	m_loopVariables.pop_back();
+	return MAKE_EMPTY_MEMORY;
+}
+
+Value SemanticAnalyzer::VisitIf(PTR_IF_AST root)
+{
+	CheckCondition(root->GetCondition(), root);
+	InterpretProgramHelper(root->GetThen());
+	InterpretProgramHelper(root->GetElse());
+	return MAKE_EMPTY_MEMORY;
+}
+
+Value SemanticAnalyzer::VisitWhile(PTR_WHILE_AST root)
+{
+	CheckCondition(root->GetCondition(), root);
+	InterpretProgramHelper(root->GetBody());
+	return MAKE_EMPTY_MEMORY;
+}
+
+Value SemanticAnalyzer::VisitRepeat(PTR_REPEAT_AST root)
+{
+	InterpretProgramHelper(root->GetBody());
+	CheckCondition(root->GetCondition(), root);
+	return MAKE_EMPTY_MEMORY;
+}
+
+void SemanticAnalyzer::CheckCondition(PTR_AST condition, PTR_AST statement)
+{
+	auto value = InterpretProgramHelper(condition);
+	if (!value.IsBoolean())
+	{
+		ErrorSFD("SymbolError(Interpreter): condition " + DescribeExpression(condition) + " with type " + value.GetType() + " is not BOOLEAN.", \
+			value.IsEmpty() ? statement->GetToken()->GetPos() : value.GetPos());
+	}
+}
+
+std::string SemanticAnalyzer::DescribeExpression(PTR_AST root)
+{
+	if (root->GetKind() == ASTKind::eToken && !root->GetLiteral().IsEmpty())
+		return root->GetLiteral().GetValueString();
+	else if (root->GetKind() == ASTKind::eToken || root->GetKind() == ASTKind::eProcedure)
+		return std::string(root->GetToken()->GetValue());
+	else
+		return "expression";
+}
+
+Value SemanticAnalyzer::VisitVairbale(PTR_AST root)
 {
 	auto token = root->GetToken();
-	std::string type = token->GetType();
 
-	// is variable
-	if (type == ID)
+	// is variable, resolve it to its (scope level, slot index) once for all executions
+	if (token->GetType() == ID)
 	{
-		std::string name = *(token->GetValue());
-		auto scope = SymbolTableLookUp(name, token);
+		std::string name = std::string(token->GetValue());
+		auto scope = SymbolTableLookUp(name, token->GetPos());
+		auto symbol = m_symoblTableVec[scope - 1].lookup(name);
+		root->SetSlot(scope, symbol.GetSlot());
+		root->SetStaticType(Value::TypeFromString(symbol.GetType()));
+		return Value::OfType(root->GetStaticType(), token->GetPos());
 	}
-	// is a type declaration
-	else if (type == TYPE)
+	// is static
+	else if (!root->GetLiteral().IsEmpty())
 	{
-		// TODO: change code below
-		return root->GetToken();
+		return root->GetLiteral();
 	}
 
-	return MAKE_SHARE_TOKEN(EMPTY, MAKE_SHARE_STRING("\0"), 0);
+	return MAKE_EMPTY_MEMORY;
 }
@@ -11,6 +11,7 @@ AST Parser Interpreter
 #include <map>
 
 #include "Symbol.hpp"
+#include "Frame.hpp"
 #include "Parser.hpp"
 #include "Operator.hpp"
 
@@ -18,12 +19,13 @@ AST Parser Interpreter
 class NodeVisitor
 {
 public:
-	NodeVisitor() : m_sfd(nullptr) {};
+	NodeVisitor() : m_sfd(nullptr), m_maxDepth(MAX_EXPRESSION_DEPTH) {};
 	virtual ~NodeVisitor() {};
 
 	virtual void Reset() noexcept
 	{
 		m_sfd = nullptr;
+		m_work.clear();
 	}
 
 	void SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
@@ -31,6 +33,12 @@ public:
 		m_sfd = sfd;
 	}
 
+	// Limit of pending nodes while walking one expression
+	void SetMaxDepth(unsigned int maxDepth) noexcept
+	{
+		m_maxDepth = maxDepth;
+	}
+
 protected:
 	/*
 	Funtionality: helper function to throw exception with a specific message
@@ -48,8 +56,123 @@ protected:
 		throw MyExceptions::MsgExecption(msg, m_sfd, pos);
 	}
 
+	/*
+	Funtionality: post-order walk of the binary/unary/logical operators of an expression with an explicit work stack,
+	left operands before right ones. Any other node is handed to visitLeaf, operators to visitBinary/visitUnary
+	once their operands have been visited. A logical node is handed to visitLogicalLeft once its left operand
+	has been visited, which returns whether the right operand is visited as well, and then to visitLogical.
+	The work stack is kept between walks (and shared by the walks nested in a leaf), so a walk does not allocate.
+	*/
+	template <typename Leaf, typename Binary, typename Unary, typename LogicalLeft, typename Logical>
+	void WalkExpression(PTR_AST root, Leaf visitLeaf, Binary visitBinary, Unary visitUnary, LogicalLeft visitLogicalLeft, Logical visitLogical)
+	{
+		WalkExpression(root, visitLeaf, visitBinary, visitUnary, visitLogicalLeft, visitLogical, [](PTR_BINARY_AST) { return false; });
+	}
+
+	/*
+	Funtionality: same walk, a binary node is first handed to visitQuickened which returns whether it evaluated
+	the node on its own, in which case its operands are not walked
+	*/
+	template <typename Leaf, typename Binary, typename Unary, typename LogicalLeft, typename Logical, typename Quickened>
+	void WalkExpression(PTR_AST root, Leaf visitLeaf, Binary visitBinary, Unary visitUnary, LogicalLeft visitLogicalLeft, Logical visitLogical,
+		Quickened visitQuickened)
+	{
+		// Most conditions, bounds and right-hand sides are a single leaf
+		if (root->GetKind() != ASTKind::eBinary && root->GetKind() != ASTKind::eUnary && root->GetKind() != ASTKind::eLogical)
+		{
+			visitLeaf(root);
+			return;
+		}
+
+		size_t base = m_work.size();
+		m_work.push_back(WalkItem{ root, eExpand });
+		while (m_work.size() > base)
+		{
+			WalkItem item = m_work.back();
+			m_work.pop_back();
+			PTR_AST node = item.node;
+			switch (node->GetKind())
+			{
+			case ASTKind::eBinary:
+			{
+				if (item.stage != eExpand)
+				{
+					visitBinary(static_cast<PTR_BINARY_AST>(node));
+					break;
+				}
+				CheckWalkDepth(node, base, 3);
+				auto binary = static_cast<PTR_BINARY_AST>(node);
+				if (visitQuickened(binary))
+					break;
+				m_work.push_back(WalkItem{ node, eApply });
+				m_work.push_back(WalkItem{ binary->GetRight(), eExpand });
+				m_work.push_back(WalkItem{ binary->GetLeft(), eExpand });
+				break;
+			}
+			case ASTKind::eUnary:
+				if (item.stage != eExpand)
+				{
+					visitUnary(static_cast<PTR_UNARY_AST>(node));
+					break;
+				}
+				CheckWalkDepth(node, base, 2);
+				m_work.push_back(WalkItem{ node, eApply });
+				m_work.push_back(WalkItem{ static_cast<PTR_UNARY_AST>(node)->GetExpr(), eExpand });
+				break;
+			case ASTKind::eLogical:
+			{
+				auto logical = static_cast<PTR_LOGICAL_AST>(node);
+				if (item.stage == eExpand)
+				{
+					CheckWalkDepth(node, base, 2);
+					m_work.push_back(WalkItem{ node, eLeftDone });
+					m_work.push_back(WalkItem{ logical->GetLeft(), eExpand });
+				}
+				else if (item.stage == eLeftDone)
+				{
+					if (visitLogicalLeft(logical))
+					{
+						m_work.push_back(WalkItem{ node, eApply });
+						m_work.push_back(WalkItem{ logical->GetRight(), eExpand });
+					}
+				}
+				else
+				{
+					visitLogical(logical);
+				}
+				break;
+			}
+			default:
+				visitLeaf(node);
+			}
+		}
+	}
+
+private:
+	enum WalkStage : unsigned char
+	{
+		eExpand,		// operands not pushed yet
+		eLeftDone,		// left operand of a logical node visited
+		eApply			// every operand visited
+	};
+
+	struct WalkItem
+	{
+		PTR_AST node;
+		WalkStage stage;
+	};
+
+	inline void CheckWalkDepth(PTR_AST node, size_t base, size_t pushed)
+	{
+		if (m_work.size() - base + pushed > m_maxDepth)
+			ErrorSFD("ASTError: expression is nested deeper than the limit of " + MyTemplates::Str(m_maxDepth) + ".", node->GetToken()->GetPos());
+	}
+
+	std::vector<WalkItem> m_work;
+
 protected:
 	MyDebug::SrouceFileDebugger* m_sfd;
+	unsigned int m_maxDepth;
 };
 
 
@@ -59,23 +182,24 @@ public:
 	Interpreter()
 		:
 		m_pSymbolTable(nullptr),
-		m_pMemoryTable(nullptr),
 		m_pProcedureTable(nullptr)
 	{}
 	virtual ~Interpreter() {};
 	
 	virtual void Reset() noexcept override
 	{
-		for (auto& table : m_memoryTableVec)
-			table.Reset();
 		for (auto& table : m_symoblTableVec)
 			table.Reset();
-		m_memoryTableVec.clear();
+		for (auto& table : m_procedureTableVec)
+			table.Reset();
 		m_symoblTableVec.clear();
+		m_procedureTableVec.clear();
+		m_frames.Reset();
 		m_scopeCounter = 0;
-		m_pMemoryTable = nullptr;
 		m_pSymbolTable = nullptr;
-		m_sfd = nullptr;	
+		m_pProcedureTable = nullptr;
+		m_values.clear();
+		NodeVisitor::Reset();
 	}
 
 	void PrintCurrentSymbolTable() noexcept
@@ -83,11 +207,6 @@ public:
 		m_pSymbolTable->PrintTable();
 	}
 
-	void PrintCurrentMemoryTable() noexcept
-	{
-		m_pMemoryTable->PrintTable();
-	}
-
 	void PrintCurrentProcedureTable() noexcept
 	{
 		m_pProcedureTable->PrintTable();
@@ -95,14 +214,12 @@ public:
 
 	void PrintAllSymbolTable() noexcept
 	{
-		for (auto& table : m_symoblTableVec)
-			table.PrintTable();
+		m_frames.PrintAllSymbolTable();
 	}
 
 	void PrintAllMemoryTable() noexcept
 	{
-		for (auto& table : m_memoryTableVec)
-			table.PrintTable();
+		m_frames.PrintAllMemoryTable();
 	}
 
 	void PrintAllProcedureTable() noexcept
@@ -116,17 +233,12 @@ public:
 	Functionality: interpreting the AST
 	Return: InterpretProgram
 	*/
-	virtual SHARE_TOKEN_STRING InterpretProgram(SHARE_AST root)
+	virtual Value InterpretProgram(PTR_AST root)
 	{
 		return InterpretProgramEntryHelper(root);
 	}
 
 protected:
-	inline void UpdateCurrentMemoryTable(ScopedMemoryTable* pMemoryTable)
-	{
-		m_pMemoryTable = pMemoryTable;
-	}
-
 	inline void UpdateCurrentSymbolTable(ScopedSymbolTable* pSymbolTable)
 	{
 		m_pSymbolTable = pSymbolTable;
@@ -137,21 +249,6 @@ protected:
 		m_pProcedureTable = pProcedureTable;
 	}
 
-	void AddMemoryTable(std::string name, unsigned int level)
-	{
-		if (m_memoryTableVec.empty())
-		{
-			if (level != 1)
-				Error("MemoryError(Interpreter): adding a non-global(level!=1) table to a empty table vector.");
-		}
-		else if (m_memoryTableVec.back().GetLevel() != (level-1))
-		{
-			Error("MemoryError(Interpreter): adding a "+ MyTemplates::Str(level) +" table to a " + MyTemplates::Str(m_memoryTableVec.back().GetLevel()) + " table.");
-		}
-		m_memoryTableVec.push_back(ScopedMemoryTable(name, level));
-		UpdateCurrentMemoryTable(&(m_memoryTableVec.back()));
-	}
-
 	void AddSymbolTable(std::string name, unsigned int level)
 	{
 		if (m_symoblTableVec.empty())
@@ -188,31 +285,28 @@ protected:
 		if (level != 0 && m_scopeCounter != level)
 			Error("TableError(Interpreter): try to add scope level " + MyTemplates::Str(level) + \
 				" but the last level is " + MyTemplates::Str(m_scopeCounter) + " .");
-		AddMemoryTable(name, m_scopeCounter);
 		AddSymbolTable(name, m_scopeCounter);
 		AddProcedureTable(name, m_scopeCounter);
 	}
 
 	void PopBackTable()
 	{
-		if ((m_memoryTableVec.size() != m_symoblTableVec.size()) \
-			|| (m_memoryTableVec.back().GetLevel() != m_symoblTableVec.back().GetLevel()))
+		if ((m_symoblTableVec.size() != m_procedureTableVec.size()) \
+			|| (m_symoblTableVec.back().GetLevel() != m_procedureTableVec.back().GetLevel()))
 		{
-			Error("TableError(Interpreter): memory table vector and symbol table vector has different length.");
+			Error("TableError(Interpreter): symbol table vector and procedure table vector has different length.");
 		}
 		else
 		{
-			if (m_memoryTableVec.back().GetLevel() != m_scopeCounter)
+			if (m_symoblTableVec.back().GetLevel() != m_scopeCounter)
 				Error("TableError(Interpreter): try to pop scope level " + MyTemplates::Str(m_scopeCounter) + \
-					" but the last level is " + MyTemplates::Str(m_memoryTableVec.back().GetLevel()) +" .");
+					" but the last level is " + MyTemplates::Str(m_symoblTableVec.back().GetLevel()) +" .");
 
 			if (m_scopeCounter > 1)
 			{
-				m_memoryTableVec.pop_back();
 				m_symoblTableVec.pop_back();
 				m_procedureTableVec.pop_back();
 				m_scopeCounter--;
-				UpdateCurrentMemoryTable(&(m_memoryTableVec.back()));
 				UpdateCurrentSymbolTable(&(m_symoblTableVec.back()));
 				UpdateCurrentProcedureTable(&(m_procedureTableVec.back()));
 			}
@@ -220,7 +314,7 @@ protected:
 	}
 
 	// Define a variable in symbol table
-	void SymbolTableDefine(SHARE_VARDECL_AST varDecal)
+	void SymbolTableDefine(PTR_VARDECL_AST varDecal)
 	{
 		std::string type = varDecal->GetTypeString();
 		std::string name = varDecal->GetVarString();
@@ -229,7 +323,7 @@ protected:
 	}
 
 	// Check existence of a variable
-	unsigned int SymbolTableLookUp(std::string name, MEMORY var)
+	unsigned int SymbolTableLookUp(std::string name, unsigned int pos)
 	{
 		for (unsigned int i = m_scopeCounter; i >= 1; i--)
 		{
@@ -238,83 +332,54 @@ protected:
 			else
 				return i;
 		}
-		ErrorSFD("SymbolError(Interpreter): variable " + name + " is an undeclared variable.", var->GetPos());
+		ErrorSFD("SymbolError(Interpreter): variable " + name + " is an undeclared variable.", pos);
 		return 0;
 	}
 
-	// Check existence of a variable and it has a matched type
-	unsigned int SymbolTableCheck(std::string name, MEMORY targetVar)
+	// Push the activation record of the scope a block opens
+	void PushFrame(PTR_BLOCK_AST block)
 	{
-		for (unsigned int i = m_scopeCounter; i >= 1; i--)
-		{
-			if (!m_symoblTableVec[i-1].check(name, targetVar))
-				continue;
-			else
-				return i;
-		}
-		ErrorSFD("SymbolError(Interpreter): variable " + name + " with type " + m_pSymbolTable->lookup(name).GetType() + " does not match " + *(targetVar->GetValue()) + " with type " + targetVar->GetType() + " .", targetVar->GetPos());
-		return 0;
+		if (!block->GetFrameLayout())
+			Error("ASTError(Interpreter): block has no frame layout, run the semantic analyzer first.");
+		m_frames.Push(block->GetFrameLayout().get());
 	}
 
-	// Define a variable in memory
-	void MemoryTableDefine(std::string name, MEMORY var, unsigned int scopeCounter = 0)
+	/*
+	Functionality: cache the slot a resolved variable node refers to, as an index in the slots shared by every frame.
+	A procedure is only visible to the block that declares it, so the frames below the one of a variable are always
+	those of the same enclosing scopes and the index never changes.
+	*/
+	unsigned int CacheSlot(PTR_AST var)
 	{
-		if (scopeCounter == 0)
-		{
-			m_pMemoryTable->define(name, var);
-		}
-		else
-		{
-			m_memoryTableVec[scopeCounter - 1].define(name, var);
-		}
+		MemoryTableSlot(var);
+		return m_frames.GetSlotIndex(var->GetSlotLevel(), var->GetSlotIndex());
 	}
 
-	// Return the memory a variable has assigned to
-	MEMORY MemoryTableLookUp(std::string name, MEMORY var, unsigned int scopeCounter=0)
+	// Return the memory slot a resolved variable node refers to
+	MEMORY& MemoryTableSlot(PTR_AST var)
 	{
-		// The scope of this varible is not specified, treated as a variable in the current scope
-		// Thus, it is SymbolTableLookUp's responsibility to provide the correct scope for this variable to look up in the memory table.
-		if (scopeCounter == 0)
-		{
-			auto memory = m_pMemoryTable->lookup(name);
-			if (!m_pMemoryTable->valid(memory))
-			{
-				ErrorSFD("SymbolError(Interpreter): variable " + name + " used before reference.", var->GetPos());
-				return MAKE_EMPTY_MEMORY;
-			}
-			else
-				return memory;
-		}
-		else
-		{
-			auto memory = m_memoryTableVec[scopeCounter-1].lookup(name);
-			if (!m_memoryTableVec[scopeCounter - 1].valid(memory))
-			{
-				ErrorSFD("SymbolError(Interpreter): variable " + name + " used before reference.", var->GetPos());
-				return MAKE_EMPTY_MEMORY;
-			}
-			else
-				return memory;
-		}
+		if (!var->IsResolved())
+			ErrorSFD("ASTError(Interpreter): variable " + std::string(var->GetToken()->GetValue()) + " has not been resolved by the semantic analyzer.", var->GetToken()->GetPos());
+		return m_frames.Slot(var->GetSlotLevel(), var->GetSlotIndex());
 	}
 
 	// Define a variable in procedure table
-	void ProcedureTableDefine(SHARE_PROCEDURE_AST var)
+	void ProcedureTableDefine(PTR_PROCEDURE_AST var)
 	{
 		m_pProcedureTable->define(var->GetName(), var);
 	}
 
 	// Return the procedure AST a procedure name has assigned to
-	SHARE_PROCEDURE_AST ProcedureTableLookUp(std::string name, MEMORY var)
+	PTR_PROCEDURE_AST ProcedureTableLookUp(std::string name, unsigned int pos)
 	{
 		auto memory = m_pProcedureTable->lookup(name);
 		if (!m_pProcedureTable->valid(memory))
 		{
-			ErrorSFD("SymbolError(Interpreter): procedure " + name + " used before reference.", var->GetPos());
+			ErrorSFD("SymbolError(Interpreter): procedure " + name + " used before reference.", pos);
 			return nullptr;
 		}
 		else
-			return static_pointer_cast<Procedure_AST>(memory);
+			return memory;
 	}
 
 protected:
@@ -323,48 +388,109 @@ protected:
 	Functionality: interpreting the entry (PROGRAM, block, PROCEDURE, Declaration)
 	Return: InterpretProgram
 	*/
-	virtual SHARE_TOKEN_STRING InterpretProgramEntryHelper(SHARE_AST root);
+	virtual Value InterpretProgramEntryHelper(PTR_AST root);
 
 	/*
 	Functionality: interpreting the program (statments, assignment, operators, variables)
 	Return: InterpretProgram
 	*/
-	virtual SHARE_TOKEN_STRING InterpretProgramHelper(SHARE_AST root);
+	virtual Value InterpretProgramHelper(PTR_AST root);
 
 protected:
-	virtual SHARE_TOKEN_STRING VisitProgram(SHARE_PROGRAM_AST root);
+	virtual Value VisitProgram(PTR_PROGRAM_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitProcedureCall(SHARE_PROCEDURE_AST root);
+	virtual Value VisitProcedureCall(PTR_PROCEDURE_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitProcedure(SHARE_PROCEDURE_AST root, SHARE_COMPOUND_AST params = nullptr);
+	virtual Value VisitProcedure(PTR_PROCEDURE_AST root, PTR_COMPOUND_AST params = nullptr);
 
-	virtual SHARE_TOKEN_STRING VisitBlock(SHARE_BLOCk_AST root);
+	virtual Value VisitBlock(PTR_BLOCK_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitCompound(SHARE_COMPOUND_AST root);
+	virtual Value VisitCompound(PTR_COMPOUND_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitBinary(SHARE_BINARY_AST root);
+	virtual Value VisitBinary(PTR_BINARY_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitUnary(SHARE_UNARY_AST root);
+	virtual Value VisitUnary(PTR_UNARY_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitAssign(SHARE_ASSIGN_AST root);
+	virtual Value VisitLogical(PTR_LOGICAL_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitVairbale(SHARE_AST root);
+	virtual Value VisitAssign(PTR_ASSIGN_AST root);
 
-	virtual SHARE_TOKEN_STRING VisitEmpty(SHARE_EMPTY_AST root);
+	virtual Value VisitFor(PTR_FOR_AST root);
+
+	virtual Value VisitIf(PTR_IF_AST root);
+
+	virtual Value VisitWhile(PTR_WHILE_AST root);
+
+	virtual Value VisitRepeat(PTR_REPEAT_AST root);
+
+	virtual Value VisitVairbale(PTR_AST root);
+
+	virtual Value VisitEmpty(PTR_EMPTY_AST root);
+
+	/*
+	Functionality: evaluate an operator tree without native recursion (see NodeVisitor::WalkExpression)
+	Return: value of the expression
+	*/
+	Value EvaluateExpression(PTR_AST root);
+
+	// Operation applied on the already evaluated operands of a binary/unary node
+	virtual Value ApplyBinary(PTR_BINARY_AST root, const Value& left, const Value& right);
+
+	virtual Value ApplyUnary(PTR_UNARY_AST root, const Value& operand);
+
+	/*
+	Functionality: run a binary node in the specialized form it was rewritten into the first time it ran (see QuickForm),
+	rewriting it first if it has not run yet
+	Return: false if the node is generic and its operands have to be walked, the result is set otherwise
+	*/
+	virtual bool EvaluateQuickened(PTR_BINARY_AST root, Value& result);
+
+	// Choose the specialized form of a node running for the first time
+	void QuickenLeaf(PTR_AST leaf);
+
+	void QuickenBinary(PTR_BINARY_AST root);
+
+	// Value of a leaf rewritten into eLiteral or eSlot
+	inline Value ReadQuickened(PTR_AST leaf)
+	{
+		if (leaf->GetQuickForm() == QuickForm::eLiteral)
+			return leaf->GetLiteral();
+		Value memory = m_frames.SlotAt(leaf->GetQuickSlot());
+		if (memory.IsEmpty())
+		{
+			ErrorSFD("SymbolError(Interpreter): variable " + std::string(leaf->GetToken()->GetValue()) + " used before reference.", leaf->GetToken()->GetPos());
+		}
+		memory.SetPos(leaf->GetToken()->GetPos());
+		return memory;
+	}
+
+	// Whether the right operand of AND/OR has to be evaluated after its left one, and the result once it has
+	virtual bool NeedsRightOperand(PTR_LOGICAL_AST root, const Value& left);
+
+	virtual Value ApplyLogical(PTR_LOGICAL_AST root, const Value& left, const Value& right);
+
+	// Value of an IF/WHILE/UNTIL condition, checked to be BOOLEAN by the semantic analyzer
+	inline bool EvaluateCondition(PTR_AST condition)
+	{
+		return InterpretProgramHelper(condition).GetBoolean();
+	}
 
-	
 protected:
 	Operator m_opeartor;
 
+	// Operand stack of EvaluateExpression, kept between evaluations so that they do not allocate
+	std::vector<Value> m_values;
+
+	// Activation records of the running program, the frame layouts are computed by the semantic analyzer
+	FrameStack m_frames;
+
 	unsigned int m_scopeCounter = 0;
-	// Data structure that stores scoped symbol/memory table
+	// Data structure that stores scoped symbol/procedure table, used by the semantic analyzer
 	// The ith table is enclosed by the (i-1)th table
-	std::vector<ScopedMemoryTable> m_memoryTableVec;
 	std::vector<ScopedSymbolTable> m_symoblTableVec;
 	std::vector<ScopedProcedureTable> m_procedureTableVec;
 
-	// Pointer to the current symbol/memory table
-	ScopedMemoryTable* m_pMemoryTable;
+	// Pointer to the current symbol/procedure table
 	ScopedSymbolTable* m_pSymbolTable;
 	ScopedProcedureTable* m_pProcedureTable;
 };
@@ -379,22 +505,72 @@ public:
 	}
 	virtual ~SemanticAnalyzer() {};
 
+	virtual void Reset() noexcept override
+	{
+		Interpreter::Reset();
+		m_loopVariables.clear();
+	}
+
 protected:
 
 	/*
 	Functionality: interpreting the program (statments, assignment, operators, variables)
 	Return: InterpretProgram
 	*/
-	virtual SHARE_TOKEN_STRING InterpretProgramHelper(SHARE_AST root) override;
+	virtual Value InterpretProgramHelper(PTR_AST root) override;
+
+	virtual Value VisitProgram(PTR_PROGRAM_AST root) override;
+
+	virtual Value VisitBlock(PTR_BLOCK_AST root) override;
+
+	virtual Value VisitProcedure(PTR_PROCEDURE_AST root, PTR_COMPOUND_AST params = nullptr) override;
+
+	virtual Value VisitProcedureCall(PTR_PROCEDURE_AST root) override;
 
-	virtual SHARE_TOKEN_STRING VisitBlock(SHARE_BLOCk_AST root);
+	// Nodes are only specialized while the program runs
+	virtual bool EvaluateQuickened(PTR_BINARY_AST /*root*/, Value& /*result*/) override
+	{
+		return false;
+	}
+
+	virtual Value ApplyBinary(PTR_BINARY_AST root, const Value& left, const Value& right) override;
+
+	virtual Value ApplyUnary(PTR_UNARY_AST root, const Value& operand) override;
+
+	virtual bool NeedsRightOperand(PTR_LOGICAL_AST root, const Value& left) override;
+
+	virtual Value ApplyLogical(PTR_LOGICAL_AST root, const Value& left, const Value& right) override;
+
+	virtual Value VisitAssign(PTR_ASSIGN_AST root) override;
+
+	virtual Value VisitFor(PTR_FOR_AST root) override;
 
-	virtual SHARE_TOKEN_STRING VisitProcedure(SHARE_PROCEDURE_AST root, SHARE_COMPOUND_AST params = nullptr) override;
+	virtual Value VisitIf(PTR_IF_AST root) override;
 
-	virtual SHARE_TOKEN_STRING VisitBinary(SHARE_BINARY_AST root) override;
+	virtual Value VisitWhile(PTR_WHILE_AST root) override;
 
-	virtual SHARE_TOKEN_STRING VisitAssign(SHARE_ASSIGN_AST root) override;
+	virtual Value VisitRepeat(PTR_REPEAT_AST root) override;
 
-	virtual SHARE_TOKEN_STRING VisitVairbale(SHARE_AST root) override;
+	// Reject a condition that is not BOOLEAN, pointing at the statement when it has no position of its own
+	void CheckCondition(PTR_AST condition, PTR_AST statement);
 
+	virtual Value VisitVairbale(PTR_AST root) override;
+
+	// Short description of an expression for error messages: its literal value, variable or procedure name
+	std::string DescribeExpression(PTR_AST root);
+
+	// Whether a resolved variable is the control variable of an enclosing FOR loop
+	bool IsLoopVariable(PTR_AST var) const noexcept
+	{
+		for (auto& slot : m_loopVariables)
+		{
+			if (slot.first == var->GetSlotLevel() && slot.second == var->GetSlotIndex())
+				return true;
+		}
+		return false;
+	}
+
+protected:
+	// (scope level, slot index) of the control variables of the loops being analyzed, they can not be assigned
+	std::vector<std::pair<unsigned int, unsigned int>> m_loopVariables;
 };
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+#include <array>
+#include <string_view>
+#include "MyMacros.hpp"
+
+/*
+Reserved words and type names recognized by the lexer.
+Pascal keywords are case-insensitive: 'begin', 'Begin' and 'BEGIN' are the same keyword.
+Classification goes through a perfect hash generated at compile time, so it stays O(1) as the keyword set grows.
+*/
+struct Keyword
+{
+	std::string_view spelling;	// canonical (upper case) spelling, used as the token payload
+	TokenKind kind;
+};
+
+constexpr Keyword KEYWORDS[] = {
+	{ "BEGIN", BEGIN },
+	{ "END", END },
+	{ "FOR", FOR },
+	{ "TO", TO },
+	{ "DOWNTO", DOWNTO },
+	{ "DO", DO },
+	{ "IF", IF },
+	{ "THEN", THEN },
+	{ "ELSE", ELSE },
+	{ "WHILE", WHILE },
+	{ "REPEAT", REPEAT },
+	{ "UNTIL", UNTIL },
+	{ "AND", AND },
+	{ "OR", OR },
+	{ "NOT", NOT },
+	{ "TRUE", BOOLEAN },
+	{ "FALSE", BOOLEAN },
+	{ "PROGRAM", PROGRAM },
+	{ "PROCEDURE", PROCEDURE },
+	{ "VAR", VAR },
+	{ "INTEGER", TYPE },
+	{ "FLOAT", TYPE },
+	{ "BOOLEAN", TYPE }
+};
+
+constexpr unsigned int KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+constexpr unsigned int KEYWORD_TABLE_SIZE = 64;
+static_assert(KEYWORD_COUNT < KEYWORD_TABLE_SIZE, "keyword table is too small for the keyword set.");
+
+constexpr char KeywordUpper(char c) noexcept
+{
+	return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+/*
+Functionality: case-insensitive hash of an identifier, only its length and three characters are read
+Return: slot in the keyword table
+*/
+constexpr unsigned int KeywordHash(std::string_view text, unsigned int seed) noexcept
+{
+	unsigned int hash = seed ^ static_cast<unsigned int>(text.size());
+	hash = hash * 31 + static_cast<unsigned char>(KeywordUpper(text[0]));
+	hash = hash * 31 + static_cast<unsigned char>(KeywordUpper(text[text.size() / 2]));
+	hash = hash * 31 + static_cast<unsigned char>(KeywordUpper(text[text.size() - 1]));
+	hash ^= hash >> 7;
+	return hash & (KEYWORD_TABLE_SIZE - 1);
+}
+
+/*
+Functionality: check whether a seed maps every keyword to a distinct slot
+*/
+constexpr bool IsKeywordSeedPerfect(unsigned int seed) noexcept
+{
+	bool used[KEYWORD_TABLE_SIZE] = {};
+	for (unsigned int i = 0; i < KEYWORD_COUNT; i++)
+	{
+		unsigned int slot = KeywordHash(KEYWORDS[i].spelling, seed);
+		if (used[slot])
+			return false;
+		used[slot] = true;
+	}
+	return true;
+}
+
+/*
+Functionality: search the first collision free seed
+Return: the seed, or 0 if none is found (rejected by the static_assert below)
+*/
+constexpr unsigned int FindKeywordSeed() noexcept
+{
+	for (unsigned int seed = 1; seed < 4096; seed++)
+	{
+		if (IsKeywordSeedPerfect(seed))
+			return seed;
+	}
+	return 0;
+}
+
+constexpr unsigned int KEYWORD_SEED = FindKeywordSeed();
+static_assert(KEYWORD_SEED != 0, "no perfect hash seed for the keyword set, grow KEYWORD_TABLE_SIZE.");
+
+/*
+Functionality: build the slot -> keyword index table (index + 1, 0 for an empty slot)
+*/
+constexpr std::array<unsigned char, KEYWORD_TABLE_SIZE> BuildKeywordTable() noexcept
+{
+	std::array<unsigned char, KEYWORD_TABLE_SIZE> table = {};
+	for (unsigned int i = 0; i < KEYWORD_COUNT; i++)
+		table[KeywordHash(KEYWORDS[i].spelling, KEYWORD_SEED)] = static_cast<unsigned char>(i + 1);
+	return table;
+}
+
+constexpr std::array<unsigned char, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = BuildKeywordTable();
+
+/*
+Functionality: classify an identifier without allocating, comparison is case-insensitive
+Return: the keyword, or nullptr for a plain identifier
+*/
+inline const Keyword* LookUpKeyword(std::string_view text) noexcept
+{
+	if (text.empty())
+		return nullptr;
+	unsigned char index = KEYWORD_TABLE[KeywordHash(text, KEYWORD_SEED)];
+	if (index == 0)
+		return nullptr;
+	const Keyword& keyword = KEYWORDS[index - 1];
+	if (keyword.spelling.size() != text.size())
+		return nullptr;
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (KeywordUpper(text[i]) != keyword.spelling[i])
+			return nullptr;
+	}
+	return &keyword;
+}
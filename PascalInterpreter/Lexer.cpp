@@ -1,18 +1,21 @@
 #include "Lexer.hpp"
 
+#include <charconv>
+
 void Lexer::Reset() noexcept
 {
 	m_text = "";
 	m_pos = 0;
 	m_CurrentChar = '\0';
 	m_sfd = nullptr;
+	m_arena = nullptr;
 }
 
-void Lexer::SetText(std::string text) noexcept
+void Lexer::SetText(std::string_view text) noexcept
 {
 	m_text = text;
 	m_pos = 0;
-	m_CurrentChar = m_text[m_pos];
+	m_CurrentChar = (m_text.empty()) ? '\0' : m_text[m_pos];
 }
 
 void Lexer::SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
@@ -20,10 +23,15 @@ void Lexer::SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
 	m_sfd = sfd;
 }
 
+void Lexer::SetArena(Arena* arena) noexcept
+{
+	m_arena = arena;
+}
+
 void Lexer::advance_currentChar()
 {
 	++m_pos;
-	if (m_pos > (m_text.size() - 1))
+	if (m_pos >= m_text.size())
 	{
 		m_CurrentChar = '\0';
 	}
@@ -33,10 +41,16 @@ void Lexer::advance_currentChar()
 	}
 }
 
+void Lexer::seek_currentChar(size_t pos)
+{
+	m_pos = static_cast<unsigned int>(pos);
+	m_CurrentChar = (m_pos < m_text.size()) ? m_text[m_pos] : '\0';
+}
+
 char Lexer::peek_nextChar()
 {
 	auto peek_pos = m_pos + 1;
-	if (peek_pos > (m_text.size() - 1))
+	if (peek_pos >= m_text.size())
 	{
 		return '\0';
 	}
@@ -48,31 +62,21 @@ char Lexer::peek_nextChar()
 
 void Lexer::skip_white_space()
 {
-	while ((std::isspace(m_CurrentChar) || m_CurrentChar == '\n') && m_CurrentChar != '\0')
-	{
-		advance_currentChar();
-	}
+	seek_currentChar(Scanner::SkipWhiteSpace(m_text.data(), m_pos, m_text.size()));
 }
 
 void Lexer::skip_comment()
 {
 	char end = (m_CurrentChar == '#') ? '\n' : '}';
-	while (m_CurrentChar != end && m_CurrentChar != '\0')
-	{
-		advance_currentChar();
-	}
+	seek_currentChar(Scanner::FindCommentEnd(m_text.data(), m_pos, m_text.size(), end));
 	advance_currentChar();
 }
 
-SHARE_TOKEN_STRING Lexer::GetDecimalNumberToken()
+PTR_TOKEN Lexer::GetDecimalNumberToken()
 {
-	std::string charBuffer = "";
 	bool bDecimal = false;
 	unsigned int _pos = m_pos;
 
-	if (m_CurrentChar == '.')
-		charBuffer == "0";
-
 	while ((std::isdigit(m_CurrentChar) || m_CurrentChar == '.') && m_CurrentChar != '\0')
 	{
 		if (m_CurrentChar == '.')
@@ -82,46 +86,58 @@ SHARE_TOKEN_STRING Lexer::GetDecimalNumberToken()
 			else
 				bDecimal = true;
 		}
-
-		charBuffer += MyTemplates::Str(m_CurrentChar);
 		advance_currentChar();
 	}
 
-	return (bDecimal) ? MAKE_SHARE_TOKEN(FLOAT, MAKE_SHARE_STRING(charBuffer), _pos) :
-		MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(charBuffer), _pos);
+	// The payload is a view into the source buffer, '.4' is left as is and read as 0.4
+	auto lexeme = m_text.substr(_pos, m_pos - _pos);
+
+	// Literals are converted once their AST node is built, one its type can not hold is reported at its start
+	std::from_chars_result result;
+	if (bDecimal)
+	{
+		double value;
+		result = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), value);
+	}
+	else
+	{
+		int64_t value;
+		result = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), value);
+	}
+	if (result.ec == std::errc::result_out_of_range)
+		throw MyExceptions::MsgExecption(std::string("SynatxError(lexer): ") + (bDecimal ? "float" : "integer") + " literal out of range.", m_sfd, _pos);
+	return (bDecimal) ? MAKE_ARENA_TOKEN(m_arena, FLOAT, lexeme, _pos) :
+		MAKE_ARENA_TOKEN(m_arena, INTEGER, lexeme, _pos);
 }
 
-SHARE_TOKEN_STRING Lexer::GetIdToken()
+PTR_TOKEN Lexer::GetIdToken()
 {
-	SHARE_TOKEN_STRING result;
-	std::string charBuffer = "";
+	PTR_TOKEN result = nullptr;
 	unsigned int _pos = m_pos;
 	while ((m_CurrentChar == '_' || std::isalnum(m_CurrentChar)) && m_CurrentChar != '\0')
 	{
-		charBuffer += MyTemplates::Str(m_CurrentChar);
 		advance_currentChar();
 	}
+	auto charBuffer = m_text.substr(_pos, m_pos - _pos);
 
-	if (ITEM_IN_VEC(charBuffer, reserverd_keywords))
-	{
-		result = MAKE_SHARE_TOKEN(charBuffer, MAKE_SHARE_STRING(charBuffer), _pos);
-	}
-	else if (ITEM_IN_VEC(charBuffer, type_keywords))
+	// Keywords and type names carry their canonical spelling, so 'integer' is still the INTEGER type
+	const Keyword* keyword = LookUpKeyword(charBuffer);
+	if (keyword != nullptr)
 	{
-		result = MAKE_SHARE_TOKEN(TYPE, MAKE_SHARE_STRING(charBuffer), _pos);
+		result = MAKE_ARENA_TOKEN(m_arena, keyword->kind, keyword->spelling, _pos);
 	}
 	else if (m_CurrentChar == '(')
 	{
-		result = MAKE_SHARE_TOKEN(CALL_ID, MAKE_SHARE_STRING(charBuffer), _pos);
+		result = MAKE_ARENA_TOKEN(m_arena, CALL_ID, charBuffer, _pos);
 	}
 	else
 	{
-		result = MAKE_SHARE_TOKEN(ID, MAKE_SHARE_STRING(charBuffer), _pos);
+		result = MAKE_ARENA_TOKEN(m_arena, ID, charBuffer, _pos);
 	}
 	return result;
 }
 
-SHARE_TOKEN_STRING Lexer::GetNextToken()
+PTR_TOKEN Lexer::GetNextToken()
 {
 	while (m_CurrentChar != '\0')
 	{
@@ -154,24 +170,24 @@ SHARE_TOKEN_STRING Lexer::GetNextToken()
 			{
 				advance_currentChar();
 				advance_currentChar();
-				return MAKE_SHARE_TOKEN(ASSIGN, MAKE_SHARE_STRING(":="), m_pos - 2);
+				return MAKE_ARENA_TOKEN(m_arena, ASSIGN, ":=", m_pos - 2);
 			}
 			else
 			{
 				advance_currentChar();
-				return MAKE_SHARE_TOKEN(COLON, MAKE_SHARE_STRING(":"), m_pos - 1);
+				return MAKE_ARENA_TOKEN(m_arena, COLON, ":", m_pos - 1);
 			}
 		}
 		else if (m_CurrentChar == ',')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(COMMA, MAKE_SHARE_STRING(","), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, COMMA, ",", m_pos - 1);
 		}
 		// Semi colon segements statements
 		else if (m_CurrentChar == ';')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(SEMI, MAKE_SHARE_STRING(";"), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, SEMI, ";", m_pos - 1);
 		}
 		// Every program ends with a '.'
 		else if (m_CurrentChar == '.')
@@ -184,23 +200,23 @@ SHARE_TOKEN_STRING Lexer::GetNextToken()
 			else
 			{
 				advance_currentChar();
-				return MAKE_SHARE_TOKEN(DOT, MAKE_SHARE_STRING("."), m_pos - 1);
+				return MAKE_ARENA_TOKEN(m_arena, DOT, ".", m_pos - 1);
 			}
 		}
 		else if (m_CurrentChar == '+')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(PLUS, MAKE_SHARE_STRING("+"), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, PLUS, "+", m_pos - 1);
 		}
 		else if (m_CurrentChar == '-')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(MINUS, MAKE_SHARE_STRING("-"), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, MINUS, "-", m_pos - 1);
 		}
 		else if (m_CurrentChar == '*')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(MUL, MAKE_SHARE_STRING("*"), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, MUL, "*", m_pos - 1);
 		}
 		else if (m_CurrentChar == '/')
 		{
@@ -209,23 +225,59 @@ SHARE_TOKEN_STRING Lexer::GetNextToken()
 			{
 				advance_currentChar();
 				advance_currentChar();
-				return MAKE_SHARE_TOKEN(INT_DIV, MAKE_SHARE_STRING("//"), m_pos - 2);
+				return MAKE_ARENA_TOKEN(m_arena, INT_DIV, "//", m_pos - 2);
 			}
 			else
 			{
 				advance_currentChar();
-				return MAKE_SHARE_TOKEN(DIV, MAKE_SHARE_STRING("/"), m_pos - 1);
+				return MAKE_ARENA_TOKEN(m_arena, DIV, "/", m_pos - 1);
+			}
+		}
+		else if (m_CurrentChar == '=')
+		{
+			advance_currentChar();
+			return MAKE_ARENA_TOKEN(m_arena, EQUAL, "=", m_pos - 1);
+		}
+		else if (m_CurrentChar == '<')
+		{
+			// '<>' is not equal, '<=' less or equal
+			if (peek_nextChar() == '>' || peek_nextChar() == '=')
+			{
+				bool notEqual = peek_nextChar() == '>';
+				advance_currentChar();
+				advance_currentChar();
+				return notEqual ? MAKE_ARENA_TOKEN(m_arena, NOT_EQUAL, "<>", m_pos - 2) :
+					MAKE_ARENA_TOKEN(m_arena, LESS_EQUAL, "<=", m_pos - 2);
+			}
+			else
+			{
+				advance_currentChar();
+				return MAKE_ARENA_TOKEN(m_arena, LESS, "<", m_pos - 1);
+			}
+		}
+		else if (m_CurrentChar == '>')
+		{
+			if (peek_nextChar() == '=')
+			{
+				advance_currentChar();
+				advance_currentChar();
+				return MAKE_ARENA_TOKEN(m_arena, GREATER_EQUAL, ">=", m_pos - 2);
+			}
+			else
+			{
+				advance_currentChar();
+				return MAKE_ARENA_TOKEN(m_arena, GREATER, ">", m_pos - 1);
 			}
 		}
 		else if (m_CurrentChar == '(')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(LEFT_PARATHESES, MAKE_SHARE_STRING("("), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, LEFT_PARATHESES, "(", m_pos - 1);
 		}
 		else if (m_CurrentChar == ')')
 		{
 			advance_currentChar();
-			return MAKE_SHARE_TOKEN(RIGHT_PARATHESES, MAKE_SHARE_STRING(")"), m_pos - 1);
+			return MAKE_ARENA_TOKEN(m_arena, RIGHT_PARATHESES, ")", m_pos - 1);
 		}
 		// No known token returned, raise excpetion.
 		else
@@ -234,5 +286,18 @@ SHARE_TOKEN_STRING Lexer::GetNextToken()
 		}
 	}
 	// Reaching EOF
-	return MAKE_SHARE_TOKEN(__EOF__, MAKE_SHARE_STRING("\0"), m_pos - 1);
+	return MAKE_ARENA_TOKEN(m_arena, __EOF__, "", m_pos - 1);
+}
+
+void Lexer::Tokenize(TokenBuffer& buffer)
+{
+	buffer.Clear();
+	// Rough guess of one token every four bytes, it only saves a few reallocations
+	buffer.Reserve(m_text.size() / 4 + 1);
+	PTR_TOKEN token = nullptr;
+	do
+	{
+		token = GetNextToken();
+		buffer.Push(token);
+	} while (token->GetType() != __EOF__);
 }
\ No newline at end of file
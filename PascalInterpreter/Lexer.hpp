@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include "Token.hpp"
+#include "Arena.hpp"
+#include "Keyword.hpp"
+#include "Scanner.hpp"
 
 using namespace std;
 
@@ -9,16 +13,19 @@ class Lexer
 public:
 	Lexer()
 		:
-		m_text("\0"),
 		m_pos(0),
 		m_CurrentChar('\0'),
-		m_sfd(nullptr)
+		m_sfd(nullptr),
+		m_arena(nullptr)
 	{}
 	virtual ~Lexer() {};
 
 	void Reset() noexcept;
-	void SetText(std::string text) noexcept;
+	// The lexer does not copy the text: the buffer must outlive every token, whose payloads are views into it
+	void SetText(std::string_view text) noexcept;
 	void SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept;
+	// Tokens are allocated in the arena of the compilation unit, which must outlive them
+	void SetArena(Arena* arena) noexcept;
 
 protected:
 	/*
@@ -42,13 +49,18 @@ protected:
 	*/
 	void advance_currentChar();
 
+	/*
+	Funtionality: helper function to move m_CurrentChar to a position
+	*/
+	void seek_currentChar(size_t pos);
+
 	/*
 	Funtionality: helper function to advance m_CurrentChar
 	*/
 	char peek_nextChar();
 
 	/*
-	Funtionality: helper function to skip whitespace in m_text
+	Funtionality: helper function to skip whitespace in m_text, 16/32 bytes at a time (see Scanner.hpp)
 	*/
 	void skip_white_space();
 
@@ -61,13 +73,13 @@ protected:
 	Funtionality: get multi-digits integer from string
 	Return: Integer Token
 	*/
-	SHARE_TOKEN_STRING GetDecimalNumberToken();
+	PTR_TOKEN GetDecimalNumberToken();
 
 	/*
-	Functinality: get varibale name or reserverd keywords
+	Functinality: get varibale name or reserverd keywords (case-insensitive, see Keyword.hpp)
 	Return: 
 	*/
-	SHARE_TOKEN_STRING GetIdToken();
+	PTR_TOKEN GetIdToken();
 
 
 public:
@@ -75,14 +87,19 @@ public:
 	Funtionality: tokenize m_text
 	Return: an known Token. Otherwise, throw an exception
 	*/
-	SHARE_TOKEN_STRING GetNextToken();
+	PTR_TOKEN GetNextToken();
+
+	/*
+	Funtionality: tokenize the whole m_text in one tight loop
+	Return: none, buffer holds every token up to and including __EOF__
+	*/
+	void Tokenize(TokenBuffer& buffer);
 
 private:
-	std::string m_text;
+	std::string_view m_text;
 	unsigned int m_pos;
 	char m_CurrentChar;
-	std::vector<std::string> reserverd_keywords = { BEGIN , END , PROGRAM, PROCEDURE, VAR};
-	std::vector<std::string> type_keywords = { INTEGER, FLOAT };
 
 	MyDebug::SrouceFileDebugger* m_sfd;
+	Arena* m_arena;
 };
\ No newline at end of file
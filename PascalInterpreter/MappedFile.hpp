@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/*
+MappedFile class
+Read-only memory mapping of a source file. The lexer works directly on the mapped bytes,
+so the mapping must outlive every token produced from it.
+*/
+class MappedFile
+{
+public:
+	MappedFile()
+		:
+		m_data(nullptr),
+		m_size(0)
+	{}
+	virtual ~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/*
+	Functionality: map the whole file read-only, any previous mapping is released first
+	Return: false if the file cannot be opened or mapped
+	*/
+	bool Open(const std::string& path);
+
+	/*
+	Functionality: release the mapping
+	*/
+	void Close() noexcept;
+
+	std::string_view GetView() const noexcept
+	{
+		return std::string_view(m_data, m_size);
+	}
+
+private:
+	const char* m_data;
+	size_t m_size;
+};
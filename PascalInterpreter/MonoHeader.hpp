@@ -1,9 +1,26 @@
 #pragma once
 
 #include "Symbol.hpp"
+#include "Arena.hpp"
+#include "MappedFile.hpp"
 #include "Token.hpp"
+#include "Keyword.hpp"
+#include "Scanner.hpp"
+#include "Value.hpp"
+#include "Frame.hpp"
 #include "AST.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
+#include "ASTCache.hpp"
 #include "Operator.hpp"
-#include "Interpreter.hpp"
\ No newline at end of file
+#include "Interpreter.hpp"
+#include "Bytecode.hpp"
+#include "Optimizer.hpp"
+#include "Compiler.hpp"
+#include "VirtualMachine.hpp"
+#include "RegisterBytecode.hpp"
+#include "RegisterCompiler.hpp"
+#include "RegisterMachine.hpp"
+#include "ClosureMachine.hpp"
+#include "ClosureCompiler.hpp"
+#include "CBackend.hpp"
\ No newline at end of file
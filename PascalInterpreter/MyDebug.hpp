@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "MyTemplates.hpp"
 using namespace std;
@@ -19,42 +22,41 @@ using namespace std;
 namespace MyDebug
 {
 	// TODO: Unit Testing
+	/*
+	Source file debugger
+	Holds a view of the source buffer (which must outlive it) and a line-start offset table built once,
+	so a position is resolved to (line, col) by binary search and line text is served without copies.
+	*/
 	class SrouceFileDebugger
 	{
 	public:
 		SrouceFileDebugger() {};
-		explicit SrouceFileDebugger(std::string filename, std::string oneliner, std::vector<std::string> vec)
+		explicit SrouceFileDebugger(std::string filename, std::string_view source)
 			:
 			m_filename(filename),
-			m_oneliner(oneliner),
-			m_vec(vec)
+			m_source(source)
 		{
+			m_lineStarts.push_back(0);
+			for (size_t i = m_source.find('\n'); i != std::string_view::npos; i = m_source.find('\n', i + 1))
+				m_lineStarts.push_back(static_cast<unsigned int>(i + 1));
 		}
 
 		std::string GetDebugString(unsigned int pos)
 		{
 
-			if (pos > (m_oneliner.size() - 1))
+			// The end of the source is a valid position (errors raised at end of file)
+			if (pos > m_source.size())
 			{
 				throw std::runtime_error("DebugError(SrouceFileDebugger): position " + MyTemplates::Str(pos) \
-					+ " out of size of " + MyTemplates::Str(m_oneliner.size()) + ".");
+					+ " out of size of " + MyTemplates::Str(m_source.size()) + ".");
 			}
 
-			unsigned int line = 0;
-			unsigned int col = 0;
-
-			for (unsigned int i = 0; i < pos; i++)
-			{
-				col++;
-				if (m_oneliner[i] == '\n')
-				{
-					line++;
-					col = 0;
-				}
-			}
+			// Last line starting at or before pos
+			unsigned int line = static_cast<unsigned int>(std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), pos) - m_lineStarts.begin() - 1);
+			unsigned int col = pos - m_lineStarts[line];
 
 			return "File---> '" + m_filename + "' at line " + MyTemplates::Str(line) + "\n"  \
-				+ std::string(8, ' ') + m_vec[line] + "\n"  \
+				+ std::string(8, ' ') + std::string(GetLine(line)) + "\n"  \
 				+ std::string(8 + col, ' ') + "^" + "\n";
 		}
 
@@ -63,20 +65,38 @@ namespace MyDebug
 			return m_filename;
 		}
 
-		std::string GetOneliner() const noexcept
+		std::string_view GetSource() const noexcept
+		{
+			return m_source;
+		}
+
+		/*
+		Functionality: number of lines, a trailing line break does not open a new line
+		*/
+		unsigned int GetLineCount() const noexcept
 		{
-			return m_oneliner;
+			unsigned int count = static_cast<unsigned int>(m_lineStarts.size());
+			return (m_lineStarts.back() == m_source.size()) ? count - 1 : count;
 		}
 
-		std::vector<std::string> GetLineVector() const noexcept
+		/*
+		Functionality: text of a line without its line break ('\n' or "\r\n")
+		Return: view into the source buffer
+		*/
+		std::string_view GetLine(unsigned int line) const noexcept
 		{
-			return m_vec;
+			size_t begin = m_lineStarts[line];
+			size_t end = (line + 1 < m_lineStarts.size()) ? m_lineStarts[line + 1] - 1 : m_source.size();
+			std::string_view text = m_source.substr(begin, end - begin);
+			if (!text.empty() && text.back() == '\r')
+				text.remove_suffix(1);
+			return text;
 		}
 
 	private:
 		std::string m_filename;
-		std::string m_oneliner;
-		std::vector<std::string> m_vec;
+		std::string_view m_source;
+		std::vector<unsigned int> m_lineStarts;
 	};
 }
 
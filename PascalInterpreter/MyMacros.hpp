@@ -11,106 +11,165 @@ using namespace std;
 
 /*
 Token types
+Integer token kinds compared by the lexer and the parser, names are only used for diagnostics
 */
-#define TYPE "TYPE"
-#define INTEGER "INTEGER"
-#define FLOAT "FLOAT"
-
-#define PLUS "PLUS"
-#define MINUS "MINUS"
-#define MUL "MUL"
-#define DIV "DIV"
-#define INT_DIV "INT_DIV"
-#define LEFT_PARATHESES "LEFT_PARATHESES"
-#define RIGHT_PARATHESES "RIGHT_PARATHESES"
-#define COLON "COLON"
-#define COMMA "COMMA"
-
-#define PROGRAM "PROGRAM"
-#define PROCEDURE "PROCEDURE"
-#define CALL_ID "CALL_ID"
-#define VAR "VAR"
-#define BEGIN "BEGIN"
-#define END "END"
-#define DOT "DOT"
-#define ASSIGN "ASSIGN"
-#define SEMI "SEMI"
-#define ID "ID"
-#define EMPTY "EMPTY"
-
-#define __EOF__ "__EOF__"
+enum TokenKind : unsigned char
+{
+	TYPE,
+	INTEGER,
+	FLOAT,
+	BOOLEAN,
+
+	PLUS,
+	MINUS,
+	MUL,
+	DIV,
+	INT_DIV,
+	EQUAL,
+	NOT_EQUAL,
+	LESS,
+	LESS_EQUAL,
+	GREATER,
+	GREATER_EQUAL,
+	AND,
+	OR,
+	NOT,
+	LEFT_PARATHESES,
+	RIGHT_PARATHESES,
+	COLON,
+	COMMA,
+
+	PROGRAM,
+	PROCEDURE,
+	CALL_ID,
+	VAR,
+	BEGIN,
+	END,
+	FOR,
+	TO,
+	DOWNTO,
+	DO,
+	IF,
+	THEN,
+	ELSE,
+	WHILE,
+	REPEAT,
+	UNTIL,
+	DOT,
+	ASSIGN,
+	SEMI,
+	ID,
+	EMPTY,
+
+	__EOF__
+};
+
+/*
+Functionality: name of a token kind for diagnostics and ToString
+*/
+inline const char* GetTokenKindName(TokenKind kind) noexcept
+{
+	static const char* names[] = {
+		"TYPE", "INTEGER", "FLOAT", "BOOLEAN",
+		"PLUS", "MINUS", "MUL", "DIV", "INT_DIV", "EQUAL", "NOT_EQUAL", "LESS", "LESS_EQUAL", "GREATER", "GREATER_EQUAL",
+		"AND", "OR", "NOT", "LEFT_PARATHESES", "RIGHT_PARATHESES", "COLON", "COMMA",
+		"PROGRAM", "PROCEDURE", "CALL_ID", "VAR", "BEGIN", "END", "FOR", "TO", "DOWNTO", "DO",
+		"IF", "THEN", "ELSE", "WHILE", "REPEAT", "UNTIL", "DOT", "ASSIGN", "SEMI", "ID", "EMPTY",
+		"__EOF__"
+	};
+	return (kind <= __EOF__) ? names[kind] : "UNKNOWN";
+}
+
+//Limits----------------------------------------------------------------------------------------------
+// Pending nodes of the heap work stacks used to parse and walk one expression
+#define MAX_EXPRESSION_DEPTH 1000000
+// Native recursion levels of statements (nested BEGIN/END blocks, procedure call arguments)
+#define MAX_STATEMENT_DEPTH 256
+// Operator levels compiled into nested closures, deeper expressions run their operators from a flat sequence
+#define MAX_CLOSURE_NESTING 256
+// Operator levels generated into one C expression by the C backend, deeper expressions are split into temporaries
+#define MAX_C_EXPRESSION_NESTING 64
+
+//Dispatch----------------------------------------------------------------------------------------------
+// Labels as values (GCC, Clang) for the direct-threaded register machine, other compilers dispatch through a switch
+#if defined(__GNUC__) || defined(__clang__)
+#define HAS_COMPUTED_GOTO 1
+#else
+#define HAS_COMPUTED_GOTO 0
+#endif
+
+//C backend---------------------------------------------------------------------------------------------
+// C compiler the C backend builds with by default: cl in MSVC toolchains, the system cc elsewhere
+#if defined(_MSC_VER)
+#define C_BACKEND_COMPILER "cl"
+#else
+#define C_BACKEND_COMPILER "cc"
+#endif
 
 //Utility----------------------------------------------------------------------------------------------
 #define Myprintln(var) std::cout << var->ToString() << std::endl;
 #define ITEM_IN_VEC(item, vec) (find(vec.begin(), vec.end(), item) != vec.end())
 
 
-//Share pointer types----------------------------------------------------------------------------------------------
-#define SHARE_STRING std::shared_ptr<std::string>
-#define SHARE_TOKEN_STRING std::shared_ptr<Token<std::shared_ptr<std::string>>>
-
-#define SHARE_AST std::shared_ptr<AST>
-#define SHARE_UNARY_AST std::shared_ptr<UnaryOp_AST>
-#define SHARE_BINARY_AST std::shared_ptr<BinaryOp_AST>
-#define SHARE_COMPOUND_AST std::shared_ptr<Compound_AST>
-#define SHARE_ASSIGN_AST std::shared_ptr<Assign_AST>
-#define SHARE_EMPTY_AST std::shared_ptr<Empty_AST>
-#define SHARE_PROGRAM_AST std::shared_ptr<Program_AST>
-#define SHARE_PROCEDURE_AST std::shared_ptr<Procedure_AST>
-#define SHARE_BLOCk_AST std::shared_ptr<Block_AST>
-
-#define SHARE_DECLARATION_AST std::shared_ptr<Declaration_AST>
-#define SHARE_DECLCONTAINER_AST std::shared_ptr<DeclContainer_AST>
-#define SHARE_VARDECL_AST std::shared_ptr<VarDecl_AST>
-
-//Share pointer maker----------------------------------------------------------------------------------------------
-#define MAKE_SHARE_STRING(var) std::make_shared<std::string>(var)
-#define MAKE_SHARE_TOKEN(type,var,pos) std::make_shared<Token<decltype(var)>>(type,var,pos)
-
-#define MAKE_SHARE_AST(token) std::make_shared<AST>(token)
-#define MAKE_SHARE_UNARY_AST(op, expr) std::make_shared<UnaryOp_AST>(op, expr)
-#define MAKE_SHARE_BINARY_AST(left, right, op) std::make_shared<BinaryOp_AST>(left, right, op)
-#define MAKE_SHARE_COMPOUND_AST() std::make_shared<Compound_AST>()
-#define MAKE_SHARE_ASSIGN_AST(left, right, op) std::make_shared<Assign_AST>(left, right, op)
-#define	MAKE_SHARE_EMPTY_AST() std::make_shared<Empty_AST>()
-#define MAKE_SHARE_PROGRAM_AST(name, block) std::make_shared<Program_AST>(name, block)
-#define MAKE_SHARE_PROCEDURE_AST(name, params, block) std::make_shared<Procedure_AST>(name, params, block)
-#define MAKE_SHARE_BLOCK_AST(declaration, compound) std::make_shared<Block_AST>(declaration, compound)
-
-#define MAKE_SHARE_DECLARATION_AST() std::make_shared<Declaration_AST>()
-#define MAKE_SHARE_DECLCONTAINER_AST() std::make_shared<DeclContainer_AST>()
-#define MAKE_SHARE_VARDECL_AST(var, type) std::make_shared<VarDecl_AST>(var, type)
-
-//Share pointer creator----------------------------------------------------------------------------------------------
-#define CREATE_SHARE_STRING(name, var) std::shared_ptr<std::string> name(new std::string(var));
-#define CREATE_SHARE_TOKEN(name, type, var) std::shared_ptr<Token<std::shared_ptr<std::string>>> name(new Token<std::shared_ptr<std::string>>(type, var));
-
-#define CREATE_SHARE_AST(name, token) std::shared_ptr<AST> name(new AST(token));
-#define CREATE_SHARE_UNARY_AST(name, op, expr) std::shared_ptr<UnaryOp_AST> name(new UnaryOp_AST(op, expr));
-#define CREATE_SHARE_BINARY_AST(name, left, right, op) std::shared_ptr<BinaryOp_AST> name(new BinaryOp_AST(left, right, op));
-#define CREATE_SHARE_COMPOUND_AST(name) std::shared_ptr<Compound_AST> name(new Compound_AST());
-#define CREATE_SHARE_ASSIGN_AST(name, left, right, op) std::shared_ptr<Assign_AST> name(new Assign_AST(left, right, op));
-#define CREATE_SHARE_EMPTY_AST(name) std::shared_ptr<Empty_AST> name(new Empty_AST());
-#define CREATE_SHARE_PROGRAM_AST(name, programName, block) std::shared_ptr<Program_AST> name(new Program_AST(programName, block));
-#define CREATE_SHARE_PROCEDURE_AST(name, programName, params, block) std::shared_ptr<Procedure_AST> name(new Procedure_AST(programName, params, block));
-#define CREATE_SHARE_BLOCK_AST(name, declaration, compound) std::shared_ptr<Block_AST> name(new Block_AST(declaration, compound));
-
-#define CREATE_SHARE_DECLARATION_AST(name) std::shared_ptr<Declaration_AST> name(new Declaration_AST());
-#define CREATE_SHARE_DECLCONTAINER_AST(name) std::shared_ptr<DeclContainer_AST> name(new DeclContainer_AST());
-#define CREATE_SHARE_VARDECL_AST(name, var, type) std::shared_ptr<VarDecl_AST> name(new VarDecl_AST(var, type));
+//Arena pointer types----------------------------------------------------------------------------------------------
+#define PTR_TOKEN Token*
+
+#define PTR_AST AST*
+#define PTR_UNARY_AST UnaryOp_AST*
+#define PTR_BINARY_AST BinaryOp_AST*
+#define PTR_LOGICAL_AST LogicalOp_AST*
+#define PTR_COMPOUND_AST Compound_AST*
+#define PTR_ASSIGN_AST Assign_AST*
+#define PTR_FOR_AST For_AST*
+#define PTR_IF_AST If_AST*
+#define PTR_WHILE_AST While_AST*
+#define PTR_REPEAT_AST Repeat_AST*
+#define PTR_EMPTY_AST Empty_AST*
+#define PTR_PROGRAM_AST Program_AST*
+#define PTR_PROCEDURE_AST Procedure_AST*
+#define PTR_BLOCK_AST Block_AST*
+
+#define PTR_DECLARATION_AST Declaration_AST*
+#define PTR_DECLCONTAINER_AST DeclContainer_AST*
+#define PTR_VARDECL_AST VarDecl_AST*
+
+//Arena pointer maker----------------------------------------------------------------------------------------------
+#define MAKE_ARENA_TOKEN(arena, type, var, pos) (arena)->Make<Token>(type, var, pos)
+
+#define MAKE_ARENA_AST(arena, token) (arena)->Make<AST>(token)
+#define MAKE_ARENA_UNARY_AST(arena, op, expr) (arena)->Make<UnaryOp_AST>(op, expr)
+#define MAKE_ARENA_BINARY_AST(arena, left, right, op) (arena)->Make<BinaryOp_AST>(left, right, op)
+#define MAKE_ARENA_LOGICAL_AST(arena, left, right, op) (arena)->Make<LogicalOp_AST>(left, right, op)
+#define MAKE_ARENA_COMPOUND_AST(arena) (arena)->Make<Compound_AST>()
+#define MAKE_ARENA_ASSIGN_AST(arena, left, right, op) (arena)->Make<Assign_AST>(left, right, op)
+#define MAKE_ARENA_FOR_AST(arena, var, start, end, body, direction) (arena)->Make<For_AST>(var, start, end, body, direction)
+#define MAKE_ARENA_IF_AST(arena, condition, then, otherwise, op) (arena)->Make<If_AST>(condition, then, otherwise, op)
+#define MAKE_ARENA_WHILE_AST(arena, condition, body, op) (arena)->Make<While_AST>(condition, body, op)
+#define MAKE_ARENA_REPEAT_AST(arena, body, condition, op) (arena)->Make<Repeat_AST>(body, condition, op)
+#define	MAKE_ARENA_EMPTY_AST(arena) (arena)->Make<Empty_AST>()
+#define MAKE_ARENA_PROGRAM_AST(arena, name, block) (arena)->Make<Program_AST>(name, block)
+#define MAKE_ARENA_PROCEDURE_AST(arena, name, params, block) (arena)->Make<Procedure_AST>(name, params, block)
+#define MAKE_ARENA_BLOCK_AST(arena, declaration, compound) (arena)->Make<Block_AST>(declaration, compound)
+
+#define MAKE_ARENA_DECLARATION_AST(arena) (arena)->Make<Declaration_AST>()
+#define MAKE_ARENA_DECLCONTAINER_AST(arena) (arena)->Make<DeclContainer_AST>()
+#define MAKE_ARENA_VARDECL_AST(arena, var, type) (arena)->Make<VarDecl_AST>(var, type)
+
+//Arena pointer creator----------------------------------------------------------------------------------------------
+#define CREATE_ARENA_UNARY_AST(arena, name, op, expr) PTR_UNARY_AST name = MAKE_ARENA_UNARY_AST(arena, op, expr);
+#define CREATE_ARENA_COMPOUND_AST(arena, name) PTR_COMPOUND_AST name = MAKE_ARENA_COMPOUND_AST(arena);
+#define CREATE_ARENA_DECLARATION_AST(arena, name) PTR_DECLARATION_AST name = MAKE_ARENA_DECLARATION_AST(arena);
+#define CREATE_ARENA_DECLCONTAINER_AST(arena, name) PTR_DECLCONTAINER_AST name = MAKE_ARENA_DECLCONTAINER_AST(arena);
 
 
 //Symbol And Memory----------------------------------------------------------------------------------------------
-#define TOKEN_STRING_MAP std::map<std::string, SHARE_TOKEN_STRING>
-#define TOKEN_STRING_PAIR std::pair<std::string, SHARE_TOKEN_STRING>
-
-#define MEMORY SHARE_TOKEN_STRING
-#define MAKE_EMPTY_MEMORY MAKE_SHARE_TOKEN(EMPTY, MAKE_SHARE_STRING("\0"), 0)
+#define MEMORY Value
+#define MAKE_EMPTY_MEMORY Value()
 #define MEMORY_MAP std::map<std::string, MEMORY>
 #define MEMORY_PAIR std::pair<std::string, MEMORY>
 
 #define SYMBOL_MAP std::map<std::string, VarSymbol>
 #define SYMBOL_PAIR std::pair<std::string, VarSymbol>
 
-#define PROCEDURE_MAP std::map<std::string, SHARE_PROCEDURE_AST>
-#define PROCEDURE_PAIR std::pair<std::string, SHARE_PROCEDURE_AST>
\ No newline at end of file
+#define PROCEDURE_MAP std::map<std::string, PTR_PROCEDURE_AST>
+#define PROCEDURE_PAIR std::pair<std::string, PTR_PROCEDURE_AST>
\ No newline at end of file
@@ -1,82 +1,77 @@
 #include "Operator.hpp"
 
-enum NumOp_code
-{
-	eUNKNOWN = -1,
-	ePLUS,
-	eMINUS,
-	eMULTIPLY,
-	eDIVIDE,
-	eINT_DIV
-};
-
-NumOp_code GetEnumNumOp(std::string const& op)
+NumOp_code GetEnumNumOp(TokenKind op)
 {
 	if (op == PLUS) return ePLUS;
 	else if (op == MINUS) return eMINUS;
 	else if (op == MUL) return eMULTIPLY;
 	else if (op == DIV) return eDIVIDE;
 	else if (op == INT_DIV) return eINT_DIV;
+	else if (op == EQUAL) return eEQUAL;
+	else if (op == NOT_EQUAL) return eNOT_EQUAL;
+	else if (op == LESS) return eLESS;
+	else if (op == LESS_EQUAL) return eLESS_EQUAL;
+	else if (op == GREATER) return eGREATER;
+	else if (op == GREATER_EQUAL) return eGREATER_EQUAL;
+	else if (op == AND) return eAND;
+	else if (op == OR) return eOR;
+	else if (op == NOT) return eNOT;
 	else return eUNKNOWN;
 }
 
 
-SHARE_TOKEN_STRING Operator::exprBinaryDeciamlNumOp(SHARE_TOKEN_STRING left, SHARE_TOKEN_STRING right, SHARE_TOKEN_STRING op)
+Value Operator::exprBinaryDeciamlNumOp(const Value& left, const Value& right, PTR_TOKEN op)
+{
+	auto code = GetEnumNumOp(op->GetType());
+	if (code == eUNKNOWN)
+	{
+		Error("SyntaxError: " + op->ToString() + " is an UNKNOWN integer operation.\n");
+		return MAKE_EMPTY_MEMORY;
+	}
+	return exprBinaryDeciamlNumOp(left, right, code);
+}
+
+Value Operator::exprBinaryDeciamlNumOp(const Value& left, const Value& right, NumOp_code op)
 {
+	if (op != eUNKNOWN && op != eNOT && !Kernels::IsBinarySupported(op, left.GetTypeTag(), right.GetTypeTag()))
+	{
+		Error("SyntaxError: " + left.ToString() + " or " + right.ToString() + " is not a valid operand of operation code " + MyTemplates::Str(op) + ".\n");
+		return MAKE_EMPTY_MEMORY;
+	}
 
+	BinaryKernel kernel = GetBinaryKernel(op, left.GetTypeTag(), right.GetTypeTag());
+	if (kernel == nullptr)
+	{
+		Error("SyntaxError: operation code " + MyTemplates::Str(op) + " is an UNKNOWN integer operation.\n");
+		return MAKE_EMPTY_MEMORY;
+	}
+	return kernel(left, right);
+}
 
-	if (left->GetType() != INTEGER && right->GetType() != INTEGER && left->GetType() != FLOAT && right->GetType() != FLOAT)
+Value Operator::exprUnaryDeciamlNumOp(const Value& expr, PTR_TOKEN op)
+{
+	auto code = GetEnumNumOp(op->GetType());
+	if (code == eUNKNOWN)
 	{
-		Error("SyntaxError: " + left->ToString() + " or " + right->ToString() + " is an not a integer/float or both.\n");
+		Error("SyntaxError: " + op->ToString() + " is an UNKNOWN unary operation.\n");
 		return MAKE_EMPTY_MEMORY;
 	}
+	return exprUnaryDeciamlNumOp(expr, code);
+}
 
-	bool isInt = false;
-	float _left = std::stof(*(left->GetValue()));
-	float _right = std::stof(*(right->GetValue()));
-	if (left->GetType() == INTEGER && right->GetType() == INTEGER)
-		isInt = true;
+Value Operator::exprUnaryDeciamlNumOp(const Value& expr, NumOp_code op)
+{
+	if ((op == ePLUS || op == eMINUS || op == eNOT) && !Kernels::IsUnarySupported(op, expr.GetTypeTag()))
+	{
+		Error("SyntaxError: " + expr.ToString() + " is not a valid operand of operation code " + MyTemplates::Str(op) + ".\n");
+		return MAKE_EMPTY_MEMORY;
+	}
 
-	switch (GetEnumNumOp(op->GetType()))
+	UnaryKernel kernel = GetUnaryKernel(op, expr.GetTypeTag());
+	if (kernel == nullptr)
 	{
-	case ePLUS:
-		return (isInt) ? MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(MyTemplates::Str((int)_left + (int)_right)), left->GetPos()) :
-			MAKE_SHARE_TOKEN(FLOAT, MAKE_SHARE_STRING(MyTemplates::Str(_left + _right)), left->GetPos());
-	case eMINUS:
-		return (isInt) ? MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(MyTemplates::Str((int)_left - (int)_right)), left->GetPos()) :
-			MAKE_SHARE_TOKEN(FLOAT, MAKE_SHARE_STRING(MyTemplates::Str(_left - _right)), left->GetPos());
-	case eMULTIPLY:
-		return (isInt) ? MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(MyTemplates::Str((int)_left * (int)_right)), left->GetPos()) :
-			MAKE_SHARE_TOKEN(FLOAT, MAKE_SHARE_STRING(MyTemplates::Str(_left * _right)), left->GetPos());
-	case eDIVIDE:
-		if (_right != 0)
-		{
-			return (isInt) ? MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(MyTemplates::Str((int)_left / (int)_right)), left->GetPos()) :
-				MAKE_SHARE_TOKEN(FLOAT, MAKE_SHARE_STRING(MyTemplates::Str(_left / _right)), left->GetPos());
-		}
-		else
-		{
-			Error("SyntaxError: Decimal number division by zero.");
-			return MAKE_EMPTY_MEMORY;
-		}
-	case eINT_DIV:
-		if (_right != 0)
-		{
-			if (!isInt)
-			{
-				Error("SyntaxError: integer devision applied to non-integer type.");
-				return MAKE_EMPTY_MEMORY;
-			}
-			else
-				return MAKE_SHARE_TOKEN(INTEGER, MAKE_SHARE_STRING(MyTemplates::Str((int)_left / (int)_right)), left->GetPos());
-		}
-		else
-		{
-			Error("SyntaxError: Decimal number division by zero.");
-			return MAKE_EMPTY_MEMORY;
-		}
-	default:
-		Error("SyntaxError: " + op->ToString() + " is an UNKNOWN integer operation.\n");
+		Error("SyntaxError: operation code " + MyTemplates::Str(op) + " is an UNKNOWN unary operation.\n");
 		return MAKE_EMPTY_MEMORY;
 	}
-}
\ No newline at end of file
+	return kernel(expr);
+}
@@ -1,5 +1,323 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <type_traits>
 #include "Token.hpp"
+#include "Value.hpp"
+
+enum NumOp_code
+{
+	eUNKNOWN = -1,
+	ePLUS,
+	eMINUS,
+	eMULTIPLY,
+	eDIVIDE,
+	eINT_DIV,
+	eEQUAL,
+	eNOT_EQUAL,
+	eLESS,
+	eLESS_EQUAL,
+	eGREATER,
+	eGREATER_EQUAL,
+	eAND,
+	eOR,
+	eNOT
+};
+
+/*
+Functionality: map a operator token type to its operation code
+*/
+NumOp_code GetEnumNumOp(TokenKind op);
+
+/*
+Functionality: whether an operation compares its operands (=, <>, <, <=, >, >=)
+*/
+constexpr bool IsRelationalOp(NumOp_code op) noexcept
+{
+	return op >= eEQUAL && op <= eGREATER_EQUAL;
+}
+
+/*
+Functionality: whether an operation is a short-circuit AND/OR, which the engines evaluate with a branch
+*/
+constexpr bool IsLogicalOp(NumOp_code op) noexcept
+{
+	return op == eAND || op == eOR;
+}
+
+/*
+Operation kernels specialized at compile time.
+One kernel is instantiated per (operation, operand types); an engine binds a node or an instruction
+to its kernel once, through the constexpr tables below, and then calls it without decoding anything.
+Kernels trust the operand types they were chosen for, the semantic analyzer guarantees them.
+*/
+using BinaryKernel = Value(*)(const Value& left, const Value& right);
+using UnaryKernel = Value(*)(const Value& expr);
+
+namespace Kernels
+{
+	template <Value::Type TYPE>
+	struct Operand;
+
+	template <>
+	struct Operand<Value::Type::eInteger>
+	{
+		static int64_t Read(const Value& value) noexcept
+		{
+			return value.GetInteger();
+		}
+	};
+
+	template <>
+	struct Operand<Value::Type::eFloat>
+	{
+		static double Read(const Value& value) noexcept
+		{
+			return value.GetFloat();
+		}
+	};
+
+	template <>
+	struct Operand<Value::Type::eBoolean>
+	{
+		static bool Read(const Value& value) noexcept
+		{
+			return value.GetBoolean();
+		}
+	};
+
+	template <typename T>
+	inline Value Make(T value, unsigned int pos) noexcept
+	{
+		if constexpr (std::is_same<T, int64_t>::value)
+			return Value::Integer(value, pos);
+		else if constexpr (std::is_same<T, bool>::value)
+			return Value::Boolean(value, pos);
+		else
+			return Value::Float(value, pos);
+	}
+
+	/*
+	Functionality: whether an operation has a kernel for a LEFT and a RIGHT operand
+	Arithmetic and ordering need numbers, equality needs two numbers or two booleans, AND/OR two booleans
+	*/
+	constexpr bool IsBinarySupported(NumOp_code op, Value::Type left, Value::Type right) noexcept
+	{
+		bool numbers = (left == Value::Type::eInteger || left == Value::Type::eFloat) && (right == Value::Type::eInteger || right == Value::Type::eFloat);
+		bool booleans = left == Value::Type::eBoolean && right == Value::Type::eBoolean;
+		if (op == eEQUAL || op == eNOT_EQUAL)
+			return numbers || booleans;
+		if (IsLogicalOp(op))
+			return booleans;
+		return numbers && op != eNOT;
+	}
+
+	constexpr bool IsUnarySupported(NumOp_code op, Value::Type expr) noexcept
+	{
+		if (op == eNOT)
+			return expr == Value::Type::eBoolean;
+		return (op == ePLUS || op == eMINUS) && (expr == Value::Type::eInteger || expr == Value::Type::eFloat);
+	}
+
+	/*
+	INTEGER arithmetic wraps around: it is done on the unsigned type of the same width, where overflow is defined.
+	FLOAT arithmetic is done as is.
+	*/
+	template <typename T>
+	using Arithmetic = typename std::conditional<std::is_same<T, int64_t>::value, uint64_t, T>::type;
+
+	template <typename T>
+	inline T Wrap(Arithmetic<T> value) noexcept
+	{
+		return static_cast<T>(value);
+	}
+
+	/*
+	Functionality: binary operation on a LEFT and a RIGHT operand, INTEGER operands are promoted when the other one is FLOAT
+	Return: result at the position of the left operand
+	*/
+	template <NumOp_code OP, Value::Type LEFT, Value::Type RIGHT>
+	Value Binary(const Value& left, const Value& right)
+	{
+		using T = typename std::conditional<LEFT == Value::Type::eBoolean, bool,
+			typename std::conditional<LEFT == Value::Type::eInteger && RIGHT == Value::Type::eInteger, int64_t, double>::type>::type;
+		T a = static_cast<T>(Operand<LEFT>::Read(left));
+		T b = static_cast<T>(Operand<RIGHT>::Read(right));
+
+		if constexpr (OP == eEQUAL)
+			return Value::Boolean(a == b, left.GetPos());
+		else if constexpr (OP == eNOT_EQUAL)
+			return Value::Boolean(a != b, left.GetPos());
+		else if constexpr (OP == eLESS)
+			return Value::Boolean(a < b, left.GetPos());
+		else if constexpr (OP == eLESS_EQUAL)
+			return Value::Boolean(a <= b, left.GetPos());
+		else if constexpr (OP == eGREATER)
+			return Value::Boolean(a > b, left.GetPos());
+		else if constexpr (OP == eGREATER_EQUAL)
+			return Value::Boolean(a >= b, left.GetPos());
+		// Both operands evaluated, the engines branch instead to skip the right one
+		else if constexpr (OP == eAND)
+			return Value::Boolean(a && b, left.GetPos());
+		else if constexpr (OP == eOR)
+			return Value::Boolean(a || b, left.GetPos());
+		else if constexpr (OP == ePLUS)
+			return Make<T>(Wrap<T>(static_cast<Arithmetic<T>>(a) + static_cast<Arithmetic<T>>(b)), left.GetPos());
+		else if constexpr (OP == eMINUS)
+			return Make<T>(Wrap<T>(static_cast<Arithmetic<T>>(a) - static_cast<Arithmetic<T>>(b)), left.GetPos());
+		else if constexpr (OP == eMULTIPLY)
+			return Make<T>(Wrap<T>(static_cast<Arithmetic<T>>(a) * static_cast<Arithmetic<T>>(b)), left.GetPos());
+		else
+		{
+			if (b == 0)
+				throw MyExceptions::MsgExecption("SyntaxError: Decimal number division by zero.");
+			if constexpr (OP == eINT_DIV && !std::is_same<T, int64_t>::value)
+				throw MyExceptions::MsgExecption("SyntaxError: integer devision applied to non-integer type.");
+			else if constexpr (std::is_same<T, int64_t>::value)
+			{
+				// The smallest INTEGER divided by -1 wraps around as well
+				if (b == -1)
+					return Make<T>(Wrap<T>(0 - static_cast<Arithmetic<T>>(a)), left.GetPos());
+				return Make<T>(a / b, left.GetPos());
+			}
+			else
+				return Make<T>(a / b, left.GetPos());
+		}
+	}
+
+	/*
+	Functionality: unary operation on a TYPE operand
+	Return: result at the position of the operand
+	*/
+	template <NumOp_code OP, Value::Type TYPE>
+	Value Unary(const Value& expr)
+	{
+		if constexpr (OP == eMINUS)
+		{
+			// Negating on the unsigned type would turn -0.0 into 0.0, only INTEGER goes through it
+			if constexpr (TYPE == Value::Type::eInteger)
+				return Make<int64_t>(Wrap<int64_t>(0 - static_cast<uint64_t>(Operand<TYPE>::Read(expr))), expr.GetPos());
+			else
+				return Make(-Operand<TYPE>::Read(expr), expr.GetPos());
+		}
+		else if constexpr (OP == eNOT)
+			return Value::Boolean(!Operand<TYPE>::Read(expr), expr.GetPos());
+		else
+			return expr;
+	}
+
+	// Kernel of an operation, or nullptr for the operand types it does not support
+	template <NumOp_code OP, Value::Type LEFT, Value::Type RIGHT>
+	constexpr BinaryKernel SelectBinary() noexcept
+	{
+		if constexpr (IsBinarySupported(OP, LEFT, RIGHT))
+			return &Binary<OP, LEFT, RIGHT>;
+		else
+			return nullptr;
+	}
+
+	template <NumOp_code OP, Value::Type TYPE>
+	constexpr UnaryKernel SelectUnary() noexcept
+	{
+		if constexpr (IsUnarySupported(OP, TYPE))
+			return &Unary<OP, TYPE>;
+		else
+			return nullptr;
+	}
+}
+
+// Number of operand types a kernel is specialized on: INTEGER, FLOAT and BOOLEAN
+constexpr unsigned int KERNEL_TYPES = 3;
+
+/*
+Functionality: row/column of an operand type in the kernel tables
+*/
+constexpr unsigned int GetKernelTypeIndex(Value::Type type) noexcept
+{
+	return static_cast<unsigned int>(type) - static_cast<unsigned int>(Value::Type::eInteger);
+}
+
+#define BINARY_KERNEL_ROW(op, left) \
+	Kernels::SelectBinary<op, left, Value::Type::eInteger>(), Kernels::SelectBinary<op, left, Value::Type::eFloat>(), \
+	Kernels::SelectBinary<op, left, Value::Type::eBoolean>()
+
+#define BINARY_KERNEL_BLOCK(op) \
+	BINARY_KERNEL_ROW(op, Value::Type::eInteger), BINARY_KERNEL_ROW(op, Value::Type::eFloat), BINARY_KERNEL_ROW(op, Value::Type::eBoolean)
+
+// Indexed by (operation code * KERNEL_TYPES + left type) * KERNEL_TYPES + right type, nullptr for unsupported operands
+constexpr std::array<BinaryKernel, (eOR + 1) * KERNEL_TYPES * KERNEL_TYPES> BINARY_KERNELS = {
+	BINARY_KERNEL_BLOCK(ePLUS),
+	BINARY_KERNEL_BLOCK(eMINUS),
+	BINARY_KERNEL_BLOCK(eMULTIPLY),
+	BINARY_KERNEL_BLOCK(eDIVIDE),
+	BINARY_KERNEL_BLOCK(eINT_DIV),
+	BINARY_KERNEL_BLOCK(eEQUAL),
+	BINARY_KERNEL_BLOCK(eNOT_EQUAL),
+	BINARY_KERNEL_BLOCK(eLESS),
+	BINARY_KERNEL_BLOCK(eLESS_EQUAL),
+	BINARY_KERNEL_BLOCK(eGREATER),
+	BINARY_KERNEL_BLOCK(eGREATER_EQUAL),
+	BINARY_KERNEL_BLOCK(eAND),
+	BINARY_KERNEL_BLOCK(eOR)
+};
+
+#undef BINARY_KERNEL_BLOCK
+#undef BINARY_KERNEL_ROW
+
+#define UNARY_KERNEL_ROW(op) \
+	Kernels::SelectUnary<op, Value::Type::eInteger>(), Kernels::SelectUnary<op, Value::Type::eFloat>(), \
+	Kernels::SelectUnary<op, Value::Type::eBoolean>()
+
+// Indexed by row (ePLUS, eMINUS, eNOT) * KERNEL_TYPES + operand type
+constexpr std::array<UnaryKernel, 3 * KERNEL_TYPES> UNARY_KERNELS = {
+	UNARY_KERNEL_ROW(ePLUS),
+	UNARY_KERNEL_ROW(eMINUS),
+	UNARY_KERNEL_ROW(eNOT)
+};
+
+#undef UNARY_KERNEL_ROW
+
+/*
+Functionality: index of the binary kernel for an operation on operands of the given types
+Return: index in BINARY_KERNELS, or BINARY_KERNELS.size() if there is none (unknown operation, unsupported operands)
+*/
+constexpr unsigned int GetBinaryKernelIndex(NumOp_code op, Value::Type left, Value::Type right) noexcept
+{
+	if (op == eUNKNOWN || op > eOR || !Kernels::IsBinarySupported(op, left, right))
+		return static_cast<unsigned int>(BINARY_KERNELS.size());
+	return (static_cast<unsigned int>(op) * KERNEL_TYPES + GetKernelTypeIndex(left)) * KERNEL_TYPES + GetKernelTypeIndex(right);
+}
+
+/*
+Functionality: index of the unary kernel for an operation on an operand of the given type
+Return: index in UNARY_KERNELS, or UNARY_KERNELS.size() if there is none
+*/
+constexpr unsigned int GetUnaryKernelIndex(NumOp_code op, Value::Type expr) noexcept
+{
+	if (!Kernels::IsUnarySupported(op, expr))
+		return static_cast<unsigned int>(UNARY_KERNELS.size());
+	unsigned int row = (op == eNOT) ? 2 : static_cast<unsigned int>(op);
+	return row * KERNEL_TYPES + GetKernelTypeIndex(expr);
+}
+
+/*
+Functionality: bind an operation to its kernel
+Return: kernel, or nullptr if there is none
+*/
+constexpr BinaryKernel GetBinaryKernel(NumOp_code op, Value::Type left, Value::Type right) noexcept
+{
+	unsigned int index = GetBinaryKernelIndex(op, left, right);
+	return (index < BINARY_KERNELS.size()) ? BINARY_KERNELS[index] : nullptr;
+}
+
+constexpr UnaryKernel GetUnaryKernel(NumOp_code op, Value::Type expr) noexcept
+{
+	unsigned int index = GetUnaryKernelIndex(op, expr);
+	return (index < UNARY_KERNELS.size()) ? UNARY_KERNELS[index] : nullptr;
+}
+
+static_assert(GetBinaryKernel(eOR, Value::Type::eBoolean, Value::Type::eBoolean) == &Kernels::Binary<eOR, Value::Type::eBoolean, Value::Type::eBoolean>, "BINARY_KERNELS layout");
+static_assert(GetUnaryKernel(eNOT, Value::Type::eBoolean) == &Kernels::Unary<eNOT, Value::Type::eBoolean>, "UNARY_KERNELS layout");
 
 class Operator
 {
@@ -16,9 +334,27 @@ public:
 	}
 
 	/*
-	Functionality: express a basic interger binary operation
-	Return: calculated result in string type
+	Functionality: express a basic interger/float/boolean binary operation, AND/OR evaluate both operands
+	Return: calculated result as an unboxed value
+	*/
+	Value exprBinaryDeciamlNumOp(const Value& left, const Value& right, PTR_TOKEN op);
+
+	/*
+	Functionality: express a basic interger/float binary operation on an already decoded operation code
+	Return: calculated result as an unboxed value
+	*/
+	Value exprBinaryDeciamlNumOp(const Value& left, const Value& right, NumOp_code op);
+
+	/*
+	Functionality: express a basic interger/float unary operation
+	Return: calculated result as an unboxed value
+	*/
+	Value exprUnaryDeciamlNumOp(const Value& expr, PTR_TOKEN op);
+
+	/*
+	Functionality: express a basic interger/float unary operation on an already decoded operation code
+	Return: calculated result as an unboxed value
 	*/
-	SHARE_TOKEN_STRING exprBinaryDeciamlNumOp(SHARE_TOKEN_STRING left, SHARE_TOKEN_STRING right, SHARE_TOKEN_STRING op);
+	Value exprUnaryDeciamlNumOp(const Value& expr, NumOp_code op);
 
 };
\ No newline at end of file
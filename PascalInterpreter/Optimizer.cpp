@@ -0,0 +1,297 @@
+#include "Optimizer.hpp"
+
+#include <cstdio>
+
+// Whether a node is a INTEGER/FLOAT/BOOLEAN literal
+static bool IsLiteral(PTR_AST node) noexcept
+{
+	return node->GetKind() == ASTKind::eToken && !node->GetLiteral().IsEmpty();
+}
+
+// Whether a node is a number literal equal to number
+static bool IsLiteralEqual(PTR_AST node, int number) noexcept
+{
+	return IsLiteral(node) && node->GetLiteral().IsNumber() && node->GetLiteral().AsFloat() == number;
+}
+
+unsigned int ASTOptimizer::OptimizeProgram(PTR_AST root)
+{
+	if (m_arena == nullptr)
+		Error("ASTError(Optimizer): no arena to allocate the folded nodes from.");
+	m_removed = 0;
+	OptimizeEntryHelper(root);
+	DEBUG_MSG("Optimizer removed nodes---> " + MyTemplates::Str(m_removed));
+	return m_removed;
+}
+
+/*
+Functionality: optimize the entry (PROGRAM, block, PROCEDURE)
+*/
+
+void ASTOptimizer::OptimizeEntryHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Optimizer): root of OptimizeEntryHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a program start
+	case ASTKind::eProgram:
+		OptimizeEntryHelper(static_cast<PTR_PROGRAM_AST>(root)->GetBlock());
+		break;
+	// Condition: is a procedure declaration
+	case ASTKind::eProcedure:
+		OptimizeEntryHelper(static_cast<PTR_PROCEDURE_AST>(root)->GetBlock());
+		break;
+	// Condition: is a block, which opens a scope
+	case ASTKind::eBlock:
+	{
+		auto block = static_cast<PTR_BLOCK_AST>(root);
+		if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(block->GetDeclaration()))
+		{
+			for (PTR_AST decal : declaration->GetAllChildren())
+			{
+				if (PTR_PROCEDURE_AST procedure = ast_cast<Procedure_AST>(decal))
+					OptimizeEntryHelper(procedure);
+			}
+		}
+		OptimizeStatementHelper(block->GetCompound());
+		break;
+	}
+	default:
+		Error("SyntaxError(Optimizer): program entry not defined");
+	}
+}
+
+/*
+Functionality: optimize a statement
+*/
+
+PTR_AST ASTOptimizer::OptimizeStatementHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Optimizer): root of OptimizeStatementHelper is null.");
+		return root;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+	{
+		auto compound = static_cast<PTR_COMPOUND_AST>(root);
+		for (size_t i = 0; i < compound->GetAllChildren().size(); i++)
+			compound->SetStatement(i, OptimizeStatementHelper(compound->GetAllChildren()[i]));
+		return root;
+	}
+	// Condition: is a empty statement
+	case ASTKind::eEmpty:
+		return root;
+	// Condition: is a assign statement
+	case ASTKind::eAssign:
+	{
+		auto assign = static_cast<PTR_ASSIGN_AST>(root);
+		assign->SetRight(OptimizeExpression(assign->GetRight()));
+		return root;
+	}
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+	{
+		auto loop = static_cast<PTR_FOR_AST>(root);
+		loop->SetBounds(OptimizeExpression(loop->GetStart()), OptimizeExpression(loop->GetEnd()));
+		loop->SetBody(OptimizeStatementHelper(loop->GetBody()));
+		return root;
+	}
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+	{
+		auto branch = static_cast<PTR_IF_AST>(root);
+		branch->SetCondition(OptimizeExpression(branch->GetCondition()));
+		branch->SetBranches(OptimizeStatementHelper(branch->GetThen()), OptimizeStatementHelper(branch->GetElse()));
+		return root;
+	}
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+	{
+		auto loop = static_cast<PTR_WHILE_AST>(root);
+		loop->SetCondition(OptimizeExpression(loop->GetCondition()));
+		loop->SetBody(OptimizeStatementHelper(loop->GetBody()));
+		return root;
+	}
+	// Condition: is a post-tested loop, its body is a compound optimized in place
+	case ASTKind::eRepeat:
+	{
+		auto loop = static_cast<PTR_REPEAT_AST>(root);
+		OptimizeStatementHelper(loop->GetBody());
+		loop->SetCondition(OptimizeExpression(loop->GetCondition()));
+		return root;
+	}
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		return root;
+	// Condition: is a bare expression
+	default:
+		return OptimizeExpression(root);
+	}
+}
+
+void ASTOptimizer::VisitProcedureCall(PTR_PROCEDURE_AST root)
+{
+	if (PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams()))
+		OptimizeStatementHelper(params);
+}
+
+PTR_AST ASTOptimizer::OptimizeExpression(PTR_AST root)
+{
+	std::vector<Operand> operands;
+	WalkExpression(root,
+		[&](PTR_AST leaf)
+		{
+			operands.push_back(VisitLeaf(leaf));
+		},
+		[&](PTR_BINARY_AST node)
+		{
+			Operand right = operands.back();
+			operands.pop_back();
+			operands.back() = VisitBinary(node, operands.back(), right);
+		},
+		[&](PTR_UNARY_AST node)
+		{
+			operands.back() = VisitUnary(node, operands.back());
+		},
+		// Both operands are always optimized, the right one may be dropped afterwards
+		[&](PTR_LOGICAL_AST) { return true; },
+		[&](PTR_LOGICAL_AST node)
+		{
+			Operand right = operands.back();
+			operands.pop_back();
+			operands.back() = VisitLogical(node, operands.back(), right);
+		});
+	return operands.back().node;
+}
+
+ASTOptimizer::Operand ASTOptimizer::VisitLeaf(PTR_AST root)
+{
+	switch (root->GetKind())
+	{
+	// Condition: is a procedure call used as a value, whose arguments are optimized as well
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		return Operand{ root, 1, Value::Type::eEmpty, false };
+	// Condition: is a literal or a variable, a variable read counts as pure even though it fails when unassigned
+	case ASTKind::eToken:
+		if (IsLiteral(root) || root->GetToken()->GetType() == ID)
+			return Operand{ root, 1, root->GetStaticType(), true };
+		return Operand{ root, 1, Value::Type::eEmpty, false };
+	// Condition: is a statement used as a value, which is always empty
+	default:
+		return Operand{ OptimizeStatementHelper(root), 1, Value::Type::eEmpty, false };
+	}
+}
+
+ASTOptimizer::Operand ASTOptimizer::VisitBinary(PTR_BINARY_AST root, const Operand& left, const Operand& right)
+{
+	root->SetOperands(left.node, right.node);
+	unsigned int size = left.size + right.size + 2;
+	auto code = GetEnumNumOp(root->GetToken()->GetType());
+	auto type = root->GetStaticType();
+	bool divides = (code == eDIVIDE || code == eINT_DIV);
+
+	// Constant folding, an operation that fails is kept so that it fails at run time as before
+	if (IsLiteral(left.node) && IsLiteral(right.node) && type != Value::Type::eEmpty && \
+		!(divides && right.node->GetLiteral().AsFloat() == 0))
+	{
+		return MakeLiteral(m_opeartor.exprBinaryDeciamlNumOp(left.node->GetLiteral(), right.node->GetLiteral(), code), size);
+	}
+
+	// Algebraic identities, only when the result keeps the type of the remaining operand
+	if (type != Value::Type::eEmpty)
+	{
+		switch (code)
+		{
+		case ePLUS:
+			// x+0 is not an identity for the FLOAT -0.0
+			if (type == Value::Type::eInteger && IsLiteralEqual(right.node, 0))
+				return Forward(left, size);
+			if (type == Value::Type::eInteger && IsLiteralEqual(left.node, 0))
+				return Forward(right, size);
+			break;
+		case eMULTIPLY:
+			if (type == left.type && IsLiteralEqual(right.node, 1))
+				return Forward(left, size);
+			if (type == right.type && IsLiteralEqual(left.node, 1))
+				return Forward(right, size);
+			// The other operand is dropped when pure, with the error of any unassigned variable it reads
+			if (type == Value::Type::eInteger && IsLiteralEqual(right.node, 0) && left.pure)
+				return Forward(right, size);
+			if (type == Value::Type::eInteger && IsLiteralEqual(left.node, 0) && right.pure)
+				return Forward(left, size);
+			break;
+		default:
+			break;
+		}
+	}
+	return Operand{ root, size, type, left.pure && right.pure && !divides && type != Value::Type::eEmpty };
+}
+
+ASTOptimizer::Operand ASTOptimizer::VisitLogical(PTR_LOGICAL_AST root, const Operand& left, const Operand& right)
+{
+	root->SetOperands(left.node, right.node);
+	unsigned int size = left.size + right.size + 2;
+
+	// A literal left operand either decides the result, or leaves it to the right operand
+	if (IsLiteral(left.node))
+		return root->IsDecidedBy(left.node->GetLiteral().GetBoolean()) ? Forward(left, size) : Forward(right, size);
+	// x AND TRUE, x OR FALSE; x AND FALSE, x OR TRUE only when x can be dropped
+	if (IsLiteral(right.node))
+	{
+		if (!root->IsDecidedBy(right.node->GetLiteral().GetBoolean()))
+			return Forward(left, size);
+		if (left.pure)
+			return Forward(right, size);
+	}
+	return Operand{ root, size, Value::Type::eBoolean, left.pure && right.pure };
+}
+
+ASTOptimizer::Operand ASTOptimizer::VisitUnary(PTR_UNARY_AST root, const Operand& expr)
+{
+	root->SetExpr(expr.node);
+	unsigned int size = expr.size + 1;
+	if (IsLiteral(expr.node))
+		return MakeLiteral(m_opeartor.exprUnaryDeciamlNumOp(expr.node->GetLiteral(), root->GetToken()), size);
+	return Operand{ root, size, root->GetStaticType(), expr.pure && expr.type != Value::Type::eEmpty };
+}
+
+ASTOptimizer::Operand ASTOptimizer::MakeLiteral(const Value& value, unsigned int replacedSize)
+{
+	// The literal keeps the position the engines report for the value, and a spelling that converts back exactly
+	char text[32];
+	TokenKind kind = FLOAT;
+	if (value.IsBoolean())
+	{
+		std::snprintf(text, sizeof(text), "%s", value.GetBoolean() ? "TRUE" : "FALSE");
+		kind = BOOLEAN;
+	}
+	else if (value.IsInteger())
+	{
+		std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(value.GetInteger()));
+		kind = INTEGER;
+	}
+	else
+		std::snprintf(text, sizeof(text), "%.17g", value.GetFloat());
+	auto token = MAKE_ARENA_TOKEN(m_arena, kind, m_arena->CopyString(text), value.GetPos());
+	m_removed += replacedSize - 1;
+	// The literal types itself from its token
+	return Operand{ MAKE_ARENA_AST(m_arena, token), 1, value.GetTypeTag(), true };
+}
+
+ASTOptimizer::Operand ASTOptimizer::Forward(const Operand& operand, unsigned int replacedSize)
+{
+	m_removed += replacedSize - operand.size;
+	return operand;
+}
@@ -0,0 +1,110 @@
+/*
+AST optimizer: constant folding and algebraic simplification
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include "Arena.hpp"
+#include "Interpreter.hpp"
+
+
+class ASTOptimizer : public NodeVisitor
+{
+public:
+	ASTOptimizer()
+		:
+		m_arena(nullptr),
+		m_removed(0)
+	{}
+	virtual ~ASTOptimizer() {};
+
+	virtual void Reset() noexcept override
+	{
+		m_arena = nullptr;
+		m_removed = 0;
+		NodeVisitor::Reset();
+	}
+
+	void SetArena(Arena* arena) noexcept
+	{
+		m_arena = arena;
+	}
+
+	/*
+	Functionality: number of AST nodes removed by the last OptimizeProgram
+	*/
+	unsigned int GetRemovedCount() const noexcept
+	{
+		return m_removed;
+	}
+
+public:
+	/*
+	Functionality: rewrite the expressions of a program checked by the semantic analyzer in place:
+	literal-only operations are folded into one literal, and x*1, 1*x, x+0, 0+x, x*0, 0*x are simplified
+	when the result keeps the type of the expression. Operations that would fail (division by zero,
+	integer division of floats) are left for the engines to report.
+	Return: number of AST nodes removed
+	*/
+	unsigned int OptimizeProgram(PTR_AST root);
+
+protected:
+	/*
+	Optimized expression on the walk stack with what the simplifications need to know about it
+	*/
+	struct Operand
+	{
+		PTR_AST node;
+		// Nodes of the subtree, an operator counts its token node as well
+		unsigned int size;
+		// Static type inferred by the semantic analyzer, eEmpty for a procedure call
+		Value::Type type;
+		// Whether it calls no procedure and divides nothing, so that it can be dropped. A read of an unassigned
+		// variable still fails, dropping it drops that error on purpose: 'a * 0' is 0 even when a is unassigned
+		bool pure;
+	};
+
+	/*
+	Functionality: optimize the entry (PROGRAM, block, PROCEDURE)
+	*/
+	virtual void OptimizeEntryHelper(PTR_AST root);
+
+	/*
+	Functionality: optimize a statement
+	Return: the statement, or the node replacing it
+	*/
+	virtual PTR_AST OptimizeStatementHelper(PTR_AST root);
+
+	/*
+	Functionality: fold and simplify an expression bottom-up without native recursion
+	Return: the expression, or the node replacing it
+	*/
+	PTR_AST OptimizeExpression(PTR_AST root);
+
+	// Leaf of an expression: literal, variable, procedure call or empty
+	Operand VisitLeaf(PTR_AST root);
+
+	// Binary/unary node whose operands have already been optimized
+	Operand VisitBinary(PTR_BINARY_AST root, const Operand& left, const Operand& right);
+
+	Operand VisitUnary(PTR_UNARY_AST root, const Operand& expr);
+
+	// AND/OR node, folded on a literal operand only when the operand it drops cannot be observed
+	Operand VisitLogical(PTR_LOGICAL_AST root, const Operand& left, const Operand& right);
+
+	void VisitProcedureCall(PTR_PROCEDURE_AST root);
+
+	// New literal node holding value, at the position the value reports
+	Operand MakeLiteral(const Value& value, unsigned int replacedSize);
+
+	// Replace a node by one of its operands
+	Operand Forward(const Operand& operand, unsigned int replacedSize);
+
+protected:
+	Operator m_opeartor;
+	Arena* m_arena;
+	unsigned int m_removed;
+};
@@ -3,15 +3,27 @@
 void Parser::Reset()
 {
 	m_lexer = nullptr;
-	m_pAST.reset();
-	m_CurrentToken.reset();
+	m_tokens.Clear();
+	m_cursor = 0;
+	m_nesting = 0;
+	m_pAST = nullptr;
+	m_CurrentToken = nullptr;
 	m_sfd = nullptr;
+	m_arena = nullptr;
 }
 
-void Parser::SetLexer(Lexer* lexer) noexcept
+void Parser::SetLexer(Lexer* lexer)
 {
 	m_lexer = lexer;
-	m_CurrentToken = m_lexer->GetNextToken();
+	m_lexer->Tokenize(m_tokens);
+	m_cursor = 0;
+	m_CurrentToken = m_tokens.Get(m_cursor);
+}
+
+void Parser::SetMaxDepth(unsigned int expressionDepth, unsigned int statementDepth) noexcept
+{
+	m_maxExpressionDepth = expressionDepth;
+	m_maxStatementDepth = statementDepth;
 }
 
 void Parser::SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
@@ -19,6 +31,11 @@ void Parser::SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
 	m_sfd = sfd;
 }
 
+void Parser::SetArena(Arena* arena) noexcept
+{
+	m_arena = arena;
+}
+
 /*
 Funtionality: helper function to throw exception with a specific message
 */
@@ -38,48 +55,46 @@ inline void Parser::ErrorSFD(const std::string& msg)
 }
 
 /*
-Functionality: Simply call GetNextToken
+Functionality: Simply move to the next token of the buffer
 Return: current token equals __EOF___
 */
 
 inline bool Parser::ConsumeToken()
 {
-	m_CurrentToken = m_lexer->GetNextToken();
+	m_CurrentToken = m_tokens.Get(++m_cursor);
 	return m_CurrentToken->GetType() != __EOF__;
 }
 
 /*
-Functionality: Simply call GetNextToken with type matching
+Functionality: Simply consume the current token with type matching
 Return: current token equals __EOF___
 */
 
-inline bool Parser::ConsumeTokenType(std::string type)
+inline bool Parser::ConsumeTokenType(TokenKind type)
 {
 
 	if (m_CurrentToken->GetType() == type)
 	{
-		m_CurrentToken = m_lexer->GetNextToken();
-		return m_CurrentToken->GetType() != __EOF__;
+		return ConsumeToken();
 	}
 	else
 	{
-		ErrorSFD("SynatxError(parser): should comsume " + type + ", instead, comsuming " + m_CurrentToken->ToString());
+		ErrorSFD("SynatxError(parser): should comsume " + std::string(GetTokenKindName(type)) + ", instead, comsuming " + m_CurrentToken->ToString());
 		return false;
 	}
 }
 
 /*
-Functionality: Simply call GetNextToken with type matching
+Functionality: Simply consume the current token with type matching
 Return: current token equals __EOF___
 */
 
-inline bool Parser::TryConsumeTokenType(std::string type)
+inline bool Parser::TryConsumeTokenType(TokenKind type)
 {
 
 	if (m_CurrentToken->GetType() == type)
 	{
-		m_CurrentToken = m_lexer->GetNextToken();
-		return m_CurrentToken->GetType() != __EOF__;
+		return ConsumeToken();
 	}
 	else
 	{
@@ -88,23 +103,42 @@ inline bool Parser::TryConsumeTokenType(std::string type)
 }
 
 /*
-Functionality: Simply call GetNextToken and return type
-Return: next token type
+Functionality: look ahead without consuming
+Return: type of the token 'offset' positions after the current one
 */
 
-inline std::string Parser::PeekNextConsumeTokenType()
+inline TokenKind Parser::PeekTokenType(unsigned int offset)
 {
+	return m_tokens.Get(m_cursor + offset)->GetType();
+}
 
-	return m_lexer->GetNextToken()->GetType();
+/*
+Functionality: remember the current position to backtrack to it later
+Return: the mark
+*/
+
+inline size_t Parser::Mark() const noexcept
+{
+	return m_cursor;
+}
+
+/*
+Functionality: backtrack to a position returned by Mark
+*/
+
+inline void Parser::Rewind(size_t mark) noexcept
+{
+	m_cursor = mark;
+	m_CurrentToken = m_tokens.Get(m_cursor);
 }
 
 /*
 program: PROGRAM variable SEMI Block DOT
 */
 
-inline SHARE_AST Parser::GetProgram()
+inline PTR_AST Parser::GetProgram()
 {
-	SHARE_AST result;
+	PTR_AST result = nullptr;
 	// Declared a prorgam name
 	if (TryConsumeTokenType(PROGRAM))
 	{
@@ -112,7 +146,7 @@ inline SHARE_AST Parser::GetProgram()
 		ConsumeTokenType(SEMI);
 		auto block = GetBlock();
 		ConsumeTokenType(DOT);
-		result = MAKE_SHARE_PROGRAM_AST(programName, block);
+		result = MAKE_ARENA_PROGRAM_AST(m_arena, programName, block);
 	}
 	// No program name declared
 	else
@@ -127,7 +161,7 @@ inline SHARE_AST Parser::GetProgram()
 program: PROCEDURE variable SEMI Block DOT
 */
 
-inline SHARE_AST Parser::GetProcedure()
+inline PTR_AST Parser::GetProcedure()
 {
 	ConsumeTokenType(PROCEDURE);
 	auto programName = GetVariable(CALL_ID);
@@ -136,27 +170,27 @@ inline SHARE_AST Parser::GetProcedure()
 
 	auto block = GetBlock();
 
-	return MAKE_SHARE_PROCEDURE_AST(programName, params, block);
+	return MAKE_ARENA_PROCEDURE_AST(m_arena, programName, params, block);
 }
 
 /*
 Block: Declaration  compound_statement
 */
 
-inline SHARE_AST Parser::GetBlock()
+inline PTR_AST Parser::GetBlock()
 {
 	auto decal = GetDeclaration();
 	auto comp = GetCompoundStatements();
-	return MAKE_SHARE_BLOCK_AST(decal, comp);
+	return MAKE_ARENA_BLOCK_AST(m_arena, decal, comp);
 }
 
 /*
 Declaration: Empty | (variable_declaration SEMI+ variable_declaration)
 */
 
-inline SHARE_AST Parser::GetParamsDecal()
+inline PTR_AST Parser::GetParamsDecal()
 {
-	CREATE_SHARE_DECLARATION_AST(results);
+	CREATE_ARENA_DECLARATION_AST(m_arena, results);
 	ConsumeTokenType(LEFT_PARATHESES);
 	while (m_CurrentToken->GetType() == ID)
 	{
@@ -174,15 +208,15 @@ inline SHARE_AST Parser::GetParamsDecal()
 Assignment: Empty | (assignment_statement ,+assignment_statement)
 */
 
-inline SHARE_AST Parser::GetParamsAssigment()
+inline PTR_AST Parser::GetParamsAssigment()
 {
 	ConsumeTokenType(LEFT_PARATHESES);
 
-	SHARE_AST result = GetStatement();
-	std::vector<SHARE_AST> result_list;
+	PTR_AST result = GetStatement();
+	std::vector<PTR_AST> result_list;
 	result_list.push_back(result);
 
-	if (dynamic_pointer_cast<Empty_AST>(result))
+	if (ast_cast<Empty_AST>(result))
 	{
 		ConsumeTokenType(RIGHT_PARATHESES);
 		return GetEmpty();
@@ -196,7 +230,7 @@ inline SHARE_AST Parser::GetParamsAssigment()
 		}
 		ConsumeTokenType(RIGHT_PARATHESES);
 
-		CREATE_SHARE_COMPOUND_AST(root);
+		CREATE_ARENA_COMPOUND_AST(m_arena, root);
 		for (auto& r : result_list)
 		{
 			root->AddStatements(r);
@@ -209,9 +243,9 @@ inline SHARE_AST Parser::GetParamsAssigment()
 Declaration: Empty | VAR(variable_declaration SEMI)+ | PROCEDURE(parameter_declaration) SEMI+
 */
 
-inline SHARE_AST Parser::GetDeclaration()
+inline PTR_AST Parser::GetDeclaration()
 {
-	CREATE_SHARE_DECLARATION_AST(results);
+	CREATE_ARENA_DECLARATION_AST(m_arena, results);
 	if (TryConsumeTokenType(VAR))
 	{
 		while (m_CurrentToken->GetType() == ID)
@@ -233,10 +267,10 @@ inline SHARE_AST Parser::GetDeclaration()
 variable declaration: ID (COMMA ID)* COLON type_spec
 */
 
-inline SHARE_AST Parser::GetVariableDeclaration()
+inline PTR_AST Parser::GetVariableDeclaration()
 {
-	CREATE_SHARE_DECLCONTAINER_AST(temp);
-	CREATE_SHARE_DECLCONTAINER_AST(results);
+	CREATE_ARENA_DECLCONTAINER_AST(m_arena, temp);
+	CREATE_ARENA_DECLCONTAINER_AST(m_arena, results);
 	temp->AddItem(GetVariable());
 	while (TryConsumeTokenType(COMMA))
 	{
@@ -247,7 +281,7 @@ inline SHARE_AST Parser::GetVariableDeclaration()
 	// Add VarDecal(var, type) pair into Decal Container
 	for (auto& item : temp->GetAllChildren())
 	{
-		results->AddItem(MAKE_SHARE_VARDECL_AST(item, type));
+		results->AddItem(MAKE_ARENA_VARDECL_AST(m_arena, item, type));
 	}
 	return results;
 }
@@ -256,24 +290,24 @@ inline SHARE_AST Parser::GetVariableDeclaration()
 return type token
 */
 
-inline SHARE_AST Parser::GetTypeSpec()
+inline PTR_AST Parser::GetTypeSpec()
 {
 	auto token = m_CurrentToken;
 	ConsumeTokenType(TYPE);
-	return MAKE_SHARE_AST(token);
+	return MAKE_ARENA_AST(m_arena, token);
 }
 
 /*
 compound_statement: BEGIN statement_list END
 */
 
-inline SHARE_AST Parser::GetCompoundStatements()
+inline PTR_AST Parser::GetCompoundStatements()
 {
 	ConsumeTokenType(BEGIN);
 	auto results = GetStatementsList();
 	ConsumeTokenType(END);
 
-	CREATE_SHARE_COMPOUND_AST(root);
+	CREATE_ARENA_COMPOUND_AST(m_arena, root);
 	for (auto& r : results)
 	{
 		root->AddStatements(r);
@@ -286,13 +320,13 @@ statement_list : statement
 | statement SEMI statement_list
 */
 
-inline vector<SHARE_AST> Parser::GetStatementsList()
+inline vector<PTR_AST> Parser::GetStatementsList()
 {
-	SHARE_AST result = GetStatement();
-	std::vector<SHARE_AST> result_list;
+	PTR_AST result = GetStatement();
+	std::vector<PTR_AST> result_list;
 	result_list.push_back(result);
 
-	while (!dynamic_pointer_cast<Empty_AST>(result))
+	while (!ast_cast<Empty_AST>(result))
 	{
 		ConsumeTokenType(SEMI);
 		result = GetStatement();
@@ -304,152 +338,291 @@ inline vector<SHARE_AST> Parser::GetStatementsList()
 /*
 statement : compound_statement
 | assignment_statement
+| for_statement
+| if_statement
+| while_statement
+| repeat_statement
 | empty
 */
 
-inline SHARE_AST Parser::GetStatement()
+inline PTR_AST Parser::GetStatement()
 {
+	// Statements are the only recursive productions left (blocks and call arguments), bound their depth
+	if (++m_nesting > m_maxStatementDepth)
+		ErrorSFD("SynatxError(parser): statements are nested deeper than the limit of " + MyTemplates::Str(m_maxStatementDepth) + ".");
+
+	PTR_AST result = nullptr;
 	auto token = m_CurrentToken;
 	if (token->GetType() == BEGIN)
 	{
-		return GetCompoundStatements();
+		result = GetCompoundStatements();
 	}
 	else if (token->GetType() == ID)
 	{
-		return GetAssignStatement();
+		result = GetAssignStatement();
+	}
+	else if (token->GetType() == FOR)
+	{
+		result = GetForStatement();
+	}
+	else if (token->GetType() == IF)
+	{
+		result = GetIfStatement();
+	}
+	else if (token->GetType() == WHILE)
+	{
+		result = GetWhileStatement();
+	}
+	else if (token->GetType() == REPEAT)
+	{
+		result = GetRepeatStatement();
 	}
 	else
 	{
-		return GetExpr();
+		result = GetExpr();
 	}
+	m_nesting--;
+	return result;
 }
 
 /*
 assignment_statement : variable ASSIGN expr
 */
 
-inline SHARE_AST Parser::GetAssignStatement()
+inline PTR_AST Parser::GetAssignStatement()
 {
 	auto left = GetVariable();
-	auto op = MAKE_SHARE_AST(m_CurrentToken);
+	auto op = MAKE_ARENA_AST(m_arena, m_CurrentToken);
 	ConsumeTokenType(ASSIGN);
 	auto right = GetExpr();
-	return MAKE_SHARE_ASSIGN_AST(left, right, op);
+	return MAKE_ARENA_ASSIGN_AST(m_arena, left, right, op);
+}
+
+/*
+for_statement : FOR variable ASSIGN expr (TO | DOWNTO) expr DO statement
+*/
+
+inline PTR_AST Parser::GetForStatement()
+{
+	ConsumeTokenType(FOR);
+	auto var = GetVariable();
+	ConsumeTokenType(ASSIGN);
+	auto start = GetExpr();
+	auto direction = MAKE_ARENA_AST(m_arena, m_CurrentToken);
+	ConsumeTokenType((m_CurrentToken->GetType() == DOWNTO) ? DOWNTO : TO);
+	auto end = GetExpr();
+	ConsumeTokenType(DO);
+	auto body = GetStatement();
+	return MAKE_ARENA_FOR_AST(m_arena, var, start, end, body, direction);
+}
+
+/*
+if_statement : IF expr THEN statement (ELSE statement)?
+*/
+
+inline PTR_AST Parser::GetIfStatement()
+{
+	auto op = MAKE_ARENA_AST(m_arena, m_CurrentToken);
+	ConsumeTokenType(IF);
+	auto condition = GetExpr();
+	ConsumeTokenType(THEN);
+	auto then = GetStatement();
+	// A dangling ELSE belongs to the innermost IF
+	PTR_AST otherwise = nullptr;
+	if (m_CurrentToken->GetType() == ELSE)
+	{
+		ConsumeTokenType(ELSE);
+		otherwise = GetStatement();
+	}
+	else
+	{
+		otherwise = GetEmpty();
+	}
+	return MAKE_ARENA_IF_AST(m_arena, condition, then, otherwise, op);
+}
+
+/*
+while_statement : WHILE expr DO statement
+*/
+
+inline PTR_AST Parser::GetWhileStatement()
+{
+	auto op = MAKE_ARENA_AST(m_arena, m_CurrentToken);
+	ConsumeTokenType(WHILE);
+	auto condition = GetExpr();
+	ConsumeTokenType(DO);
+	auto body = GetStatement();
+	return MAKE_ARENA_WHILE_AST(m_arena, condition, body, op);
+}
+
+/*
+repeat_statement : REPEAT statement_list UNTIL expr
+*/
+
+inline PTR_AST Parser::GetRepeatStatement()
+{
+	ConsumeTokenType(REPEAT);
+	auto results = GetStatementsList();
+	CREATE_ARENA_COMPOUND_AST(m_arena, body);
+	for (auto& r : results)
+	{
+		body->AddStatements(r);
+	}
+	auto op = MAKE_ARENA_AST(m_arena, m_CurrentToken);
+	ConsumeTokenType(UNTIL);
+	auto condition = GetExpr();
+	return MAKE_ARENA_REPEAT_AST(m_arena, body, condition, op);
 }
 
 /*
 variable : ID
 */
 
-inline SHARE_AST Parser::GetVariable(std::string type)
+inline PTR_AST Parser::GetVariable(TokenKind type)
 {
 	auto token = m_CurrentToken;
 	ConsumeTokenType(type);
-	return MAKE_SHARE_AST(token);
+	return MAKE_ARENA_AST(m_arena, token);
 }
 
 /*
 An empty production
 */
 
-inline SHARE_AST Parser::GetEmpty()
+inline PTR_AST Parser::GetEmpty()
 {
-	return MAKE_SHARE_EMPTY_AST();
+	return MAKE_ARENA_EMPTY_AST(m_arena);
 }
 
 /*
-factor : PLUS  factor
-| MINUS factor
-| INTEGER
-| LPAREN expr RPAREN
+factor : INTEGER
+| FLOAT
+| BOOLEAN
 | variable
+| call
+| empty
+Unary operators and parentheses are handled by GetExpr
 */
 
-inline SHARE_AST Parser::GetFactor()
+inline PTR_AST Parser::GetFactor()
 {
 	auto token = m_CurrentToken;
-	// Handle integer
-	if (token->GetType() == token_code_factor[0] || token->GetType() == token_code_factor[6])
-	{
-		ConsumeTokenType(token->GetType());
-		return MAKE_SHARE_AST(token);
-	}
-	// Handle paratheses
-	else if (token->GetType() == token_code_factor[1])
-	{
-		ConsumeTokenType(token_code_factor[1]);
-		auto result = GetExpr();
-		m_pAST = result;
-		ConsumeTokenType(token_code_factor[2]);
-		return result;
-	}
-	// Handle unary operator
-	else if (token->GetType() == token_code_factor[3] || token->GetType() == token_code_factor[4])
+	// Handle integer, float and boolean literals
+	if (token->GetType() == INTEGER || token->GetType() == FLOAT || token->GetType() == BOOLEAN)
 	{
 		ConsumeTokenType(token->GetType());
-		CREATE_SHARE_UNARY_AST(result, token, GetFactor());
-		m_pAST = result;
-		return result;
+		return MAKE_ARENA_AST(m_arena, token);
 	}
 	// Handle variable
-	else if (token->GetType() == token_code_factor[5])
+	else if (token->GetType() == ID)
 	{
 		return GetVariable();
 	}
 	// Handle call
-	else if (token->GetType() == token_code_factor[7])
+	else if (token->GetType() == CALL_ID)
 	{
 		auto name = GetVariable(CALL_ID);
 		auto result = GetParamsAssigment();
-		return MAKE_SHARE_PROCEDURE_AST(name, result, GetEmpty());
+		return MAKE_ARENA_PROCEDURE_AST(m_arena, name, result, GetEmpty());
 	}
 	else
 	{
-		//ErrorSFD("SynatxError(parser): unknown factor: " + token->GetType() + ".");
+		//ErrorSFD("SynatxError(parser): unknown factor: " + token->GetTypeName() + ".");
 		return GetEmpty();
 	}
 }
 
 /*
-2nd level of the Int Op expression, middle precedence:
-Handles integer mul/div
+expr : (PLUS | MINUS | NOT | LPAREN)* factor (RPAREN)* (binary_operator expr)*
+Precedence climbing over BINARY_OPERATORS without native recursion: operands and pending operators
+live on heap stacks, so the nesting depth is only bounded by m_maxExpressionDepth
 */
 
-inline SHARE_AST Parser::GetTerm()
+inline PTR_AST Parser::GetExpr()
 {
-	auto result = GetFactor();
-	m_pAST = result;
-
-	while (ITEM_IN_VEC(m_CurrentToken->GetType(), token_code_term))
+	// Pending operator: a prefix PLUS/MINUS/NOT, an open LEFT_PARATHESES or a binary operator
+	struct PendingOperator
 	{
-		auto token = m_CurrentToken;
+		PTR_TOKEN token;
+		unsigned char power;
+		bool binary;
+	};
+	std::vector<PTR_AST> operands;
+	std::vector<PendingOperator> operators;
+	unsigned int openParentheses = 0;
+
+	auto push = [&](PTR_TOKEN token, unsigned char power, bool binary)
+	{
+		if (operators.size() >= m_maxExpressionDepth)
+			ErrorSFD("SynatxError(parser): expression is nested deeper than the limit of " + MyTemplates::Str(m_maxExpressionDepth) + ".");
+		operators.push_back(PendingOperator{ token, power, binary });
 		ConsumeTokenType(token->GetType());
-		auto temp = GetFactor();
-		result = MAKE_SHARE_BINARY_AST(result, temp, MAKE_SHARE_AST(token));
-		m_pAST = result;
-	}
-	return result;
-}
+	};
+	auto reduce = [&]()
+	{
+		PendingOperator op = operators.back();
+		operators.pop_back();
+		if (op.binary)
+		{
+			auto right = operands.back();
+			operands.pop_back();
+			// AND/OR get their own node so that the engines can skip the right operand
+			if (op.token->GetType() == AND || op.token->GetType() == OR)
+				operands.back() = MAKE_ARENA_LOGICAL_AST(m_arena, operands.back(), right, MAKE_ARENA_AST(m_arena, op.token));
+			else
+				operands.back() = MAKE_ARENA_BINARY_AST(m_arena, operands.back(), right, MAKE_ARENA_AST(m_arena, op.token));
+		}
+		else
+		{
+			operands.back() = MAKE_ARENA_UNARY_AST(m_arena, op.token, operands.back());
+		}
+	};
 
-/*
-3rd level of the Int Op expression, lowest precedence:
-Handles integer plus/minus
-*/
+	while (true)
+	{
+		// Prefix position: unary operators and open parentheses, then one factor
+		while (m_CurrentToken->GetType() == PLUS || m_CurrentToken->GetType() == MINUS || m_CurrentToken->GetType() == NOT || \
+			m_CurrentToken->GetType() == LEFT_PARATHESES)
+		{
+			if (m_CurrentToken->GetType() == LEFT_PARATHESES)
+				openParentheses++;
+			push(m_CurrentToken, 0, false);
+		}
+		operands.push_back(GetFactor());
 
-inline SHARE_AST Parser::GetExpr()
-{
-	auto result = GetTerm();
-	m_pAST = result;
+		// Infix position: close parentheses opened by this expression
+		while (openParentheses > 0 && m_CurrentToken->GetType() == RIGHT_PARATHESES)
+		{
+			while (operators.back().token->GetType() != LEFT_PARATHESES)
+				reduce();
+			operators.pop_back();
+			openParentheses--;
+			ConsumeTokenType(RIGHT_PARATHESES);
+		}
 
-	while (ITEM_IN_VEC(m_CurrentToken->GetType(), token_code_expr))
-	{
+		// Then a binary operator, or the end of the expression
 		auto token = m_CurrentToken;
-		ConsumeTokenType(token->GetType());
-		auto temp = GetTerm();
-		result = MAKE_SHARE_BINARY_AST(result, temp, MAKE_SHARE_AST(token));
-		m_pAST = result;
+		const BinaryOperatorInfo& info = BINARY_OPERATORS[token->GetType()];
+		if (info.power == 0)
+			break;
+		// Reduce what binds at least as tight: prefix operators always do, a right associative operator waits on its own level
+		while (!operators.empty() && operators.back().token->GetType() != LEFT_PARATHESES &&
+			(!operators.back().binary || operators.back().power > info.power || (operators.back().power == info.power && !info.rightAssociative)))
+		{
+			reduce();
+		}
+		push(token, info.power, true);
 	}
-	return result;
+
+	while (!operators.empty())
+	{
+		// An unclosed parenthesis reports the token found instead of RIGHT_PARATHESES
+		if (operators.back().token->GetType() == LEFT_PARATHESES)
+			ConsumeTokenType(RIGHT_PARATHESES);
+		reduce();
+	}
+	m_pAST = operands.back();
+	return m_pAST;
 }
 
 /*
@@ -457,7 +630,7 @@ Functionality: parse the input text (should be a program format) into AST
 Return: pointer constant to the AST instance
 */
 
-SHARE_AST Parser::GetProgramAST()
+PTR_AST Parser::GetProgramAST()
 {
 	m_pAST = GetProgram();
 	return m_pAST;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -11,24 +12,69 @@
 #include "Lexer.hpp"
 #include "AST.hpp"
 
+/*
+Binary operator table of the precedence climbing expression parser.
+A token kind with a binding power of 0 is not a binary operator; higher powers bind tighter.
+Adding an operator or a precedence level is one entry here, the parser itself does not change.
+*/
+struct BinaryOperatorInfo
+{
+	unsigned char power;
+	bool rightAssociative;
+};
+
+constexpr std::array<BinaryOperatorInfo, __EOF__ + 1> BuildBinaryOperatorTable() noexcept
+{
+	std::array<BinaryOperatorInfo, __EOF__ + 1> table = {};
+	// Pascal levels: relational < additive (OR) < multiplicative (AND), so 'a < b AND c' needs parentheses
+	table[EQUAL] = { 5, false };
+	table[NOT_EQUAL] = { 5, false };
+	table[LESS] = { 5, false };
+	table[LESS_EQUAL] = { 5, false };
+	table[GREATER] = { 5, false };
+	table[GREATER_EQUAL] = { 5, false };
+	table[PLUS] = { 10, false };
+	table[MINUS] = { 10, false };
+	table[OR] = { 10, false };
+	table[MUL] = { 20, false };
+	table[DIV] = { 20, false };
+	table[INT_DIV] = { 20, false };
+	table[AND] = { 20, false };
+	return table;
+}
+
+constexpr std::array<BinaryOperatorInfo, __EOF__ + 1> BINARY_OPERATORS = BuildBinaryOperatorTable();
+
 class Parser
 {
 public:
 	Parser()
 		:
 		m_lexer(nullptr),
-		m_pAST(nullptr),
+		m_cursor(0),
 		m_CurrentToken(nullptr),
-		m_sfd(nullptr)
+		m_pAST(nullptr),
+		m_nesting(0),
+		m_maxExpressionDepth(MAX_EXPRESSION_DEPTH),
+		m_maxStatementDepth(MAX_STATEMENT_DEPTH),
+		m_sfd(nullptr),
+		m_arena(nullptr)
 	{}
 		
 	virtual ~Parser() {};
 	void Reset();
 
-	void SetLexer(Lexer* lexer) noexcept;
+	// Lexes the whole text into the token buffer, so lexing errors are raised here
+	void SetLexer(Lexer* lexer);
 
 	void SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept;
 
+	// Depth limits turning pathological nesting into a diagnostic instead of a crash
+	void SetMaxDepth(unsigned int expressionDepth, unsigned int statementDepth) noexcept;
+
+	// AST nodes are allocated in the arena of the compilation unit, which must outlive the tree
+	void SetArena(Arena* arena) noexcept;
+
 protected:
 	/*
 	Funtionality: helper function to throw exception with a specific message
@@ -41,104 +87,130 @@ protected:
 	inline void ErrorSFD(const std::string& msg);
 
 	/*
-	Functionality: Simply call GetNextToken
+	Functionality: Simply move to the next token of the buffer
 	Return: current token equals __EOF___
 	*/
 	bool ConsumeToken();
 	/*
-	Functionality: Simply call GetNextToken with type matching
+	Functionality: Simply consume the current token with type matching
 	Return: current token equals __EOF___
 	*/
-	bool ConsumeTokenType(std::string type);
+	bool ConsumeTokenType(TokenKind type);
 	/*
-	Functionality: Simply call GetNextToken with type matching
+	Functionality: Simply consume the current token with type matching
 	Return: current token equals __EOF___
 	*/
-	bool TryConsumeTokenType(std::string type);
+	bool TryConsumeTokenType(TokenKind type);
 	/*
-	Functionality: Simply call GetNextToken and return type
-	Return: next token type
+	Functionality: look ahead without consuming
+	Return: type of the token 'offset' positions after the current one
 	*/
-	std::string PeekNextConsumeTokenType();
+	TokenKind PeekTokenType(unsigned int offset = 1);
+	/*
+	Functionality: remember the current position to backtrack to it later
+	Return: the mark
+	*/
+	size_t Mark() const noexcept;
+	/*
+	Functionality: backtrack to a position returned by Mark
+	*/
+	void Rewind(size_t mark) noexcept;
 protected:
 	/*
 		program: PROGRAM variable SEMI Block DOT
 	*/
-	SHARE_AST GetProgram();
+	PTR_AST GetProgram();
 	/*
 		program: PROCEDURE variable SEMI Block DOT
 	*/
-	SHARE_AST GetProcedure();
+	PTR_AST GetProcedure();
 	/*
 		Block: Declaration  compound_statement
 	*/
-	SHARE_AST GetBlock();
+	PTR_AST GetBlock();
 	/*
 	Declaration: Empty | (variable_declaration SEMI+ variable_declaration)
 	*/
-	SHARE_AST GetParamsDecal();
+	PTR_AST GetParamsDecal();
 	/*
 	Assignment: Empty | (assignment_statement ,+assignment_statement)
 	*/
-	SHARE_AST GetParamsAssigment();
+	PTR_AST GetParamsAssigment();
 
 	/*
 		Declaration: Empty | VAR(variable_declaration SEMI)+ | PROCEDURE(parameter_declaration) SEMI+
 	*/
-	SHARE_AST GetDeclaration();
+	PTR_AST GetDeclaration();
 	/*
 	variable declaration: ID (COMMA ID)* COLON type_spec
 	*/
-	SHARE_AST GetVariableDeclaration();
+	PTR_AST GetVariableDeclaration();
 	/*
 	return type token
 	*/
-	SHARE_AST GetTypeSpec();
+	PTR_AST GetTypeSpec();
 	/*
 		compound_statement: BEGIN statement_list END
 	*/
-	SHARE_AST GetCompoundStatements();
+	PTR_AST GetCompoundStatements();
 	/*
 		statement_list : statement
                    | statement SEMI statement_list
 	*/
-	vector<SHARE_AST> GetStatementsList();
+	vector<PTR_AST> GetStatementsList();
 	/*
 		statement : compound_statement
               | assignment_statement
+              | for_statement
+              | if_statement
+              | while_statement
+              | repeat_statement
               | empty
 	*/
-	SHARE_AST GetStatement();
+	PTR_AST GetStatement();
 	/*
 		assignment_statement : variable ASSIGN expr
 	*/
-	SHARE_AST GetAssignStatement();
+	PTR_AST GetAssignStatement();
+	/*
+		for_statement : FOR variable ASSIGN expr (TO | DOWNTO) expr DO statement
+	*/
+	PTR_AST GetForStatement();
+	/*
+		if_statement : IF expr THEN statement (ELSE statement)?
+	*/
+	PTR_AST GetIfStatement();
+	/*
+		while_statement : WHILE expr DO statement
+	*/
+	PTR_AST GetWhileStatement();
+	/*
+		repeat_statement : REPEAT statement_list UNTIL expr
+	*/
+	PTR_AST GetRepeatStatement();
 	/*
 		variable : ID
 	*/
-	SHARE_AST GetVariable(std::string type = ID);
+	PTR_AST GetVariable(TokenKind type = ID);
 	/*
 		An empty production
 	*/
-	SHARE_AST GetEmpty();
+	PTR_AST GetEmpty();
 	/*
-		factor : PLUS  factor
-              | MINUS factor
-              | INTEGER
-              | LPAREN expr RPAREN
+		factor : INTEGER
+              | FLOAT
+              | BOOLEAN
               | variable
+              | call
+              | empty
 	*/
-	SHARE_AST GetFactor();
-	/*
-		2nd level of the Int Op expression, middle precedence:
-		Handles integer mul/div
-	*/
-	SHARE_AST GetTerm();
+	PTR_AST GetFactor();
 	/*
-		3rd level of the Int Op expression, lowest precedence:
-		Handles integer plus/minus
+		expr : (PLUS | MINUS | NOT | LPAREN)* factor (RPAREN)* (binary_operator expr)*
+		Precedence climbing over BINARY_OPERATORS with explicit operand/operator stacks instead of recursion,
+		so deeply nested or very long expressions cannot overflow the native stack.
 	*/
-	SHARE_AST GetExpr();
+	PTR_AST GetExpr();
 
 public:
 
@@ -146,16 +218,20 @@ public:
 	Functionality: parse the input text (should be a program format) into AST
 	Return: pointer constant to the AST instance
 	*/
-	SHARE_AST GetProgramAST();
+	PTR_AST GetProgramAST();
 
 private:
 	Lexer* m_lexer;
-	SHARE_TOKEN_STRING m_CurrentToken;
-	SHARE_AST m_pAST;
-	std::vector<std::string> token_code_factor = { INTEGER, LEFT_PARATHESES, RIGHT_PARATHESES, PLUS, MINUS , ID, FLOAT,CALL_ID };
-	std::vector<std::string> token_code_term = { MUL, DIV, INT_DIV };
-	std::vector<std::string> token_code_expr = { PLUS, MINUS };
+	// Every token of the file, lexed up front by SetLexer
+	TokenBuffer m_tokens;
+	size_t m_cursor;
+	PTR_TOKEN m_CurrentToken;
+	PTR_AST m_pAST;
+	unsigned int m_nesting;
+	unsigned int m_maxExpressionDepth;
+	unsigned int m_maxStatementDepth;
 
 	MyDebug::SrouceFileDebugger* m_sfd;
+	Arena* m_arena;
 };
 
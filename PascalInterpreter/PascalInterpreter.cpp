@@ -8,7 +8,8 @@
 
 #include <stdio.h>
 #include <iostream>
-#include <fstream>
+#include <sstream>
+#include <filesystem>
 
 #include "MonoHeader.hpp"
 
@@ -17,69 +18,198 @@ int main()
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
 	std::string filename;
+	std::string input;
+	std::string engine;
 	std::string PWD = R"(C:\Users\yohan\source\repos\PascalInterpreter\)";
 
 	
 	while (true)
 	{
 		std::cout << PWD << "> ";
-		if (std::getline(std::cin, filename))
+		// Input: filename [engine], engine is 'ast' (tree walker, default), 'vm' (bytecode virtual machine),
+		// 'vm-profile' (bytecode virtual machine without superinstructions, printing its op code pairs),
+		// 'reg' (register virtual machine, direct-threaded), 'reg-switch' (register virtual machine, switch dispatch)
+		// 'closure' (closures compiled from the AST) or 'c' (C translation built by the system C compiler and run natively)
+		if (std::getline(std::cin, input))
 		{
+			filename = "";
+			engine = "ast";
+			std::istringstream(input) >> filename >> engine;
 			if (filename != "")
 			{
 				try
 				{
-					std::vector<std::string> src_file_vec;
-					std::string src_file_oneliner;
-					std::string LINE;
-					std::ifstream infile(PWD + filename + ".txt");
-					if (!infile)
+					// Map the source read-only, the lexer produces tokens as views into it
+					MappedFile source;
+					if (!source.Open(PWD + filename + ".txt"))
 					{
 						std::cout << "'" << filename << "'" << " does not exist in the currenty working directory. Input a existed .txt file instead." << std::endl;
 						continue;
 					}
+					std::string_view src_file_view = source.GetView();
 
-					while (getline(infile, LINE)) // To get you all the lines.
+					// Define SFD
+					auto sfd = MyDebug::SrouceFileDebugger(filename + ".txt", src_file_view);
+					for (unsigned int line = 0; line < sfd.GetLineCount(); line++)
+						std::cout << sfd.GetLine(line) << std::endl; // Prints our STRING.
+
+					// Define arena, it owns every token and AST node of this compilation unit
+					Arena arena;
+
+					// Reuse the checked tree of an unchanged source, its tokens are views into the mapped cache file
+					ASTCache cache;
+					std::string cache_path = PWD + filename + ".pasc";
+					PTR_AST root_tree = cache.Load(cache_path, src_file_view, &arena);
+
+					if (root_tree != nullptr)
 					{
-						std::cout << LINE << std::endl; // Prints our STRING.
-						src_file_oneliner += LINE + "\n";
-						src_file_vec.push_back(LINE);
+						std::cout << "Semantic Analyzer-----------------------------------------" << std::endl;
 					}
-					infile.close();
+					else
+					{
+						// Define lexer
+						auto lexer = Lexer();
+						lexer.Reset();
+						lexer.SetText(src_file_view);
+						lexer.SetSFD(&sfd);
+						lexer.SetArena(&arena);
 
-					// Define SFD
-					auto sfd = MyDebug::SrouceFileDebugger(filename + ".txt", src_file_oneliner, src_file_vec);
-
-					// Define lexer
-					auto lexer = Lexer();
-					lexer.Reset();
-					lexer.SetText(sfd.GetOneliner());
-					lexer.SetSFD(&sfd);
-
-					// Define parser
-					auto parser = Parser();
-					parser.Reset();
-					parser.SetLexer(&lexer);
-					parser.SetSFD(&sfd);
-					auto root_tree = parser.GetProgramAST();
-
-					std::cout << "Semantic Analyzer-----------------------------------------" << std::endl;
-
-					// Define semantic analyzer
-					auto SA = SemanticAnalyzer();
-					SA.Reset();
-					SA.SetSFD(&sfd);
-					SA.InterpretProgram(root_tree);
-
-					std::cout << "Interpreter-----------------------------------------------" << std::endl;
-
-					// Define interpreter
-					auto inter = Interpreter();
-					inter.Reset();
-					inter.SetSFD(&sfd);
-					inter.InterpretProgram(root_tree);
-					inter.PrintAllSymbolTable();
-					inter.PrintAllMemoryTable();
+						// Define parser
+						auto parser = Parser();
+						parser.Reset();
+						parser.SetSFD(&sfd);
+						parser.SetArena(&arena);
+						parser.SetLexer(&lexer);
+						root_tree = parser.GetProgramAST();
+
+						std::cout << "Semantic Analyzer-----------------------------------------" << std::endl;
+
+						// Define semantic analyzer
+						auto SA = SemanticAnalyzer();
+						SA.Reset();
+						SA.SetSFD(&sfd);
+						SA.InterpretProgram(root_tree);
+
+						// Define optimizer, the folded tree is the one cached
+						auto optimizer = ASTOptimizer();
+						optimizer.Reset();
+						optimizer.SetSFD(&sfd);
+						optimizer.SetArena(&arena);
+						std::cout << "Optimizer removed " << optimizer.OptimizeProgram(root_tree) << " nodes." << std::endl;
+
+						cache.Store(cache_path, src_file_view, root_tree);
+					}
+
+					if (engine == "vm" || engine == "vm-profile")
+					{
+						std::cout << "Virtual Machine-------------------------------------------" << std::endl;
+
+						// Define bytecode compiler
+						auto program = BytecodeProgram();
+						auto compiler = BytecodeCompiler();
+						compiler.Reset();
+						compiler.SetSFD(&sfd);
+						compiler.SetSuperinstructions(engine != "vm-profile");
+						compiler.CompileProgram(root_tree, program);
+
+						// Define virtual machine
+						auto vm = VirtualMachine();
+						vm.Reset();
+						vm.SetSFD(&sfd);
+						vm.SetProfile(engine == "vm-profile");
+						vm.Run(program);
+						vm.PrintAllSymbolTable();
+						vm.PrintAllMemoryTable();
+						if (engine == "vm-profile")
+							vm.PrintOpCodePairs(16);
+					}
+					else if (engine == "reg" || engine == "reg-switch")
+					{
+						std::cout << "Register Machine------------------------------------------" << std::endl;
+
+						// Define register compiler
+						auto program = RegisterProgram();
+						auto compiler = RegisterCompiler();
+						compiler.Reset();
+						compiler.SetSFD(&sfd);
+						compiler.CompileProgram(root_tree, program);
+
+						// Define register machine
+						auto machine = RegisterMachine();
+						machine.Reset();
+						machine.SetSFD(&sfd);
+						machine.Run(program, (engine == "reg") ? RegisterMachine::Dispatch::eThreaded : RegisterMachine::Dispatch::eSwitch);
+						machine.PrintAllSymbolTable();
+						machine.PrintAllMemoryTable();
+					}
+					else if (engine == "closure")
+					{
+						std::cout << "Closure Compiler------------------------------------------" << std::endl;
+
+						// Define closure compiler
+						auto program = ClosureProgram();
+						auto compiler = ClosureCompiler();
+						compiler.Reset();
+						compiler.SetSFD(&sfd);
+						compiler.CompileProgram(root_tree, program);
+
+						// Define closure machine
+						auto machine = ClosureMachine();
+						machine.Reset();
+						machine.SetSFD(&sfd);
+						machine.Run(program);
+						machine.PrintAllSymbolTable();
+						machine.PrintAllMemoryTable();
+					}
+					else if (engine == "c")
+					{
+						std::cout << "C Backend-------------------------------------------------" << std::endl;
+
+						// Define C backend, the C source and the executable are built in the temporary directory
+						auto backend = CBackend();
+						backend.Reset();
+						backend.SetSFD(&sfd);
+						auto build_dir = std::filesystem::temp_directory_path() / "PascalInterpreter";
+						std::filesystem::create_directories(build_dir);
+						std::string c_path = (build_dir / (filename + ".c")).string();
+#ifdef _WIN32
+						std::string executable_path = (build_dir / (filename + ".exe")).string();
+#else
+						std::string executable_path = (build_dir / filename).string();
+#endif
+						backend.Save(c_path, backend.GenerateProgram(root_tree));
+						std::cout << "C source: " << c_path << std::endl;
+						backend.Build(c_path, executable_path);
+						// The C source is kept to be read, the executable is only run once
+						try
+						{
+							backend.Run(executable_path);
+						}
+						catch (...)
+						{
+							std::filesystem::remove(executable_path);
+							throw;
+						}
+						std::filesystem::remove(executable_path);
+						backend.PrintAllSymbolTable();
+						backend.PrintAllMemoryTable();
+					}
+					else if (engine == "ast")
+					{
+						std::cout << "Interpreter-----------------------------------------------" << std::endl;
+
+						// Define interpreter
+						auto inter = Interpreter();
+						inter.Reset();
+						inter.SetSFD(&sfd);
+						inter.InterpretProgram(root_tree);
+						inter.PrintAllSymbolTable();
+						inter.PrintAllMemoryTable();
+					}
+					else
+					{
+						std::cout << "'" << engine << "'" << " is not a known engine. Use 'ast', 'vm', 'vm-profile', 'reg', 'reg-switch', 'closure' or 'c' instead." << std::endl;
+					}
 				}
 				catch (const MyExceptions::MsgExecption& e)
 				{
@@ -0,0 +1,209 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Value.hpp"
+#include "Frame.hpp"
+#include "Operator.hpp"
+
+/*
+Instruction set of the register virtual machine.
+Operands are indexes in one register file holding the constants, the variables of every scope and the temporaries.
+A procedure is only visible to the block that declares it, so it cannot recurse and its scope has at most one
+activation at a time: every variable gets a fixed register at compile time and is read without any frame lookup.
+*/
+enum RegisterOpCode : unsigned char
+{
+	ROP_MOVE,			// R[a] = R[b]
+	ROP_BINARY,			// R[a] = binary(R[b], R[c]), the kernel is bound at compile time
+	ROP_UNARY,			// R[a] = unary(R[b])
+	ROP_JUMP,			// pc = target
+	ROP_JUMP_IF_FALSE,	// pc = target if R[b] is FALSE
+	ROP_JUMP_IF_TRUE,	// pc = target if R[b] is TRUE
+	ROP_FOR_TO,			// enter a loop counting R[b] up to R[c] with R[a] = R[b], or pc = target if the range is empty
+	ROP_FOR_DOWNTO,
+	ROP_NEXT_TO,		// step the counter R[b] with R[a] = R[b] and pc = target, unless it has reached R[c]
+	ROP_NEXT_DOWNTO,
+	ROP_ENTER,			// unassign the c variables of the scope whose registers start at a
+	ROP_CALL,			// push the return address, pc = target
+	ROP_RETURN,			// return to the caller
+	ROP_HALT,
+	ROP_COUNT
+};
+
+/*
+Functionality: mnemonic of an op code for disassembly
+*/
+inline std::string GetRegisterOpCodeName(RegisterOpCode op)
+{
+	static const char* names[] = {
+		"MOVE", "BINARY", "UNARY", "JUMP", "JUMP_IF_FALSE", "JUMP_IF_TRUE",
+		"FOR_TO", "FOR_DOWNTO", "NEXT_TO", "NEXT_DOWNTO", "ENTER", "CALL", "RETURN", "HALT"
+	};
+	return (op < ROP_COUNT) ? names[op] : "UNKNOWN";
+}
+
+struct RegisterInstruction
+{
+	RegisterOpCode op;
+	unsigned int a;
+	unsigned int b;
+	unsigned int c;
+	unsigned int target;
+	union
+	{
+		BinaryKernel binary;
+		UnaryKernel unary;
+	};
+
+	std::string ToString() const noexcept
+	{
+		return GetRegisterOpCodeName(op) + " " + MyTemplates::Str(a) + " " + MyTemplates::Str(b) + " " + \
+			MyTemplates::Str(c) + " " + MyTemplates::Str(target);
+	}
+};
+
+/*
+Cold data of an instruction, only read to report an error
+*/
+struct RegisterDebugInfo
+{
+	// Positions of the operands b and c, when they are variables
+	unsigned int posB;
+	unsigned int posC;
+	// Last variable read before the instruction but whose register is only read after it (see DeferredRead), or -1
+	int deferred;
+};
+
+/*
+A variable operand is read from its register by the instruction consuming it, which may run after instructions
+the tree walker runs after the read (in 'a + b // c', the division runs before the addition reads 'a').
+Such reads are chained per instruction, so that an error of the instruction reports an unassigned variable read
+before it first, as the other engines do.
+*/
+struct DeferredRead
+{
+	unsigned int reg;
+	unsigned int pos;
+	int previous;
+};
+
+/*
+A compiled program: linear code, initial register file and what is needed to report errors and print the globals
+*/
+class RegisterProgram
+{
+public:
+	RegisterProgram() {};
+	virtual ~RegisterProgram() {};
+
+	void Reset() noexcept
+	{
+		m_code.clear();
+		m_debug.clear();
+		m_deferred.clear();
+		m_registers.clear();
+		m_names.clear();
+		m_globals.reset();
+		m_globalBase = 0;
+	}
+
+	unsigned int Emit(const RegisterInstruction& inst, const RegisterDebugInfo& debug)
+	{
+		m_code.push_back(inst);
+		m_debug.push_back(debug);
+		return static_cast<unsigned int>(m_code.size() - 1);
+	}
+
+	void PatchTarget(unsigned int index, unsigned int target) noexcept
+	{
+		m_code[index].target = target;
+	}
+
+	void BindKernel(unsigned int index, BinaryKernel kernel) noexcept
+	{
+		m_code[index].binary = kernel;
+	}
+
+	void BindKernel(unsigned int index, UnaryKernel kernel) noexcept
+	{
+		m_code[index].unary = kernel;
+	}
+
+	// Register holding value before the program runs, name is empty for constants and temporaries
+	unsigned int AddRegister(const Value& value, const std::string& name = "")
+	{
+		m_registers.push_back(value);
+		m_names.push_back(name);
+		return static_cast<unsigned int>(m_registers.size() - 1);
+	}
+
+	int AddDeferredRead(const DeferredRead& read)
+	{
+		m_deferred.push_back(read);
+		return static_cast<int>(m_deferred.size() - 1);
+	}
+
+	void SetGlobals(const std::shared_ptr<FrameLayout>& layout, unsigned int base) noexcept
+	{
+		m_globals = layout;
+		m_globalBase = base;
+	}
+
+	unsigned int GetCodeSize() const noexcept
+	{
+		return static_cast<unsigned int>(m_code.size());
+	}
+
+	const std::vector<RegisterInstruction>& GetCode() const noexcept
+	{
+		return m_code;
+	}
+
+	const RegisterDebugInfo& GetDebugInfo(unsigned int index) const noexcept
+	{
+		return m_debug[index];
+	}
+
+	const DeferredRead& GetDeferredRead(int index) const noexcept
+	{
+		return m_deferred[index];
+	}
+
+	const std::vector<Value>& GetRegisters() const noexcept
+	{
+		return m_registers;
+	}
+
+	const std::string& GetRegisterName(unsigned int reg) const noexcept
+	{
+		return m_names[reg];
+	}
+
+	const FrameLayout* GetGlobals() const noexcept
+	{
+		return m_globals.get();
+	}
+
+	unsigned int GetGlobalBase() const noexcept
+	{
+		return m_globalBase;
+	}
+
+	std::string ToString() const noexcept
+	{
+		std::string result;
+		for (unsigned int i = 0; i < m_code.size(); i++)
+			result += MyTemplates::Str(i) + ": " + m_code[i].ToString() + "\n";
+		return result;
+	}
+
+private:
+	std::vector<RegisterInstruction> m_code;
+	std::vector<RegisterDebugInfo> m_debug;
+	std::vector<DeferredRead> m_deferred;
+	std::vector<Value> m_registers;
+	std::vector<std::string> m_names;
+	std::shared_ptr<FrameLayout> m_globals;
+	unsigned int m_globalBase = 0;
+};
@@ -0,0 +1,487 @@
+#include "RegisterCompiler.hpp"
+
+void RegisterCompiler::CompileProgram(PTR_AST root, RegisterProgram& program)
+{
+	m_program = &program;
+	m_program->Reset();
+	m_scopes.clear();
+	m_scopeStack.clear();
+	m_procedures.clear();
+	CompileProgramEntryHelper(root);
+	DEBUG_MSG("Compiled register bytecode--->\n" + m_program->ToString());
+}
+
+RegisterCompiler::CompileScope* RegisterCompiler::ScopeDefine(PTR_AST block)
+{
+	auto layout = static_cast<Block_AST*>(block)->GetFrameLayout();
+	if (!layout)
+		Error("ASTError(Compiler): block has no frame layout, run the semantic analyzer first.");
+	// Variables of a scope are contiguous so that entering it unassigns them in one go
+	auto& scope = m_scopes[block];
+	scope.base = m_program->GetRegisters().size();
+	scope.size = layout->GetSize();
+	for (unsigned int slot = 0; slot < layout->GetSize(); slot++)
+		m_program->AddRegister(MAKE_EMPTY_MEMORY, layout->names[slot]);
+	m_scopeStack.push_back(&scope);
+	return &scope;
+}
+
+unsigned int RegisterCompiler::VariableRegister(PTR_AST var)
+{
+	if (!var->IsResolved() || var->GetSlotLevel() > m_scopeStack.size() || \
+		var->GetSlotIndex() >= m_scopeStack[var->GetSlotLevel() - 1]->size)
+		ErrorSFD("ASTError(Compiler): variable " + std::string(var->GetToken()->GetValue()) + " has not been resolved by the semantic analyzer.", var->GetToken()->GetPos());
+	return m_scopeStack[var->GetSlotLevel() - 1]->base + var->GetSlotIndex();
+}
+
+unsigned int RegisterCompiler::AllocateTemp()
+{
+	auto scope = m_scopeStack.back();
+	for (size_t i = 0; i < scope->temps.size(); i++)
+	{
+		if (!scope->busy[i])
+		{
+			scope->busy[i] = true;
+			return scope->temps[i];
+		}
+	}
+	scope->temps.push_back(m_program->AddRegister(MAKE_EMPTY_MEMORY));
+	scope->busy.push_back(true);
+	return scope->temps.back();
+}
+
+void RegisterCompiler::Release(const Operand& operand)
+{
+	if (!operand.temp)
+		return;
+	auto scope = m_scopeStack.back();
+	for (size_t i = 0; i < scope->temps.size(); i++)
+	{
+		if (scope->temps[i] == operand.reg)
+			scope->busy[i] = false;
+	}
+}
+
+unsigned int RegisterCompiler::ConstantRegister(const Value& value)
+{
+	return m_program->AddRegister(value);
+}
+
+unsigned int RegisterCompiler::Emit(RegisterOpCode op, unsigned int a, unsigned int b, unsigned int c, unsigned int posB, unsigned int posC)
+{
+	RegisterInstruction inst;
+	inst.op = op;
+	inst.a = a;
+	inst.b = b;
+	inst.c = c;
+	inst.target = 0;
+	inst.binary = nullptr;
+	return m_program->Emit(inst, RegisterDebugInfo{ posB, posC, m_deferredTop });
+}
+
+void RegisterCompiler::PushVariable(unsigned int reg, unsigned int pos)
+{
+	m_deferredTop = m_program->AddDeferredRead(DeferredRead{ reg, pos, m_deferredTop });
+	m_pendingOperands.push_back(m_operands.size());
+	m_operands.push_back(Operand{ reg, pos, false, m_deferredTop });
+}
+
+RegisterCompiler::Operand RegisterCompiler::PopOperand()
+{
+	Operand operand = m_operands.back();
+	m_operands.pop_back();
+	// Pending variables are consumed in the reverse order they were pushed
+	if (operand.deferred >= 0)
+	{
+		m_deferredTop = m_program->GetDeferredRead(operand.deferred).previous;
+		m_pendingOperands.pop_back();
+	}
+	return operand;
+}
+
+void RegisterCompiler::Flush()
+{
+	// Oldest first, each copy is the read of the variable
+	m_deferredTop = -1;
+	for (size_t index : m_pendingOperands)
+	{
+		Operand& operand = m_operands[index];
+		unsigned int temp = AllocateTemp();
+		Emit(ROP_MOVE, temp, operand.reg, 0, operand.pos);
+		operand = Operand{ temp, operand.pos, true, -1 };
+	}
+	m_pendingOperands.clear();
+}
+
+/*
+Functionality: compile the entry (PROGRAM, block)
+*/
+
+void RegisterCompiler::CompileProgramEntryHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileProgramEntryHelper is null.");
+		return;
+	}
+
+	switch (root->GetKind())
+	{
+	// Condition: is a program start
+	case ASTKind::eProgram:
+		VisitProgram(static_cast<PTR_PROGRAM_AST>(root));
+		break;
+	// Condition: is a block right after the program start
+	case ASTKind::eBlock:
+		VisitBlock(static_cast<PTR_BLOCK_AST>(root));
+		break;
+	default:
+		Error("SyntaxError(Compiler): program entry not defined");
+	}
+}
+
+/*
+Functionality: compile a statement
+*/
+
+void RegisterCompiler::CompileStatementHelper(PTR_AST root)
+{
+	if (!root)
+	{
+		Error("ASTError(Compiler): root of CompileStatementHelper is null.");
+		return;
+	}
+
+	// A statement nested in an expression (procedure call argument) must not run between a read and its register read
+	Flush();
+	switch (root->GetKind())
+	{
+	// Condition: is a compound statment
+	case ASTKind::eCompound:
+		for (auto& child : static_cast<PTR_COMPOUND_AST>(root)->GetAllChildren())
+			CompileStatementHelper(child);
+		break;
+	// Condition: is a empty statement
+	case ASTKind::eEmpty:
+		break;
+	// Condition: is a assign statement
+	case ASTKind::eAssign:
+		VisitAssign(static_cast<PTR_ASSIGN_AST>(root));
+		break;
+	// Condition: is a counted loop
+	case ASTKind::eFor:
+		VisitFor(static_cast<PTR_FOR_AST>(root));
+		break;
+	// Condition: is a conditional statement
+	case ASTKind::eIf:
+		VisitIf(static_cast<PTR_IF_AST>(root));
+		break;
+	// Condition: is a pre-tested loop
+	case ASTKind::eWhile:
+		VisitWhile(static_cast<PTR_WHILE_AST>(root));
+		break;
+	// Condition: is a post-tested loop
+	case ASTKind::eRepeat:
+		VisitRepeat(static_cast<PTR_REPEAT_AST>(root));
+		break;
+	// Condition: is a procedure call
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		break;
+	// Condition: is a bare expression, evaluated for its errors only
+	default:
+	{
+		Operand value = CompileExpression(root);
+		if (value.deferred >= 0)
+		{
+			unsigned int temp = AllocateTemp();
+			Emit(ROP_MOVE, temp, value.reg, 0, value.pos);
+			value = Operand{ temp, value.pos, true, -1 };
+		}
+		Release(value);
+	}
+	}
+}
+
+RegisterCompiler::Operand RegisterCompiler::CompileExpression(PTR_AST root, unsigned int target)
+{
+	// Jumps taken when the left operand of an AND/OR decides it, patched once its right operand is compiled
+	std::vector<unsigned int> shortCircuits;
+	size_t base = m_operands.size();
+
+	// Result register of an operator, the root writes into target since its operands are read before
+	auto destination = [&](PTR_AST node, const Operand& left, const Operand& right)
+	{
+		Release(right);
+		Release(left);
+		if (node == root && target != NO_REGISTER)
+			return Operand{ target, node->GetToken()->GetPos(), false, -1 };
+		return Operand{ AllocateTemp(), node->GetToken()->GetPos(), true, -1 };
+	};
+
+	WalkExpression(root,
+		[&](PTR_AST leaf) { CompileLeaf(leaf); },
+		[&](PTR_BINARY_AST node)
+		{
+			auto kernel = node->GetKernel();
+			if (kernel == nullptr)
+				ErrorSFD("ASTError(Compiler): " + node->GetToken()->ToString() + " has not been typed by the semantic analyzer.", node->GetToken()->GetPos());
+			Operand right = PopOperand();
+			Operand left = PopOperand();
+			Operand result = destination(node, left, right);
+			m_program->BindKernel(Emit(ROP_BINARY, result.reg, left.reg, right.reg, left.pos, right.pos), kernel);
+			m_operands.push_back(result);
+		},
+		[&](PTR_UNARY_AST node)
+		{
+			auto kernel = node->GetKernel();
+			if (kernel == nullptr)
+				ErrorSFD("ASTError(Compiler): " + node->ToString() + " has not been typed by the semantic analyzer.", node->GetToken()->GetPos());
+			Operand expr = PopOperand();
+			Operand result = destination(node, expr, Operand{ 0, 0, false, -1 });
+			m_program->BindKernel(Emit(ROP_UNARY, result.reg, expr.reg, 0, expr.pos), kernel);
+			m_operands.push_back(result);
+		},
+		[&](PTR_LOGICAL_AST node)
+		{
+			// The result register holds the left operand, the right one overwrites it unless the left one decides
+			Operand left = PopOperand();
+			Release(left);
+			Operand result{ AllocateTemp(), left.pos, true, -1 };
+			if (result.reg != left.reg)
+				Emit(ROP_MOVE, result.reg, left.reg, 0, left.pos);
+			shortCircuits.push_back(Emit((node->GetToken()->GetType() == OR) ? ROP_JUMP_IF_TRUE : ROP_JUMP_IF_FALSE, 0, result.reg));
+			m_operands.push_back(result);
+			return true;
+		},
+		[&](PTR_LOGICAL_AST)
+		{
+			Operand right = PopOperand();
+			Release(right);
+			Operand result = m_operands.back();
+			if (result.reg != right.reg)
+				Emit(ROP_MOVE, result.reg, right.reg, 0, right.pos);
+			m_program->PatchTarget(shortCircuits.back(), m_program->GetCodeSize());
+			shortCircuits.pop_back();
+		});
+
+	if (m_operands.size() != base + 1)
+		Error("ASTError(Compiler): expression left " + MyTemplates::Str(m_operands.size() - base) + " values.");
+	return PopOperand();
+}
+
+void RegisterCompiler::CompileLeaf(PTR_AST root)
+{
+	switch (root->GetKind())
+	{
+	// Condition: is a procedure call used as a value, which is always empty
+	case ASTKind::eProcedure:
+		VisitProcedureCall(static_cast<PTR_PROCEDURE_AST>(root));
+		m_operands.push_back(Operand{ ConstantRegister(MAKE_EMPTY_MEMORY), root->GetToken()->GetPos(), false, -1 });
+		break;
+	// Condition: is a literal or a variable
+	case ASTKind::eToken:
+	{
+		auto token = root->GetToken();
+		if (root->IsResolved() || token->GetType() == ID)
+			PushVariable(VariableRegister(root), token->GetPos());
+		else
+			m_operands.push_back(Operand{ ConstantRegister(root->GetLiteral()), token->GetPos(), false, -1 });
+		break;
+	}
+	// Condition: is a statement used as a value, which is always empty
+	default:
+		CompileStatementHelper(root);
+		m_operands.push_back(Operand{ ConstantRegister(MAKE_EMPTY_MEMORY), 0, false, -1 });
+	}
+}
+
+void RegisterCompiler::VisitProgram(PTR_PROGRAM_AST root)
+{
+	auto scope = ScopeDefine(root->GetBlock());
+	m_program->SetGlobals(static_cast<Block_AST*>(root->GetBlock())->GetFrameLayout(), scope->base);
+	VisitBlock(static_cast<PTR_BLOCK_AST>(root->GetBlock()));
+	Emit(ROP_HALT, 0);
+	m_scopeStack.pop_back();
+}
+
+void RegisterCompiler::VisitProcedure(PTR_PROCEDURE_AST root)
+{
+	auto scope = ScopeDefine(root->GetBlock());
+	m_procedures[root] = std::make_pair(m_program->GetCodeSize(), scope);
+	VisitBlock(static_cast<PTR_BLOCK_AST>(root->GetBlock()));
+	Emit(ROP_RETURN, 0);
+	m_scopeStack.pop_back();
+}
+
+void RegisterCompiler::VisitProcedureCall(PTR_PROCEDURE_AST root)
+{
+	// The callee may assign variables read before the call
+	Flush();
+	auto it = m_procedures.find(root->GetDeclaration());
+	if (it == m_procedures.end())
+	{
+		ErrorSFD("SymbolError(Compiler): procedure " + root->GetName() + " used before reference.", root->GetToken()->GetPos());
+		return;
+	}
+	auto procedure = root->GetDeclaration();
+	auto scope = it->second.second;
+	PTR_COMPOUND_AST params = ast_cast<Compound_AST>(root->GetParams());
+
+	Emit(ROP_ENTER, scope->base, 0, scope->size);
+	if (ast_cast<Declaration_AST>(procedure->GetParams()))
+	{
+		if (params == nullptr)
+		{
+			Error("ASTError(Compiler): procedure arguments have not been checked by the semantic analyzer.");
+		}
+		// Arguments are assigned inside the callee scope
+		m_scopeStack.push_back(scope);
+		for (auto& child : params->GetAllChildren())
+		{
+			if (PTR_ASSIGN_AST params_assign = ast_cast<Assign_AST>(child))
+			{
+				VisitAssign(params_assign);
+			}
+			else
+			{
+				Error("SyntaxError(Compiler): unknown parameter assignment.");
+			}
+		}
+		m_scopeStack.pop_back();
+	}
+	else if (params != nullptr)
+	{
+		Error("ASTError(Compiler): procedure arguments have not been checked by the semantic analyzer.");
+	}
+	auto call = Emit(ROP_CALL, 0);
+	m_program->PatchTarget(call, it->second.first);
+}
+
+void RegisterCompiler::VisitBlock(PTR_BLOCK_AST root)
+{
+	// Process declarations.
+	if (PTR_DECLARATION_AST declaration = ast_cast<Declaration_AST>(root->GetDeclaration()))
+	{
+		// Procedure bodies are emitted inline and jumped over
+		unsigned int jump = 0;
+		bool hasProcedure = false;
+		for (PTR_AST decal : declaration->GetAllChildren())
+		{
+			if (PTR_PROCEDURE_AST _procedure = ast_cast<Procedure_AST>(decal))
+			{
+				if (!hasProcedure)
+				{
+					jump = Emit(ROP_JUMP, 0);
+					hasProcedure = true;
+				}
+				VisitProcedure(_procedure);
+			}
+			else if (!ast_cast<DeclContainer_AST>(decal))
+			{
+				Error("ASTError(Compiler): unknown declaration");
+			}
+		}
+		if (hasProcedure)
+			m_program->PatchTarget(jump, m_program->GetCodeSize());
+	}
+	// Process the rest of the program.
+	CompileStatementHelper(root->GetCompound());
+}
+
+void RegisterCompiler::VisitAssign(PTR_ASSIGN_AST root)
+{
+	// The semantic analyzer has checked that the types match
+	unsigned int var = VariableRegister(root->GetLeft());
+	Operand value = CompileExpression(root->GetRight(), var);
+	// 'a := a' still moves the variable onto itself, the move is its read and checks that it is assigned
+	if (value.reg != var || value.deferred >= 0)
+		Emit(ROP_MOVE, var, value.reg, 0, value.pos);
+	Release(value);
+}
+
+void RegisterCompiler::VisitFor(PTR_FOR_AST root)
+{
+	/*
+		counter = start, last = end
+		head:	FOR_TO		var counter last exit
+		body:	...
+				NEXT_TO		var counter last body
+		exit:
+	The bounds were checked to be INTEGER by the semantic analyzer, they are copied so that the body cannot change them.
+	*/
+	unsigned int var = VariableRegister(root->GetVariable());
+	unsigned int counter = AllocateTemp();
+	unsigned int last = AllocateTemp();
+	for (auto bound : { std::make_pair(root->GetStart(), counter), std::make_pair(root->GetEnd(), last) })
+	{
+		Operand value = CompileExpression(bound.first, bound.second);
+		if (value.reg != bound.second)
+			Emit(ROP_MOVE, bound.second, value.reg, 0, value.pos);
+		Release(value);
+	}
+	auto head = Emit(root->IsDownTo() ? ROP_FOR_DOWNTO : ROP_FOR_TO, var, counter, last);
+	CompileStatementHelper(root->GetBody());
+	auto next = Emit(root->IsDownTo() ? ROP_NEXT_DOWNTO : ROP_NEXT_TO, var, counter, last);
+	m_program->PatchTarget(next, head + 1);
+	m_program->PatchTarget(head, m_program->GetCodeSize());
+	Release(Operand{ last, 0, true, -1 });
+	Release(Operand{ counter, 0, true, -1 });
+}
+
+void RegisterCompiler::VisitIf(PTR_IF_AST root)
+{
+	/*
+			JUMP_IF_FALSE	condition else
+			then
+			JUMP			end			only with an ELSE branch
+		else:
+			otherwise
+		end:
+	*/
+	Operand condition = CompileExpression(root->GetCondition());
+	auto skipThen = Emit(ROP_JUMP_IF_FALSE, 0, condition.reg, 0, condition.pos);
+	Release(condition);
+	CompileStatementHelper(root->GetThen());
+	if (root->GetElse()->GetKind() == ASTKind::eEmpty)
+	{
+		m_program->PatchTarget(skipThen, m_program->GetCodeSize());
+		return;
+	}
+	auto skipElse = Emit(ROP_JUMP, 0);
+	m_program->PatchTarget(skipThen, m_program->GetCodeSize());
+	CompileStatementHelper(root->GetElse());
+	m_program->PatchTarget(skipElse, m_program->GetCodeSize());
+}
+
+void RegisterCompiler::VisitWhile(PTR_WHILE_AST root)
+{
+	/*
+				JUMP			test
+		body:	...
+		test:	JUMP_IF_TRUE	condition body
+	The condition is tested at the bottom, an iteration dispatches a single jump.
+	*/
+	auto enter = Emit(ROP_JUMP, 0);
+	auto body = m_program->GetCodeSize();
+	CompileStatementHelper(root->GetBody());
+	m_program->PatchTarget(enter, m_program->GetCodeSize());
+	Operand condition = CompileExpression(root->GetCondition());
+	auto loop = Emit(ROP_JUMP_IF_TRUE, 0, condition.reg, 0, condition.pos);
+	m_program->PatchTarget(loop, body);
+	Release(condition);
+}
+
+void RegisterCompiler::VisitRepeat(PTR_REPEAT_AST root)
+{
+	/*
+		top:	body
+				JUMP_IF_FALSE	condition top
+	*/
+	auto top = m_program->GetCodeSize();
+	CompileStatementHelper(root->GetBody());
+	Operand condition = CompileExpression(root->GetCondition());
+	auto loop = Emit(ROP_JUMP_IF_FALSE, 0, condition.reg, 0, condition.pos);
+	m_program->PatchTarget(loop, top);
+	Release(condition);
+}
@@ -0,0 +1,151 @@
+/*
+AST to register bytecode compiler
+*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Interpreter.hpp"
+#include "RegisterBytecode.hpp"
+
+
+class RegisterCompiler : public NodeVisitor
+{
+public:
+	RegisterCompiler() : m_program(nullptr), m_deferredTop(-1) {};
+	virtual ~RegisterCompiler() {};
+
+	virtual void Reset() noexcept override
+	{
+		m_scopes.clear();
+		m_scopeStack.clear();
+		m_procedures.clear();
+		m_operands.clear();
+		m_pendingOperands.clear();
+		m_deferredTop = -1;
+		m_program = nullptr;
+		NodeVisitor::Reset();
+	}
+
+public:
+	/*
+	Functionality: lower the AST (PROGRAM, PROCEDURE, block, statements) into register bytecode
+	Return: none, the code and the register file are emitted into program
+	*/
+	void CompileProgram(PTR_AST root, RegisterProgram& program);
+
+protected:
+	static constexpr unsigned int NO_REGISTER = ~0u;
+
+	/*
+	Compile time view of a scope: where its variables start in the register file and its temporaries
+	*/
+	struct CompileScope
+	{
+		unsigned int base;
+		unsigned int size;
+		// Temporaries of the scope, reused by its expressions once released
+		std::vector<unsigned int> temps;
+		std::vector<bool> busy;
+	};
+
+	/*
+	Value of an expression being compiled
+	*/
+	struct Operand
+	{
+		unsigned int reg;
+		unsigned int pos;
+		// Whether the register is a temporary to release once the operand is consumed
+		bool temp;
+		// Entry in the deferred reads while the operand is a variable not read yet, or -1
+		int deferred;
+	};
+
+	// Add the registers of the variables of a scope and enter it
+	CompileScope* ScopeDefine(PTR_AST block);
+
+	// Register of a variable node resolved by the semantic analyzer
+	unsigned int VariableRegister(PTR_AST var);
+
+	unsigned int AllocateTemp();
+
+	void Release(const Operand& operand);
+
+	/*
+	Functionality: emit an instruction, the variables pending on the operand stack are deferred reads of it
+	Return: index of the instruction
+	*/
+	unsigned int Emit(RegisterOpCode op, unsigned int a, unsigned int b = 0, unsigned int c = 0, unsigned int posB = 0, unsigned int posC = 0);
+
+	// Operand stack entry of a variable, read by the instruction consuming it
+	void PushVariable(unsigned int reg, unsigned int pos);
+
+	Operand PopOperand();
+
+	/*
+	Functionality: copy every pending variable to a temporary, before code that can assign variables (calls, statements)
+	*/
+	void Flush();
+
+protected:
+	/*
+	Functionality: compile the entry (PROGRAM, block)
+	*/
+	virtual void CompileProgramEntryHelper(PTR_AST root);
+
+	/*
+	Functionality: compile a statement
+	*/
+	virtual void CompileStatementHelper(PTR_AST root);
+
+	/*
+	Functionality: compile an expression without native recursion (see NodeVisitor::WalkExpression),
+	the last operation writes into target when one is given
+	Return: operand holding the value
+	*/
+	Operand CompileExpression(PTR_AST root, unsigned int target = NO_REGISTER);
+
+	// Leaf of an expression: literal, variable, procedure call or statement used as a value
+	void CompileLeaf(PTR_AST root);
+
+	// Register holding a value that is always the same
+	unsigned int ConstantRegister(const Value& value);
+
+protected:
+	virtual void VisitProgram(PTR_PROGRAM_AST root);
+
+	virtual void VisitProcedure(PTR_PROCEDURE_AST root);
+
+	virtual void VisitProcedureCall(PTR_PROCEDURE_AST root);
+
+	virtual void VisitBlock(PTR_BLOCK_AST root);
+
+	virtual void VisitAssign(PTR_ASSIGN_AST root);
+
+	virtual void VisitFor(PTR_FOR_AST root);
+
+	virtual void VisitIf(PTR_IF_AST root);
+
+	virtual void VisitWhile(PTR_WHILE_AST root);
+
+	virtual void VisitRepeat(PTR_REPEAT_AST root);
+
+protected:
+	RegisterProgram* m_program;
+	// Scopes by block, the ith scope of the stack is at level i+1
+	std::map<PTR_AST, CompileScope> m_scopes;
+	std::vector<CompileScope*> m_scopeStack;
+	// Declared procedures: entry point and scope
+	std::map<PTR_AST, std::pair<unsigned int, CompileScope*>> m_procedures;
+
+	// Operand stack of the expressions being compiled, shared by the expressions nested in a leaf
+	std::vector<Operand> m_operands;
+	// Indexes of the pending variables in m_operands, and the last of their deferred reads
+	std::vector<size_t> m_pendingOperands;
+	int m_deferredTop;
+};
@@ -0,0 +1,227 @@
+#include "RegisterMachine.hpp"
+
+void RegisterMachine::Run(const RegisterProgram& program, Dispatch dispatch)
+{
+	m_program = &program;
+	m_registers = program.GetRegisters();
+	m_returns.clear();
+	m_globals.Reset();
+
+	if (dispatch == Dispatch::eThreaded && HAS_COMPUTED_GOTO)
+		Execute<true>();
+	else
+		Execute<false>();
+
+	// The variables of the program are printed like the frame of the other engines
+	if (const FrameLayout* layout = program.GetGlobals())
+	{
+		m_globals.Push(layout);
+		for (unsigned int slot = 0; slot < layout->GetSize(); slot++)
+			m_globals.Slot(1, slot) = m_registers[program.GetGlobalBase() + slot];
+	}
+}
+
+void RegisterMachine::Unassigned(unsigned int reg, unsigned int pos)
+{
+	ErrorSFD("SymbolError(RegisterMachine): variable " + m_program->GetRegisterName(reg) + " used before reference.", pos);
+}
+
+void RegisterMachine::CheckDeferredReads(unsigned int pc)
+{
+	std::vector<const DeferredRead*> reads;
+	for (int index = m_program->GetDebugInfo(pc).deferred; index >= 0; index = m_program->GetDeferredRead(index).previous)
+		reads.push_back(&m_program->GetDeferredRead(index));
+	// The chain runs from the last read to the first
+	for (auto it = reads.rbegin(); it != reads.rend(); it++)
+	{
+		if (m_registers[(*it)->reg].IsEmpty())
+			Unassigned((*it)->reg, (*it)->pos);
+	}
+}
+
+/*
+Every handler is written once as a label. Threaded dispatch jumps straight to the handler of the next instruction,
+switch dispatch goes back to a single switch on its op code.
+THREADED is a plain condition so both instantiations refer to the switch label, the branch not taken is folded away.
+*/
+#if HAS_COMPUTED_GOTO
+#define REGISTER_DISPATCH() \
+	do { if (THREADED) goto *handlers[pc]; else goto dispatch; } while (0)
+#else
+#define REGISTER_DISPATCH() goto dispatch
+#endif
+
+#define REGISTER_READ(reg, pos) \
+	do { if (R[reg].IsEmpty()) Unassigned(reg, m_program->GetDebugInfo(pc).pos); } while (0)
+
+template <bool THREADED>
+void RegisterMachine::Execute()
+{
+	const RegisterInstruction* code = m_program->GetCode().data();
+	Value* R = m_registers.data();
+	unsigned int pc = 0;
+
+#if HAS_COMPUTED_GOTO
+	static const void* const LABELS[ROP_COUNT] = {
+		&&L_MOVE, &&L_BINARY, &&L_UNARY, &&L_JUMP, &&L_JUMP_IF_FALSE, &&L_JUMP_IF_TRUE,
+		&&L_FOR_TO, &&L_FOR_DOWNTO, &&L_NEXT_TO, &&L_NEXT_DOWNTO, &&L_ENTER, &&L_CALL, &&L_RETURN, &&L_HALT
+	};
+	// Direct threading: the handler of every instruction is resolved once
+	std::vector<const void*> threaded;
+	if constexpr (THREADED)
+	{
+		threaded.resize(m_program->GetCodeSize());
+		for (unsigned int i = 0; i < threaded.size(); i++)
+			threaded[i] = LABELS[code[i].op];
+	}
+	const void* const* handlers = threaded.data();
+#endif
+
+	try
+	{
+		REGISTER_DISPATCH();
+
+	dispatch:
+		switch (code[pc].op)
+		{
+		case ROP_MOVE: goto L_MOVE;
+		case ROP_BINARY: goto L_BINARY;
+		case ROP_UNARY: goto L_UNARY;
+		case ROP_JUMP: goto L_JUMP;
+		case ROP_JUMP_IF_FALSE: goto L_JUMP_IF_FALSE;
+		case ROP_JUMP_IF_TRUE: goto L_JUMP_IF_TRUE;
+		case ROP_FOR_TO: goto L_FOR_TO;
+		case ROP_FOR_DOWNTO: goto L_FOR_DOWNTO;
+		case ROP_NEXT_TO: goto L_NEXT_TO;
+		case ROP_NEXT_DOWNTO: goto L_NEXT_DOWNTO;
+		case ROP_ENTER: goto L_ENTER;
+		case ROP_CALL: goto L_CALL;
+		case ROP_RETURN: goto L_RETURN;
+		case ROP_HALT: goto L_HALT;
+		default:
+			Error("RuntimeError(RegisterMachine): unknown op code " + code[pc].ToString() + ".");
+		}
+
+	L_MOVE:
+		{
+			const RegisterInstruction& inst = code[pc];
+			REGISTER_READ(inst.b, posB);
+			R[inst.a] = R[inst.b];
+			pc++;
+			REGISTER_DISPATCH();
+		}
+	L_BINARY:
+		{
+			const RegisterInstruction& inst = code[pc];
+			REGISTER_READ(inst.b, posB);
+			REGISTER_READ(inst.c, posC);
+			R[inst.a] = inst.binary(R[inst.b], R[inst.c]);
+			pc++;
+			REGISTER_DISPATCH();
+		}
+	L_UNARY:
+		{
+			const RegisterInstruction& inst = code[pc];
+			REGISTER_READ(inst.b, posB);
+			R[inst.a] = inst.unary(R[inst.b]);
+			pc++;
+			REGISTER_DISPATCH();
+		}
+	L_JUMP:
+		pc = code[pc].target;
+		REGISTER_DISPATCH();
+	// Conditions were checked to be BOOLEAN by the semantic analyzer
+	L_JUMP_IF_FALSE:
+		{
+			const RegisterInstruction& inst = code[pc];
+			REGISTER_READ(inst.b, posB);
+			pc = R[inst.b].GetBoolean() ? pc + 1 : inst.target;
+			REGISTER_DISPATCH();
+		}
+	L_JUMP_IF_TRUE:
+		{
+			const RegisterInstruction& inst = code[pc];
+			REGISTER_READ(inst.b, posB);
+			pc = R[inst.b].GetBoolean() ? inst.target : pc + 1;
+			REGISTER_DISPATCH();
+		}
+	// Bounds were checked to be INTEGER by the semantic analyzer and copied to temporaries
+	L_FOR_TO:
+		{
+			const RegisterInstruction& inst = code[pc];
+			if (R[inst.b].GetInteger() > R[inst.c].GetInteger())
+			{
+				pc = inst.target;
+				REGISTER_DISPATCH();
+			}
+			R[inst.a] = R[inst.b];
+			pc++;
+			REGISTER_DISPATCH();
+		}
+	L_FOR_DOWNTO:
+		{
+			const RegisterInstruction& inst = code[pc];
+			if (R[inst.b].GetInteger() < R[inst.c].GetInteger())
+			{
+				pc = inst.target;
+				REGISTER_DISPATCH();
+			}
+			R[inst.a] = R[inst.b];
+			pc++;
+			REGISTER_DISPATCH();
+		}
+	// Stop on the end bound itself, stepping past it could overflow
+	L_NEXT_TO:
+		{
+			const RegisterInstruction& inst = code[pc];
+			int64_t current = R[inst.b].GetInteger();
+			if (current == R[inst.c].GetInteger())
+			{
+				pc++;
+				REGISTER_DISPATCH();
+			}
+			R[inst.a] = R[inst.b] = Value::Integer(current + 1);
+			pc = inst.target;
+			REGISTER_DISPATCH();
+		}
+	L_NEXT_DOWNTO:
+		{
+			const RegisterInstruction& inst = code[pc];
+			int64_t current = R[inst.b].GetInteger();
+			if (current == R[inst.c].GetInteger())
+			{
+				pc++;
+				REGISTER_DISPATCH();
+			}
+			R[inst.a] = R[inst.b] = Value::Integer(current - 1);
+			pc = inst.target;
+			REGISTER_DISPATCH();
+		}
+	L_ENTER:
+		{
+			const RegisterInstruction& inst = code[pc];
+			std::fill(R + inst.a, R + inst.a + inst.c, MAKE_EMPTY_MEMORY);
+			pc++;
+			REGISTER_DISPATCH();
+		}
+	L_CALL:
+		m_returns.push_back(pc + 1);
+		pc = code[pc].target;
+		REGISTER_DISPATCH();
+	L_RETURN:
+		pc = m_returns.back();
+		m_returns.pop_back();
+		REGISTER_DISPATCH();
+	L_HALT:
+		return;
+	}
+	catch (const MyExceptions::MsgExecption&)
+	{
+		// A variable read before the failing instruction takes precedence over its error
+		CheckDeferredReads(pc);
+		throw;
+	}
+}
+
+#undef REGISTER_READ
+#undef REGISTER_DISPATCH
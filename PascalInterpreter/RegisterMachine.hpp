@@ -0,0 +1,106 @@
+/*
+Register virtual machine running RegisterProgram
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Frame.hpp"
+#include "RegisterBytecode.hpp"
+
+
+class RegisterMachine
+{
+public:
+	/*
+	How the next instruction is reached: through the handler address resolved for each instruction before running
+	(labels as values, HAS_COMPUTED_GOTO), or through a switch on its op code
+	*/
+	enum class Dispatch : unsigned char
+	{
+		eThreaded,
+		eSwitch
+	};
+
+	RegisterMachine()
+		:
+		m_program(nullptr),
+		m_sfd(nullptr)
+	{}
+	virtual ~RegisterMachine() {};
+
+	void Reset() noexcept
+	{
+		m_registers.clear();
+		m_returns.clear();
+		m_globals.Reset();
+		m_program = nullptr;
+		m_sfd = nullptr;
+	}
+
+	void SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
+	{
+		m_sfd = sfd;
+	}
+
+	void PrintAllSymbolTable() noexcept
+	{
+		m_globals.PrintAllSymbolTable();
+	}
+
+	void PrintAllMemoryTable() noexcept
+	{
+		m_globals.PrintAllMemoryTable();
+	}
+
+public:
+	/*
+	Functionality: execute a compiled program until ROP_HALT, the global variables are kept for printing.
+	Threaded dispatch falls back to the switch on compilers without labels as values.
+	Return: none
+	*/
+	void Run(const RegisterProgram& program, Dispatch dispatch);
+
+protected:
+	/*
+	Funtionality: helper function to throw exception with a specific message
+	*/
+	inline void Error(const std::string& msg)
+	{
+		throw MyExceptions::MsgExecption(msg);
+	}
+
+	/*
+	Funtionality: helper function to throw exception with a specific message and source file location
+	*/
+	inline void ErrorSFD(const std::string& msg, unsigned int pos)
+	{
+		throw MyExceptions::MsgExecption(msg, m_sfd, pos);
+	}
+
+	template <bool THREADED>
+	void Execute();
+
+	// Report a variable read before being assigned
+	void Unassigned(unsigned int reg, unsigned int pos);
+
+	/*
+	Functionality: report the first unassigned variable read before the instruction at pc (see DeferredRead)
+	Return: none if there is none, the error of the instruction itself stands
+	*/
+	void CheckDeferredReads(unsigned int pc);
+
+private:
+	const RegisterProgram* m_program;
+
+	std::vector<Value> m_registers;
+	// Return addresses of the active calls
+	std::vector<unsigned int> m_returns;
+	// Frame of the program, filled once it halts
+	FrameStack m_globals;
+
+	MyDebug::SrouceFileDebugger* m_sfd;
+};
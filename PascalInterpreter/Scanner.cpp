@@ -0,0 +1,178 @@
+#include "Scanner.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCANNER_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SCANNER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SCANNER_AVX2_TARGET
+#endif
+
+namespace
+{
+	inline bool IsWhiteSpace(char c) noexcept
+	{
+		return c == ' ' || (c >= '\t' && c <= '\r');
+	}
+
+	size_t SkipWhiteSpaceScalar(const char* text, size_t pos, size_t size) noexcept
+	{
+		while (pos < size && IsWhiteSpace(text[pos]))
+			pos++;
+		return pos;
+	}
+
+	size_t FindCommentEndScalar(const char* text, size_t pos, size_t size, char end) noexcept
+	{
+		while (pos < size && text[pos] != end && text[pos] != '\0')
+			pos++;
+		return pos;
+	}
+
+#ifdef SCANNER_X86_64
+	inline unsigned int CountTrailingZeros(unsigned int mask) noexcept
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<unsigned int>(index);
+#else
+		return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+	}
+
+	size_t SkipWhiteSpaceSSE2(const char* text, size_t pos, size_t size) noexcept
+	{
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i range = _mm_set1_epi8('\r' - '\t');
+		const __m128i zero = _mm_setzero_si128();
+		while (pos + 16 <= size)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+			// '\t'..'\r' is one unsigned range: (c - '\t') <= ('\r' - '\t')
+			__m128i control = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(chunk, tab), range), zero);
+			__m128i white = _mm_or_si128(_mm_cmpeq_epi8(chunk, space), control);
+			unsigned int mask = ~static_cast<unsigned int>(_mm_movemask_epi8(white)) & 0xFFFFu;
+			if (mask != 0)
+				return pos + CountTrailingZeros(mask);
+			pos += 16;
+		}
+		return SkipWhiteSpaceScalar(text, pos, size);
+	}
+
+	size_t FindCommentEndSSE2(const char* text, size_t pos, size_t size, char end) noexcept
+	{
+		const __m128i target = _mm_set1_epi8(end);
+		const __m128i zero = _mm_setzero_si128();
+		while (pos + 16 <= size)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+			__m128i hit = _mm_or_si128(_mm_cmpeq_epi8(chunk, target), _mm_cmpeq_epi8(chunk, zero));
+			unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(hit));
+			if (mask != 0)
+				return pos + CountTrailingZeros(mask);
+			pos += 16;
+		}
+		return FindCommentEndScalar(text, pos, size, end);
+	}
+
+	SCANNER_AVX2_TARGET size_t SkipWhiteSpaceAVX2(const char* text, size_t pos, size_t size) noexcept
+	{
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i range = _mm256_set1_epi8('\r' - '\t');
+		const __m256i zero = _mm256_setzero_si256();
+		while (pos + 32 <= size)
+		{
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos));
+			__m256i control = _mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_sub_epi8(chunk, tab), range), zero);
+			__m256i white = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), control);
+			unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(white));
+			if (mask != 0)
+				return pos + CountTrailingZeros(mask);
+			pos += 32;
+		}
+		return SkipWhiteSpaceSSE2(text, pos, size);
+	}
+
+	SCANNER_AVX2_TARGET size_t FindCommentEndAVX2(const char* text, size_t pos, size_t size, char end) noexcept
+	{
+		const __m256i target = _mm256_set1_epi8(end);
+		const __m256i zero = _mm256_setzero_si256();
+		while (pos + 32 <= size)
+		{
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos));
+			__m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, target), _mm256_cmpeq_epi8(chunk, zero));
+			unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(hit));
+			if (mask != 0)
+				return pos + CountTrailingZeros(mask);
+			pos += 32;
+		}
+		return FindCommentEndSSE2(text, pos, size, end);
+	}
+
+	bool HasAVX2() noexcept
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		// The OS must save the YMM registers (OSXSAVE and XCR0 bits 1-2)
+		if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	struct Kernels
+	{
+		size_t (*skipWhiteSpace)(const char*, size_t, size_t) noexcept;
+		size_t (*findCommentEnd)(const char*, size_t, size_t, char) noexcept;
+		const char* name;
+	};
+
+	Kernels SelectKernels() noexcept
+	{
+#ifdef SCANNER_X86_64
+		if (HasAVX2())
+			return Kernels{ &SkipWhiteSpaceAVX2, &FindCommentEndAVX2, "avx2" };
+		return Kernels{ &SkipWhiteSpaceSSE2, &FindCommentEndSSE2, "sse2" };
+#else
+		return Kernels{ &SkipWhiteSpaceScalar, &FindCommentEndScalar, "scalar" };
+#endif
+	}
+
+	const Kernels& GetKernels() noexcept
+	{
+		static const Kernels kernels = SelectKernels();
+		return kernels;
+	}
+}
+
+size_t Scanner::SkipWhiteSpace(const char* text, size_t pos, size_t size) noexcept
+{
+	return GetKernels().skipWhiteSpace(text, pos, size);
+}
+
+size_t Scanner::FindCommentEnd(const char* text, size_t pos, size_t size, char end) noexcept
+{
+	return GetKernels().findCommentEnd(text, pos, size, end);
+}
+
+const char* Scanner::GetKernelName() noexcept
+{
+	return GetKernels().name;
+}
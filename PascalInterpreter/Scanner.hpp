@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+/*
+Vectorized scanning kernels used by the lexer to skip whitespace and comments.
+On x86-64 the AVX2 (32 bytes) or SSE2 (16 bytes) kernels are chosen once at runtime from the CPU features,
+every other target uses the scalar kernels. All kernels treat '\0' as the end of the text, like the lexer.
+*/
+namespace Scanner
+{
+	/*
+	Functionality: skip ' ', '\t', '\n', '\v', '\f', '\r' starting at pos
+	Return: position of the first other byte, or size
+	*/
+	size_t SkipWhiteSpace(const char* text, size_t pos, size_t size) noexcept;
+
+	/*
+	Functionality: find the closing character of a comment ('}' or '\n') starting at pos
+	Return: position of the first 'end' or '\0' byte, or size
+	*/
+	size_t FindCommentEnd(const char* text, size_t pos, size_t size, char end) noexcept;
+
+	/*
+	Functionality: name of the kernels selected for this CPU ("avx2", "sse2" or "scalar")
+	*/
+	const char* GetKernelName() noexcept;
+}
@@ -4,6 +4,7 @@
 
 #include "Token.hpp"
 #include "AST.hpp"
+#include "Value.hpp"
 
 class Symbol
 {
@@ -29,8 +30,8 @@ public:
 class VarSymbol
 {
 public:
-	VarSymbol() {};
-	explicit VarSymbol(std::string name, Symbol type) : m_name(name), m_type(type) {};
+	VarSymbol() : m_slot(0) {};
+	explicit VarSymbol(std::string name, Symbol type) : m_name(name), m_type(type), m_slot(0) {};
 	virtual ~VarSymbol() noexcept {};
 	virtual std::string ToString() noexcept
 	{
@@ -44,9 +45,19 @@ public:
 	{
 		return m_type.ToString();
 	}
+	// Index of the variable in its scope, in declaration order
+	void SetSlot(unsigned int slot) noexcept
+	{
+		m_slot = slot;
+	}
+	unsigned int GetSlot() const noexcept
+	{
+		return m_slot;
+	}
 private:
 	std::string m_name;
 	Symbol m_type;
+	unsigned int m_slot;
 };
 
 class ScopedSymbolTable
@@ -89,6 +100,7 @@ public:
 	bool define(std::string name, VarSymbol var)
 	{
 		auto size = m_symbol_map.size();
+		var.SetSlot(static_cast<unsigned int>(size));
 		m_symbol_map.insert(SYMBOL_PAIR(name, var));
 		return (size + 1) == m_symbol_map.size();
 	}
@@ -103,10 +115,18 @@ public:
 	{
 		return var.GetName() != "";
 	}
-	bool check(std::string name, MEMORY token)
+	// Return all symbols ordered by slot index
+	std::vector<VarSymbol> GetSymbolsBySlot() const
+	{
+		std::vector<VarSymbol> result(m_symbol_map.size());
+		for (auto it = m_symbol_map.begin(); it != m_symbol_map.end(); it++)
+			result[it->second.GetSlot()] = it->second;
+		return result;
+	}
+	bool check(std::string name, const MEMORY& value)
 	{
 		auto result = lookup(name);
-		return result.GetType() == token->GetType();
+		return result.GetType() == value.GetType();
 	}
 private:
 	SYMBOL_MAP m_symbol_map;
@@ -143,33 +163,57 @@ public:
 	{
 		m_scopeName = "";
 		m_scopedLevel = 0;
-		m_memory_map.clear();
+		m_memory.clear();
+		m_names.clear();
+		m_types.clear();
 	}
 	void PrintTable() noexcept
 	{
+		// Slots are kept in declaration order, print them sorted by name
+		MEMORY_MAP memory_map;
+		for (unsigned int i = 0; i < m_memory.size(); i++)
+		{
+			if (valid(m_memory[i]))
+				memory_map.insert(MEMORY_PAIR(m_names[i], m_memory[i]));
+		}
 		std::cout << ("Scoped memory table\nScope Name    : " + m_scopeName + "\nScope Level   : " + MyTemplates::Str(m_scopedLevel) + "\n{\n");
-		for (auto it = m_memory_map.begin(); it != m_memory_map.end(); it++)
-			std::cout << it->first << " => " << it->second->ToString() << '\n';
+		for (auto it = memory_map.begin(); it != memory_map.end(); it++)
+			std::cout << it->first << " => " << it->second.ToString() << '\n';
 		std::cout << '}' << std::endl;
 	}
-	void define(std::string name, MEMORY value)
+	// Allocate the next slot for a declared variable, return its index
+	unsigned int define(std::string name, Value::Type type)
 	{
-		m_memory_map[name] = value;
+		m_memory.push_back(MAKE_EMPTY_MEMORY);
+		m_names.push_back(name);
+		m_types.push_back(type);
+		return static_cast<unsigned int>(m_memory.size() - 1);
 	}
-	MEMORY lookup(std::string name)
+	MEMORY& lookup(unsigned int slot)
 	{
-		if (m_memory_map.find(name) != m_memory_map.end())
-			return m_memory_map.at(name);
-		else
-			return MAKE_EMPTY_MEMORY;
+		return m_memory[slot];
+	}
+	Value::Type GetSlotType(unsigned int slot) const
+	{
+		return m_types[slot];
+	}
+	const std::string& GetSlotName(unsigned int slot) const
+	{
+		return m_names[slot];
+	}
+	unsigned int GetSize() const noexcept
+	{
+		return static_cast<unsigned int>(m_memory.size());
 	}
-	bool valid(MEMORY var)
+	bool valid(const MEMORY& var)
 	{
-		return var->GetType() != EMPTY;
+		return !var.IsEmpty();
 	}
 
 private:
-	MEMORY_MAP m_memory_map;
+	std::vector<MEMORY> m_memory;
+	std::vector<std::string> m_names;
+	std::vector<Value::Type> m_types;
 	std::string m_scopeName;
 	unsigned int m_scopedLevel;
 };
@@ -211,22 +255,22 @@ public:
 			std::cout << it->first << " => " << it->second->GetName() << std::endl;
 		std::cout << "" << std::endl;
 	}
-	bool define(std::string name, SHARE_PROCEDURE_AST var)
+	bool define(std::string name, PTR_PROCEDURE_AST var)
 	{
 		auto size = m_procedure_map.size();
 		m_procedure_map.insert(PROCEDURE_PAIR(name, var));
 		return (size + 1) == m_procedure_map.size();
 	}
-	SHARE_AST lookup(std::string name)
+	PTR_PROCEDURE_AST lookup(std::string name)
 	{
 		if (m_procedure_map.find(name) != m_procedure_map.end())
 			return m_procedure_map.at(name);
 		else
-			return MAKE_SHARE_EMPTY_AST();
+			return nullptr;
 	}
-	bool valid(SHARE_AST var)
+	bool valid(PTR_PROCEDURE_AST var)
 	{
-		return (dynamic_pointer_cast<Procedure_AST>(var) != nullptr);
+		return (var != nullptr);
 	}
 private:
 	PROCEDURE_MAP m_procedure_map;
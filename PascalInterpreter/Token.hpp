@@ -1,38 +1,43 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <memory>
+#include <vector>
 #include "MyTemplates.hpp"
 #include "MyExceptions.hpp"
 #include "MyMacros.hpp"
 
 /*
 Token class
+The value is a view into the source buffer (or a string literal), the token itself lives in the Arena
 */
-template <typename T>
 class Token
 {
 public:
 
-	Token() : m_type("Undefined"), m_value(nullptr), m_pos(0) {};
-	explicit Token(std::string type, T value, unsigned int pos = 0)
-	{
-		m_pos = pos;
-		m_type = type;
-		(check_is_shared_ptr(value)) ? m_value = value :
-			throw MyExceptions::MsgExecption("Value passed to a Token constructor must be a shared_ptr type.");
-	}
+	Token() : m_type(EMPTY), m_pos(0) {};
+	explicit Token(TokenKind type, std::string_view value, unsigned int pos = 0)
+		:
+		m_type(type),
+		m_value(value),
+		m_pos(pos)
+	{}
 
 	virtual ~Token() {};
 
 	std::string ToString() const noexcept
 	{
-		return "Token( " + m_type + ", " + MyTemplates::Str(*m_value) + " )";
+		return "Token( " + GetTypeName() + ", " + MyTemplates::Str(m_value) + " )";
 	}
-	std::string GetType() const noexcept
+	TokenKind GetType() const noexcept
 	{
 		return m_type;
 	}
-	T GetValue() const noexcept
+	std::string GetTypeName() const noexcept
+	{
+		return GetTokenKindName(m_type);
+	}
+	std::string_view GetValue() const noexcept
 	{
 		return m_value;
 	}
@@ -42,7 +47,44 @@ public:
 	}
 
 private:
-	std::string m_type;
-	T m_value;
+	TokenKind m_type;
+	std::string_view m_value;
 	unsigned int m_pos;
 };
+
+
+/*
+TokenBuffer class
+Contiguous array of every token of a file, filled by the lexer in one pass and indexed by the parser.
+The last token is always __EOF__ and reads past the end return it, so lookahead never runs off the buffer.
+*/
+class TokenBuffer
+{
+public:
+	TokenBuffer() {};
+	virtual ~TokenBuffer() {};
+
+	void Clear() noexcept
+	{
+		m_tokens.clear();
+	}
+	void Reserve(size_t count)
+	{
+		m_tokens.reserve(count);
+	}
+	void Push(PTR_TOKEN token)
+	{
+		m_tokens.push_back(token);
+	}
+	PTR_TOKEN Get(size_t index) const noexcept
+	{
+		return (index < m_tokens.size()) ? m_tokens[index] : m_tokens.back();
+	}
+	size_t GetSize() const noexcept
+	{
+		return m_tokens.size();
+	}
+
+private:
+	std::vector<PTR_TOKEN> m_tokens;
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include "MyTemplates.hpp"
+#include "MyExceptions.hpp"
+#include "MyMacros.hpp"
+
+/*
+Value class
+Unboxed runtime value of the interpreter: a tagged int64/double/bool union that never touches the heap.
+Strings are only produced on demand (ToString) when printing tables or reporting errors.
+*/
+class Value
+{
+public:
+	enum class Type : unsigned char
+	{
+		eEmpty,
+		eInteger,
+		eFloat,
+		eBoolean
+	};
+
+	Value() noexcept : m_type(Type::eEmpty), m_pos(0) { m_data.i = 0; };
+
+	static Value Integer(int64_t value, unsigned int pos = 0) noexcept
+	{
+		Value result;
+		result.m_type = Type::eInteger;
+		result.m_data.i = value;
+		result.m_pos = pos;
+		return result;
+	}
+
+	static Value Float(double value, unsigned int pos = 0) noexcept
+	{
+		Value result;
+		result.m_type = Type::eFloat;
+		result.m_data.f = value;
+		result.m_pos = pos;
+		return result;
+	}
+
+	static Value Boolean(bool value, unsigned int pos = 0) noexcept
+	{
+		Value result;
+		result.m_type = Type::eBoolean;
+		result.m_data.b = value;
+		result.m_pos = pos;
+		return result;
+	}
+
+	/*
+	Functionality: zero of a type, stands for any value of that type during static analysis
+	*/
+	static Value OfType(Type type, unsigned int pos = 0) noexcept
+	{
+		if (type == Type::eInteger)
+			return Integer(0, pos);
+		else if (type == Type::eFloat)
+			return Float(0, pos);
+		else if (type == Type::eBoolean)
+			return Boolean(false, pos);
+		Value result;
+		result.m_pos = pos;
+		return result;
+	}
+
+	/*
+	Functionality: convert a INTEGER/FLOAT/BOOLEAN literal token into a value, any other token gives an empty value
+	*/
+	template <typename T>
+	static Value FromToken(const T& token)
+	{
+		// The lexer has rejected the literals out of the range of their type
+		auto text = token->GetValue();
+		if (token->GetType() == INTEGER)
+		{
+			int64_t value = 0;
+			std::from_chars(text.data(), text.data() + text.size(), value);
+			return Integer(value, token->GetPos());
+		}
+		else if (token->GetType() == FLOAT)
+		{
+			double value = 0;
+			std::from_chars(text.data(), text.data() + text.size(), value);
+			return Float(value, token->GetPos());
+		}
+		else if (token->GetType() == BOOLEAN)
+			return Boolean(token->GetValue() == "TRUE", token->GetPos());
+		else
+			return Value();
+	}
+
+	/*
+	Functionality: map a type name (INTEGER, FLOAT, BOOLEAN) to its type tag, any other name gives eEmpty
+	*/
+	static Type TypeFromString(const std::string& type) noexcept
+	{
+		if (type == GetTokenKindName(INTEGER))
+			return Type::eInteger;
+		else if (type == GetTokenKindName(FLOAT))
+			return Type::eFloat;
+		else if (type == GetTokenKindName(BOOLEAN))
+			return Type::eBoolean;
+		else
+			return Type::eEmpty;
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return m_type == Type::eEmpty;
+	}
+	bool IsInteger() const noexcept
+	{
+		return m_type == Type::eInteger;
+	}
+	bool IsFloat() const noexcept
+	{
+		return m_type == Type::eFloat;
+	}
+	bool IsNumber() const noexcept
+	{
+		return m_type == Type::eInteger || m_type == Type::eFloat;
+	}
+	bool IsBoolean() const noexcept
+	{
+		return m_type == Type::eBoolean;
+	}
+	Type GetTypeTag() const noexcept
+	{
+		return m_type;
+	}
+	int64_t GetInteger() const noexcept
+	{
+		return m_data.i;
+	}
+	double GetFloat() const noexcept
+	{
+		return m_data.f;
+	}
+	bool GetBoolean() const noexcept
+	{
+		return m_data.b;
+	}
+	/*
+	Functionality: read the value as a double, promoting integers
+	*/
+	double AsFloat() const noexcept
+	{
+		return (m_type == Type::eInteger) ? static_cast<double>(m_data.i) : m_data.f;
+	}
+	unsigned int GetPos() const noexcept
+	{
+		return m_pos;
+	}
+	void SetPos(unsigned int pos) noexcept
+	{
+		m_pos = pos;
+	}
+
+	/*
+	Functionality: type name matching the token type tags, used by the symbol table type check
+	*/
+	std::string GetType() const noexcept
+	{
+		return TypeToString(m_type);
+	}
+	static std::string TypeToString(Type type) noexcept
+	{
+		switch (type)
+		{
+		case Type::eInteger: return GetTokenKindName(INTEGER);
+		case Type::eFloat: return GetTokenKindName(FLOAT);
+		case Type::eBoolean: return GetTokenKindName(BOOLEAN);
+		default: return GetTokenKindName(EMPTY);
+		}
+	}
+	std::string GetValueString() const noexcept
+	{
+		switch (m_type)
+		{
+		case Type::eInteger: return MyTemplates::Str(m_data.i);
+		case Type::eFloat: return MyTemplates::Str(m_data.f);
+		case Type::eBoolean: return m_data.b ? "TRUE" : "FALSE";
+		default: return "";
+		}
+	}
+	std::string ToString() const noexcept
+	{
+		return "Token( " + GetType() + ", " + GetValueString() + " )";
+	}
+
+private:
+	union
+	{
+		int64_t i;
+		double f;
+		bool b;
+	} m_data;
+	Type m_type;
+	unsigned int m_pos;
+};
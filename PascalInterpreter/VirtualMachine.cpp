@@ -0,0 +1,231 @@
+#include "VirtualMachine.hpp"
+
+void VirtualMachine::Run(const BytecodeProgram& program)
+{
+	m_program = &program;
+	m_stack.clear();
+	m_frames.Reset();
+	m_returns.clear();
+
+	if (m_profile)
+	{
+		m_pairs.assign(OP_COUNT * OP_COUNT, 0);
+		Execute<true>();
+	}
+	else
+		Execute<false>();
+}
+
+void VirtualMachine::PrintOpCodePairs(unsigned int count) const
+{
+	std::vector<std::pair<uint64_t, unsigned int>> pairs;
+	uint64_t total = 0;
+	for (unsigned int i = 0; i < m_pairs.size(); i++)
+	{
+		total += m_pairs[i];
+		if (m_pairs[i] != 0)
+			pairs.push_back(std::make_pair(m_pairs[i], i));
+	}
+	std::sort(pairs.begin(), pairs.end(), [](const std::pair<uint64_t, unsigned int>& a, const std::pair<uint64_t, unsigned int>& b)
+		{
+			return a.first > b.first;
+		});
+	std::cout << "Op code pairs---------------------------------------------" << std::endl;
+	for (unsigned int i = 0; i < pairs.size() && i < count; i++)
+	{
+		std::cout << GetOpCodeName(static_cast<OpCode>(pairs[i].second / OP_COUNT)) << " -> " << \
+			GetOpCodeName(static_cast<OpCode>(pairs[i].second % OP_COUNT)) << " : " << pairs[i].first << \
+			" (" << (100.0 * pairs[i].first / total) << "%)" << std::endl;
+	}
+}
+
+template <bool PROFILE>
+void VirtualMachine::Execute()
+{
+	const BytecodeProgram& program = *m_program;
+	const Instruction* code = program.GetCode().data();
+	const Value* constants = program.GetConstants().data();
+	unsigned int pc = 0;
+	// Op code dispatched before the current one, a pair is counted per dispatch
+	unsigned int previous = OP_HALT;
+
+	while (true)
+	{
+		const Instruction& inst = code[pc];
+		if constexpr (PROFILE)
+		{
+			m_pairs[previous * OP_COUNT + inst.op]++;
+			previous = inst.op;
+		}
+		switch (inst.op)
+		{
+		case OP_PUSH_CONST:
+			m_stack.push_back(constants[inst.operand]);
+			break;
+		case OP_LOAD:
+			m_stack.push_back(Load(inst));
+			break;
+		case OP_STORE:
+			Store(inst, m_stack.back());
+			m_stack.pop_back();
+			break;
+		case OP_POP:
+			m_stack.pop_back();
+			break;
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_INT_DIV:
+		case OP_EQ:
+		case OP_NE:
+		case OP_LT:
+		case OP_LE:
+		case OP_GT:
+		case OP_GE:
+		{
+			Value right = m_stack.back();
+			m_stack.pop_back();
+			m_stack.back() = BINARY_KERNELS[inst.operand](m_stack.back(), right);
+			break;
+		}
+		case OP_NEG:
+		case OP_POS:
+		case OP_NOT:
+			m_stack.back() = UNARY_KERNELS[inst.operand](m_stack.back());
+			break;
+		case OP_JUMP:
+			pc = inst.operand;
+			continue;
+		// Conditions were checked to be BOOLEAN by the semantic analyzer
+		case OP_JUMP_IF_FALSE:
+		{
+			bool condition = m_stack.back().GetBoolean();
+			m_stack.pop_back();
+			if (!condition)
+			{
+				pc = inst.operand;
+				continue;
+			}
+			break;
+		}
+		case OP_JUMP_IF_FALSE_OR_POP:
+		case OP_JUMP_IF_TRUE_OR_POP:
+			// The left operand that decides an AND/OR is its result
+			if (m_stack.back().GetBoolean() == (inst.op == OP_JUMP_IF_TRUE_OR_POP))
+			{
+				pc = inst.operand;
+				continue;
+			}
+			m_stack.pop_back();
+			break;
+		// Bounds were checked to be INTEGER by the semantic analyzer, the counter is the value below the end bound
+		case OP_FOR_TO:
+		case OP_FOR_DOWNTO:
+		{
+			int64_t start = m_stack[m_stack.size() - 2].GetInteger();
+			int64_t end = m_stack.back().GetInteger();
+			if ((inst.op == OP_FOR_TO) ? start > end : start < end)
+			{
+				m_stack.resize(m_stack.size() - 2);
+				break;
+			}
+			m_frames.Slot(inst.level, inst.operand) = Value::Integer(start, inst.pos);
+			pc += 2;
+			continue;
+		}
+		case OP_NEXT_TO:
+		case OP_NEXT_DOWNTO:
+		{
+			Value& counter = m_stack[m_stack.size() - 2];
+			int64_t current = counter.GetInteger();
+			// Stop on the end bound itself, stepping past it could overflow
+			if (current == m_stack.back().GetInteger())
+			{
+				m_stack.resize(m_stack.size() - 2);
+				break;
+			}
+			current += (inst.op == OP_NEXT_TO) ? 1 : -1;
+			counter = Value::Integer(current);
+			const Instruction& head = code[inst.operand];
+			m_frames.Slot(head.level, head.operand) = Value::Integer(current, head.pos);
+			pc = inst.operand + 2;
+			continue;
+		}
+		case OP_ENTER:
+			m_frames.Push(program.GetScopes()[inst.operand].layout.get());
+			break;
+		case OP_CALL:
+			m_returns.push_back(pc + 1);
+			pc = program.GetScopes()[inst.operand].entry;
+			continue;
+		case OP_RETURN:
+			pc = m_returns.back();
+			m_returns.pop_back();
+			m_frames.Pop();
+			continue;
+		case OP_HALT:
+			return;
+		// Superinstructions: the operands are the instructions of the fused sequence following inst
+		case OP_LOAD_CONST_OP_STORE:
+			Store(code[pc + 3], BINARY_KERNELS[code[pc + 2].operand](Load(inst), constants[code[pc + 1].operand]));
+			pc += 4;
+			continue;
+		case OP_LOAD_LOAD_OP_STORE:
+		{
+			Value left = Load(inst);
+			Store(code[pc + 3], BINARY_KERNELS[code[pc + 2].operand](left, Load(code[pc + 1])));
+			pc += 4;
+			continue;
+		}
+		case OP_LOAD_CONST_COMPARE_JUMP:
+			if (!BINARY_KERNELS[code[pc + 2].operand](Load(inst), constants[code[pc + 1].operand]).GetBoolean())
+			{
+				pc = code[pc + 3].operand;
+				continue;
+			}
+			pc += 4;
+			continue;
+		case OP_LOAD_CONST_OP:
+			m_stack.push_back(BINARY_KERNELS[code[pc + 2].operand](Load(inst), constants[code[pc + 1].operand]));
+			pc += 3;
+			continue;
+		case OP_LOAD_LOAD_OP:
+		{
+			Value left = Load(inst);
+			m_stack.push_back(BINARY_KERNELS[code[pc + 2].operand](left, Load(code[pc + 1])));
+			pc += 3;
+			continue;
+		}
+		case OP_OP_STORE:
+		{
+			Value right = m_stack.back();
+			m_stack.pop_back();
+			Store(code[pc + 1], BINARY_KERNELS[inst.operand](m_stack.back(), right));
+			m_stack.pop_back();
+			pc += 2;
+			continue;
+		}
+		case OP_COMPARE_JUMP:
+		{
+			Value right = m_stack.back();
+			m_stack.pop_back();
+			bool condition = BINARY_KERNELS[inst.operand](m_stack.back(), right).GetBoolean();
+			m_stack.pop_back();
+			pc = condition ? pc + 2 : code[pc + 1].operand;
+			continue;
+		}
+		case OP_CONST_STORE:
+			Store(code[pc + 1], constants[inst.operand]);
+			pc += 2;
+			continue;
+		case OP_LOAD_STORE:
+			Store(code[pc + 1], Load(inst));
+			pc += 2;
+			continue;
+		default:
+			Error("RuntimeError(VirtualMachine): unknown op code " + inst.ToString() + ".");
+		}
+		pc++;
+	}
+}
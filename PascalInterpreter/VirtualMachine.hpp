@@ -0,0 +1,140 @@
+/*
+Stack virtual machine running BytecodeProgram
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Frame.hpp"
+#include "Bytecode.hpp"
+#include "Operator.hpp"
+
+
+class VirtualMachine
+{
+public:
+	VirtualMachine()
+		:
+		m_program(nullptr),
+		m_profile(false),
+		m_sfd(nullptr)
+	{}
+	virtual ~VirtualMachine() {};
+
+	void Reset() noexcept
+	{
+		m_stack.clear();
+		m_frames.Reset();
+		m_returns.clear();
+		m_program = nullptr;
+		m_profile = false;
+		m_pairs.clear();
+		m_sfd = nullptr;
+	}
+
+	void SetSFD(MyDebug::SrouceFileDebugger* sfd) noexcept
+	{
+		m_sfd = sfd;
+	}
+
+	// Count the op code pairs dispatched by the next runs, to choose the superinstructions from
+	void SetProfile(bool profile) noexcept
+	{
+		m_profile = profile;
+	}
+
+	/*
+	Functionality: print the most frequent op code pairs of the last profiled run
+	*/
+	void PrintOpCodePairs(unsigned int count) const;
+
+	void PrintAllSymbolTable() noexcept
+	{
+		m_frames.PrintAllSymbolTable();
+	}
+
+	void PrintAllMemoryTable() noexcept
+	{
+		m_frames.PrintAllMemoryTable();
+	}
+
+public:
+	/*
+	Functionality: execute a compiled program until OP_HALT, the global frame is kept for printing
+	Return: none
+	*/
+	void Run(const BytecodeProgram& program);
+
+protected:
+	template <bool PROFILE>
+	void Execute();
+
+	/*
+	Funtionality: helper function to throw exception with a specific message
+	*/
+	inline void Error(const std::string& msg)
+	{
+		throw MyExceptions::MsgExecption(msg);
+	}
+
+	/*
+	Funtionality: helper function to throw exception with a specific message and source file location
+	*/
+	inline void ErrorSFD(const std::string& msg, unsigned int pos)
+	{
+		throw MyExceptions::MsgExecption(msg, m_sfd, pos);
+	}
+
+	/*
+	Functionality: read the variable of an OP_LOAD
+	Return: its value at the position of the load
+	*/
+	inline Value Load(const Instruction& load)
+	{
+		const Value& value = m_frames.Slot(load.level, load.operand);
+		if (value.IsEmpty())
+			ErrorSFD("SymbolError(VirtualMachine): variable " + SlotName(load.level, load.operand) + " used before reference.", load.pos);
+		Value result = value;
+		result.SetPos(load.pos);
+		return result;
+	}
+
+	/*
+	Functionality: write the variable of an OP_STORE, checking its declared type
+	*/
+	inline void Store(const Instruction& store, const Value& value)
+	{
+		if (value.GetTypeTag() != store.type)
+		{
+			ErrorSFD("SymbolError(VirtualMachine): variable " + SlotName(store.level, store.operand) + " with type " + \
+				Value::TypeToString(store.type) + " does not match " + \
+				value.GetValueString() + " with type " + value.GetType() + " .", value.GetPos());
+		}
+		m_frames.Slot(store.level, store.operand) = value;
+	}
+
+	// Name of a variable, only used to build error messages
+	const std::string& SlotName(unsigned int level, unsigned int slot) const
+	{
+		return m_frames.GetLayout(level).names[slot];
+	}
+
+private:
+	const BytecodeProgram* m_program;
+
+	std::vector<Value> m_stack;
+	FrameStack m_frames;
+	// Return addresses of the active calls
+	std::vector<unsigned int> m_returns;
+
+	bool m_profile;
+	// Dispatch count of each (previous, current) op code pair, indexed by previous * OP_COUNT + current
+	std::vector<uint64_t> m_pairs;
+
+	MyDebug::SrouceFileDebugger* m_sfd;
+};